@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free queue with multiple producers and multiple consumers.
+ *
+ * Objects are stored in a preallocated ring of cells, each cell carrying a sequence number telling whether it is
+ * free or holds an object. A push or a pop is one compare-and-swap on the ring position, without allocation.
+ * When the queue is full, push fails immediately : the caller decides what to do (wait, drop, count...).
+ *
+ * @tparam T Type of the objects to store, must be default constructible and movable
+ */
+template <typename T>
+class MBIBoundedQueue
+{
+public:
+    /**
+     * @brief Construct a new MBIBoundedQueue object
+     *
+     * @param capacity Maximum number of objects, rounded up to a power of 2
+     */
+    explicit MBIBoundedQueue(size_t capacity) : m_enqueue(0), m_dequeue(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        m_cells = std::unique_ptr<Cell[]>(new Cell[size]);
+        m_mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MBIBoundedQueue(const MBIBoundedQueue &) = delete;
+    MBIBoundedQueue &operator=(const MBIBoundedQueue &) = delete;
+
+    /**
+     * @brief Add an object at the end of the queue. Can be called from any thread.
+     *
+     * @param value Object to add, moved into the queue on success
+     * @return true Object added
+     * @return false Queue full, value is left untouched
+     */
+    bool push(T &&value)
+    {
+        size_t pos = m_enqueue.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Retrieve and remove the oldest object of the queue. Can be called from any thread.
+     *
+     * @param value Destination of the object
+     * @return true An object was retrieved
+     * @return false Queue empty
+     */
+    bool pop(T &value)
+    {
+        size_t pos = m_dequeue.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the maximum number of objects
+     *
+     * @return size_t Capacity of the queue
+     */
+    size_t capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;          ///< Ring of cells
+    size_t m_mask;                            ///< Capacity - 1
+    alignas(64) std::atomic<size_t> m_enqueue; ///< Next position to push, on its own cache line
+    alignas(64) std::atomic<size_t> m_dequeue; ///< Next position to pop, on its own cache line
+};
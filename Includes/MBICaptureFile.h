@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MBIPlotChart.h"
+
+/**
+ * @brief Read-only capture file mapped in memory, usable directly as MBIPlotChart data source.
+ *
+ * Opening a capture only maps the file : no sample is read. Samples are paged in by the OS when the graph
+ * accesses them, and graphs only access the samples of the displayed window (plus a binary search on time).
+ * The memory used therefore scales with what is displayed, not with the size of the file.
+ *
+ * File format (little endian, offsets in bytes from the start of the file) :
+ *
+ *      FileHeader      64 bytes
+ *                          char     magic[8]       "MBICAP01"
+ *                          uint32_t version        FORMAT_VERSION
+ *                          uint32_t channelCount   Number of channels
+ *                          uint64_t tableOffset    Offset of the channel table
+ *                          uint8_t  reserved[40]   Zero
+ *      ChannelHeader   64 bytes per channel, at tableOffset
+ *                          char     name[40]       Channel name, null terminated
+ *                          uint32_t periodMs       Sampling period in ms, 0 for non periodic data
+ *                          uint32_t flags          CHANNEL_FLAG_xxx
+ *                          uint64_t offset         Offset of the samples, multiple of SAMPLES_ALIGNMENT
+ *                          uint64_t count          Number of samples
+ *      Samples         One column per channel, count DataPoint {double time; double value}, sorted by time
+ *
+ * Each channel column has the memory layout of an ImVector<DataPoint>, so the mapped samples are handed to
+ * graphs as a read-only ImVector viewing the file.
+ *
+ */
+class MBICaptureFile
+{
+public:
+    static constexpr char MAGIC[8] = {'M', 'B', 'I', 'C', 'A', 'P', '0', '1'}; ///< File signature
+    static constexpr uint32_t FORMAT_VERSION = 1;                               ///< Current format version
+    static constexpr size_t CHANNEL_NAME_SIZE = 40;                             ///< Channel name maximum length, including null char
+    static constexpr uint64_t SAMPLES_ALIGNMENT = 4096;                         ///< Alignment of the channel columns in the file
+    static constexpr uint32_t CHANNEL_FLAG_CONTINUOUS = 0x1;                    ///< Channel has no NaN and no missing sample
+
+    /**
+     * @brief Header of the file
+     *
+     */
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t channelCount;
+        uint64_t tableOffset;
+        uint8_t reserved[40];
+    };
+    static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+
+    /**
+     * @brief Header of a channel
+     *
+     */
+    struct ChannelHeader
+    {
+        char name[CHANNEL_NAME_SIZE];
+        uint32_t periodMs;
+        uint32_t flags;
+        uint64_t offset;
+        uint64_t count;
+    };
+    static_assert(sizeof(ChannelHeader) == 64, "ChannelHeader layout is part of the file format");
+
+    /**
+     * @brief Channel to write in a capture file
+     *
+     */
+    struct ChannelSource
+    {
+        std::string name;                ///< Name of the channel
+        uint32_t periodMs;               ///< Sampling period in ms, 0 for non periodic data
+        const ImVector<DataPoint> *data; ///< Samples of the channel, sorted by time
+    };
+
+    /***********************************************************
+     *
+     *  CTOR & DTOR
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Construct a new closed MBICaptureFile object
+     *
+     */
+    MBICaptureFile() noexcept;
+
+    /**
+     * @brief Destroy the MBICaptureFile object, unmapping the file.
+     * @warning Graphs displaying channels of the file must not be displayed anymore.
+     *
+     */
+    ~MBICaptureFile();
+
+    MBICaptureFile(const MBICaptureFile &) = delete;
+    MBICaptureFile &operator=(const MBICaptureFile &) = delete;
+
+    /***********************************************************
+     *
+     *  File management
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Map a capture file. The file is kept open (read-only, shared read) until Close.
+     *
+     * @param path Path of the capture file
+     * @return true The file is mapped and its channels are available
+     * @return false The file can't be opened or isn't a valid capture file. Error is logged.
+     */
+    bool Open(const std::filesystem::path &path);
+
+    /**
+     * @brief Unmap the file.
+     * @warning Graphs displaying channels of the file must not be displayed anymore.
+     *
+     */
+    void Close() noexcept;
+
+    /**
+     * @brief Is a file currently mapped
+     *
+     * @return true A file is mapped
+     * @return false No file mapped
+     */
+    bool IsOpen() const noexcept;
+
+    /**
+     * @brief Write a capture file
+     *
+     * @param path Path of the file to create (overwritten if it exists)
+     * @param channels Channels to write
+     * @return true The file has been written
+     * @return false Error while writing the file. Error is logged.
+     */
+    static bool Write(const std::filesystem::path &path, const std::vector<ChannelSource> &channels);
+
+    /***********************************************************
+     *
+     *  Channels
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Get the number of channels of the file
+     *
+     * @return size_t Number of channels
+     */
+    size_t GetChannelCount() const noexcept;
+
+    /**
+     * @brief Get the name of a channel
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return std::string_view Name of the channel
+     */
+    std::string_view GetChannelName(size_t channel) const;
+
+    /**
+     * @brief Get the sampling period of a channel
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return uint32_t Period in ms, 0 for non periodic data
+     */
+    uint32_t GetChannelPeriod(size_t channel) const;
+
+    /**
+     * @brief Check if a channel is known to have no NaN nor missing sample. Graphs then skip gaps detection,
+     * which would otherwise read the whole channel.
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return true The channel is continuous
+     * @return false The channel may contain gaps
+     */
+    bool IsChannelContinuous(size_t channel) const;
+
+    /**
+     * @brief Get the samples of a channel, as a read-only view on the mapped file. Pass it to MBIPlotChart::CreateVariable.
+     * The view remains valid until the file is closed.
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return const ImVector<DataPoint>* Samples of the channel
+     */
+    const ImVector<DataPoint> *GetChannel(size_t channel) const;
+
+private:
+    void *m_file;                                   ///< File handle
+    void *m_mapping;                                ///< File mapping handle
+    const uint8_t *m_view;                          ///< Mapped file
+    uint64_t m_size;                                ///< Size of the file
+    const ChannelHeader *m_channelHeaders;          ///< Channel table, in the mapped file
+    size_t m_channelCount;                          ///< Number of channels
+    std::unique_ptr<ImVector<DataPoint>[]> m_views; ///< Read-only views on the channels samples. Never resized : ImVector would copy the mapped data.
+
+    bool Fail(const std::filesystem::path &path, std::string_view reason);
+};
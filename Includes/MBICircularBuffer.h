@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
+#include <vector>
 
 /**
  * @brief Circular buffer with no automatic growing nor dynamic memory allocation after construction
@@ -301,6 +303,8 @@ private:
     size_t m_begin;
     size_t m_end;
     bool m_full;
+    uint64_t m_generation; ///< Incremented on each buffer modification
+    uint64_t m_pushed;     ///< Total number of objects pushed since construction
 
     /**
      * @brief Increase internal counter and circle back if needed.
@@ -339,7 +343,9 @@ public:
                                                                  m_buff(std::unique_ptr<T[]>(new T[capacity + 1])),
                                                                  m_begin(0),
                                                                  m_end(0),
-                                                                 m_full(false)
+                                                                 m_full(false),
+                                                                 m_generation(0),
+                                                                 m_pushed(0)
     {
     }
 
@@ -366,6 +372,115 @@ public:
     {
         return size_unlocked();
     }
+    /**
+     * @brief Get the generation of the buffer. The generation changes each time the buffer content is modified
+     * (push, pop, remove, reset), so it can be used to detect that data derived from the buffer must be recomputed.
+     *
+     * @return uint64_t Current generation of the buffer
+     */
+    virtual uint64_t generation() const noexcept
+    {
+        return m_generation;
+    }
+    /**
+     * @brief Get the total number of objects pushed into the buffer since its construction.
+     * As objects are only added at the end and removed from the beginning, the oldest object of the buffer
+     * is always the (pushed() - size())th object pushed. This gives a stable index to each object.
+     *
+     * @return uint64_t Number of objects pushed
+     */
+    virtual uint64_t pushed() const noexcept
+    {
+        return m_pushed;
+    }
+    /**
+     * @brief Copy the objects pushed since a given object, identified by its stable index (see pushed()).
+     * Objects already overwritten are skipped : the returned index is then greater than from.
+     *
+     * @param from Stable index of the first object to copy
+     * @param out Vector to which the objects are appended
+     * @return uint64_t Stable index of the first object copied
+     */
+    virtual uint64_t copy_since(uint64_t from, std::vector<T> &out) const
+    {
+        const size_t size = size_unlocked();
+        const uint64_t oldest = m_pushed - size;
+        const uint64_t first = (from > oldest) ? from : oldest;
+        for (uint64_t i = first; i < m_pushed; i++)
+        {
+            out.push_back(m_buff[(m_begin + (size_t)(i - oldest)) % m_capacity]);
+        }
+        return first;
+    }
+    /**
+     * @brief Copy at most count objects starting at a given object, identified by its stable index (see pushed()).
+     * Objects already overwritten are skipped : the returned index is then greater than from.
+     *
+     * @param from Stable index of the first object to copy
+     * @param count Maximum number of objects to copy
+     * @param out Vector to which the objects are appended
+     * @return uint64_t Stable index of the first object copied
+     */
+    virtual uint64_t copy_range(uint64_t from, size_t count, std::vector<T> &out) const
+    {
+        const size_t size = size_unlocked();
+        const uint64_t oldest = m_pushed - size;
+        const uint64_t first = (from > oldest) ? from : oldest;
+        const uint64_t end = (from + count < m_pushed) ? from + count : m_pushed;
+        for (uint64_t i = first; i < end; i++)
+        {
+            out.push_back(m_buff[(m_begin + (size_t)(i - oldest)) % m_capacity]);
+        }
+        return first;
+    }
+    /**
+     * @brief Copy at most count objects starting at a given object, identified by its stable index (see pushed()), into
+     * an array. Objects already overwritten are skipped.
+     *
+     * @param from Stable index of the first object to copy
+     * @param count Maximum number of objects to copy
+     * @param out Destination array of at least count objects
+     * @param first Receives the stable index of the first object copied
+     * @return size_t Number of objects copied
+     */
+    virtual size_t copy_range(uint64_t from, size_t count, T *out, uint64_t &first) const
+    {
+        const size_t size = size_unlocked();
+        const uint64_t oldest = m_pushed - size;
+        first = (from > oldest) ? from : oldest;
+        const uint64_t end = (from + count < m_pushed) ? from + count : m_pushed;
+        size_t copied = 0;
+        for (uint64_t i = first; i < end; i++)
+        {
+            out[copied++] = m_buff[(m_begin + (size_t)(i - oldest)) % m_capacity];
+        }
+        return copied;
+    }
+    /**
+     * @brief Get the stable indexes of the oldest object and after the newest one (see pushed()), read together
+     *
+     * @param oldest Receives the stable index of the oldest object
+     * @param end Receives the number of objects pushed
+     */
+    virtual void bounds(uint64_t &oldest, uint64_t &end) const noexcept
+    {
+        end = m_pushed;
+        oldest = m_pushed - size_unlocked();
+    }
+    /**
+     * @brief Copy consecutive objects of the buffer into an array
+     *
+     * @param idx Offset of the first object from the beginning of the buffer (see operator[])
+     * @param count Number of objects to copy, idx + count must not exceed size()
+     * @param out Destination array of at least count objects
+     */
+    virtual void copy(size_t idx, size_t count, T *out) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = m_buff[(m_begin + idx + i) % m_capacity];
+        }
+    }
     /**
      * @brief Add an object at the end of the buffer. If the buffer is full, the object will replace the oldest one.
      *
@@ -382,6 +497,21 @@ public:
         increasecount(m_end);
         if (m_begin == m_end)
             m_full = true;
+        m_generation++;
+        m_pushed++;
+    }
+    /**
+     * @brief Add consecutive objects at the end of the buffer. If the buffer is full, the oldest objects are replaced.
+     *
+     * @param data Objects to add
+     * @param count Number of objects to add
+     */
+    virtual void push(const T *data, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            MBICircularBuffer::push(data[i]);
+        }
     }
     /**
      * @brief Empty and reset the buffer
@@ -392,6 +522,7 @@ public:
         m_begin = 0;
         m_end = 0;
         m_full = false;
+        m_generation++;
     }
     /**
      * @brief Retreive and remove the oldest object inserted into the buffer
@@ -406,6 +537,7 @@ public:
         size_t count = m_begin;
         increasecount(m_begin);
         m_full = false;
+        m_generation++;
         return m_buff[count];
     }
 
@@ -428,6 +560,7 @@ public:
                 m_begin = n - (m_capacity - m_begin);
             }
             m_full = false;
+            m_generation++;
         }
     }
 
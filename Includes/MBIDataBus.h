@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MBIPlotChart.h"
+#include "MBISyncCircularBuffer.h"
+
+/**
+ * @brief Multi-channel data bus : a producer publishes frames holding one value per channel, charts subscribe to channels.
+ *
+ * Published frames are stored row by row (time, then one value per channel) in a ring owned by the bus. Publishing
+ * a frame is a copy of its values followed by a single atomic commit, whatever the number of channels : no lock is
+ * taken and the consumer is never waited for. The consumer thread (usually the UI thread) calls Update once per frame
+ * to append the committed frames to the channel of each subscription, with one write lock per subscribed channel
+ * and per Update instead of one per sample.
+ *
+ * Frames not consumed before being overwritten in the bus ring are counted as dropped : the ring must hold the
+ * frames published between two Update calls.
+ *
+ */
+class MBIDataBus
+{
+public:
+    using ChannelId = uint32_t;                       ///< Channel identifier, index of the value in a published frame
+    using Channel = MBISyncCircularBuffer<DataPoint>; ///< Realtime channel fed by a subscription
+
+    /***********************************************************
+     *
+     *  CTOR & DTOR
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Construct a new MBIDataBus object
+     *
+     * @param channelCount Number of values of each frame
+     * @param capacity Number of frames kept in the bus ring, at least 2
+     */
+    explicit MBIDataBus(uint32_t channelCount, size_t capacity = 16384);
+
+    MBIDataBus(const MBIDataBus &) = delete;
+    MBIDataBus &operator=(const MBIDataBus &) = delete;
+
+    /**
+     * @brief Get the number of channels
+     *
+     * @return uint32_t Number of values of each frame
+     */
+    uint32_t GetChannelCount() const noexcept;
+
+    /***********************************************************
+     *
+     *  Producer
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Publish a frame. Must always be called from the same thread.
+     *
+     * @param time Time of the frame in s
+     * @param values GetChannelCount() values, indexed by ChannelId
+     */
+    void Publish(double time, const double *values) noexcept;
+
+    /**
+     * @brief Get the number of frames published since construction
+     *
+     * @return uint64_t Number of frames published
+     */
+    uint64_t GetPublishedCount() const noexcept;
+
+    /**
+     * @brief Get the number of frames published, for MBIMNG::AddDataSource frame pacing
+     *
+     * @param bus MBIDataBus object
+     * @return uint64_t Number of frames published
+     */
+    static uint64_t GetGeneration(const void *bus) noexcept;
+
+    /***********************************************************
+     *
+     *  Consumer
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Subscribe to a channel. Must be called from the consumer thread.
+     * Only frames committed after the last Update are appended to a new subscription.
+     *
+     * @param channel Channel identifier, in [0;GetChannelCount()[
+     * @param historySize Capacity of the channel created for the subscription, ignored if already subscribed
+     * @return const Channel* Channel fed with the channel values, to pass to MBIRealtimePlotChart::CreateVariable.
+     * Remains valid during the bus lifetime. The same channel is returned to all the subscribers of a channel.
+     */
+    const Channel *Subscribe(ChannelId channel, size_t historySize = 10000);
+
+    /**
+     * @brief Append the frames committed since last call to the subscribed channels. Must be called from the consumer
+     * thread, once per frame before displaying the charts.
+     *
+     */
+    void Update();
+
+    /**
+     * @brief Get the number of frames overwritten in the bus ring before being consumed
+     *
+     * @return uint64_t Number of frames dropped
+     */
+    uint64_t GetDroppedCount() const noexcept;
+
+private:
+    static constexpr size_t BATCH_SIZE = 256; ///< Number of samples appended at once to a channel
+
+    /**
+     * @brief Subscribed channel
+     *
+     */
+    struct Subscription
+    {
+        ChannelId id;                    ///< Channel identifier
+        std::unique_ptr<Channel> buffer; ///< Channel fed with the values
+    };
+
+    const uint32_t m_channelCount;         ///< Number of values of each frame
+    const size_t m_capacity;               ///< Number of frames of the ring
+    std::unique_ptr<double[]> m_times;     ///< Time of each frame of the ring
+    std::unique_ptr<double[]> m_values;    ///< Values of each frame of the ring, m_channelCount per frame
+    std::atomic<uint64_t> m_committed;     ///< Number of frames published, written by the producer only
+
+    std::vector<Subscription> m_subscriptions; ///< Subscribed channels, owned by the consumer
+    std::vector<DataPoint> m_batch;            ///< Scratch buffer of Update
+    uint64_t m_next;                           ///< Next frame to consume
+    std::atomic<uint64_t> m_dropped;           ///< Frames dropped
+
+    /**
+     * @brief Get the oldest frame of the ring that the producer can't be overwriting
+     *
+     * @return uint64_t Index of the frame
+     */
+    uint64_t GetOldestReadable() const noexcept;
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MBIPlotChart.h"
+
+namespace MBIMGUI
+{
+    /**
+     * @brief Loading state of a MBIFileLoader
+     *
+     */
+    typedef enum _MBILoaderState
+    {
+        LOADER_IDLE,      ///< No file loaded
+        LOADER_RUNNING,   ///< File being parsed
+        LOADER_DONE,      ///< Whole file loaded
+        LOADER_CANCELLED, ///< Loading cancelled by user, columns contain the data loaded before cancellation
+        LOADER_ERROR      ///< File can't be read, error is logged
+    } MBILoaderState;
+
+    /**
+     * @brief Background file loader feeding plot chart data containers.
+     *
+     * Files are read by chunks on a background thread, each chunk being split on line boundaries and parsed in parallel.
+     * Parsed samples are appended to the columns on the UI thread, in MBIFileLoader::Update, so graphs displaying
+     * the columns fill in progressively without any locking.
+     *
+     * Supported formats :
+     *  - CSV : first field is the time in s, each following field is a column. Separator (',', ';' or tab) is detected
+     *          on the first line. An optional first line of column names is used as header. Empty fields are NaN.
+     *  - Capture files (see MBICaptureFile) : each channel is a column.
+     *
+     * Typical use : call Start from the MBIMNG::EnableOpenMenu handler, create the chart variables in the ready callback,
+     * and register the loader with MBIMNG::AddFileLoader so it is updated each frame and its progress displayed.
+     */
+    class MBIFileLoader
+    {
+    public:
+        /**
+         * @brief Callback called on the UI thread when the columns of the file are known, before any sample is appended.
+         * Use it to create the chart variables (see GetColumn).
+         *
+         */
+        using MBILoaderReadyCb = void (*)(void *, MBIFileLoader &);
+
+        static constexpr size_t CHUNK_SIZE = 8 * 1024 * 1024; ///< Size of the file chunks read by the background thread
+        static constexpr size_t MAX_PENDING_CHUNKS = 8;       ///< Parsed chunks waiting for Update before the background thread pauses
+        static constexpr size_t MAX_CHUNKS_PER_FRAME = 2;     ///< Parsed chunks appended per Update call
+
+        /**
+         * @brief Construct a new idle MBIFileLoader object
+         *
+         */
+        MBIFileLoader() noexcept;
+
+        /**
+         * @brief Destroy the MBIFileLoader object, cancelling the current load
+         *
+         */
+        ~MBIFileLoader();
+
+        MBIFileLoader(const MBIFileLoader &) = delete;
+        MBIFileLoader &operator=(const MBIFileLoader &) = delete;
+
+        /**
+         * @brief Start loading a file in background. The current load, if any, is cancelled.
+         * @warning Columns of the previous load are destroyed : variables using them must be removed from the graphs before.
+         *
+         * @param path Path of the file
+         * @param readyCb Function called when columns are known. Set to nullptr if not used.
+         * @param arg Optional argument to the callback function. Set to NULL if not used.
+         */
+        void Start(const std::filesystem::path &path, MBILoaderReadyCb readyCb = nullptr, void *arg = nullptr);
+
+        /**
+         * @brief Request the cancellation of the current load. Samples already loaded are kept.
+         *
+         */
+        void Cancel() noexcept;
+
+        /**
+         * @brief Append the samples parsed since the last call to the columns. Must be called on the UI thread, once per frame.
+         *
+         */
+        void Update();
+
+        /**
+         * @brief Display a spinner, the progress of the current load and a cancel button.
+         * Nothing is displayed if no load is running.
+         *
+         * @param label Widget label, must be unique
+         */
+        void DisplayProgress(const char *label);
+
+        /**
+         * @brief Get the loading state
+         *
+         * @return MBILoaderState Current state
+         */
+        MBILoaderState GetState() const noexcept;
+
+        /**
+         * @brief Get the loading progress
+         *
+         * @return float Progress in [0;1]
+         */
+        float GetProgress() const noexcept;
+
+        /**
+         * @brief Get the path of the file being loaded
+         *
+         * @return const std::filesystem::path& Path of the file
+         */
+        const std::filesystem::path &GetPath() const noexcept;
+
+        /**
+         * @brief Get the number of columns of the file. Valid once the ready callback has been called.
+         *
+         * @return size_t Number of columns
+         */
+        size_t GetColumnCount() const noexcept;
+
+        /**
+         * @brief Get the samples of a column, to pass to MBIPlotChart::CreateVariable. The container is filled progressively.
+         *
+         * @param column Column index, in [0;GetColumnCount()[
+         * @return const MBIPlotChart::DataContainer* Samples of the column
+         */
+        const MBIPlotChart::DataContainer *GetColumn(size_t column) const;
+
+        /**
+         * @brief Get the name of a column
+         *
+         * @param column Column index, in [0;GetColumnCount()[
+         * @return const std::string& Name of the column, from the file header or "Column N"
+         */
+        const std::string &GetColumnName(size_t column) const;
+
+        /**
+         * @brief Get the sampling period of a column
+         *
+         * @param column Column index, in [0;GetColumnCount()[
+         * @return uint32_t Period in ms, 0 if unknown (CSV files)
+         */
+        uint32_t GetColumnPeriod(size_t column) const;
+
+    private:
+        /**
+         * @brief Samples parsed by the background thread, waiting to be appended by Update
+         *
+         */
+        struct ParsedChunk
+        {
+            std::vector<std::vector<DataPoint>> columns; ///< Samples of each column
+        };
+
+        /**
+         * @brief Description of a column
+         *
+         */
+        struct ColumnInfo
+        {
+            std::string name;  ///< Column name
+            uint32_t periodMs; ///< Sampling period in ms
+        };
+
+        std::filesystem::path m_path;                                    ///< File being loaded
+        MBILoaderReadyCb m_readyCb;                                      ///< Function called when columns are known
+        void *m_readyCbArg;                                              ///< Argument to pass to the function
+        bool m_ready;                                                    ///< Ready callback has been called
+        std::vector<std::unique_ptr<MBIPlotChart::DataContainer>> m_data; ///< Columns samples, filled by Update
+        std::vector<ColumnInfo> m_columns;                               ///< Columns description, written by the loading thread before any chunk
+
+        std::atomic<MBILoaderState> m_state; ///< Loading state
+        std::atomic<uint64_t> m_loaded;      ///< Bytes processed by the loading thread
+        std::atomic<uint64_t> m_total;       ///< Bytes to process
+        std::atomic<bool> m_cancel;          ///< Cancellation request
+
+        std::mutex m_mutex;               ///< Protects m_chunks, m_columnsKnown, m_finished and m_result
+        std::condition_variable m_cv;     ///< Signals the loading thread that chunks have been consumed or that loading is cancelled
+        std::deque<ParsedChunk> m_chunks; ///< Parsed chunks waiting for Update
+        bool m_columnsKnown;              ///< m_columns has been filled by the loading thread
+        bool m_finished;                  ///< Loading thread has pushed its last chunk
+        MBILoaderState m_result;          ///< State reached by the loading thread, published by Update
+        std::thread m_thread;             ///< Loading thread
+
+        /**
+         * @brief Stop and join the loading thread
+         *
+         */
+        void Stop() noexcept;
+
+        /**
+         * @brief Loading thread entry point
+         *
+         */
+        void LoadThread();
+
+        /**
+         * @brief Load a CSV file : chunks are split on line boundaries and parsed by several threads
+         *
+         * @return true File loaded or loading cancelled
+         * @return false File can't be read. Error is logged.
+         */
+        bool LoadCSV();
+
+        /**
+         * @brief Load a capture file (see MBICaptureFile) by blocks of samples
+         *
+         * @return true File loaded or loading cancelled
+         * @return false File can't be read. Error is logged.
+         */
+        bool LoadCapture();
+
+        /**
+         * @brief Give a parsed chunk to the UI thread, waiting if too many chunks are pending.
+         *
+         * @param chunk Parsed chunk
+         * @return true Chunk queued
+         * @return false Load cancelled
+         */
+        bool PushChunk(ParsedChunk &&chunk);
+
+        /**
+         * @brief Publish the columns description
+         *
+         * @param columns Columns of the file
+         */
+        void SetColumns(std::vector<ColumnInfo> &&columns);
+    };
+}
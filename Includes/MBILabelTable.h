@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "imgui.h"
+
+/**
+ * @brief Process wide table of interned strings. Each distinct label is stored once and identified by a small integer,
+ * so objects referencing a label (like CompactAnnotation) only store its id.
+ * Interned labels are never freed : returned strings remain valid until the end of the process.
+ *
+ * @note Thread safe.
+ */
+class MBILabelTable
+{
+public:
+    using LabelId = uint32_t;                             ///< Identifier of an interned label
+    static constexpr LabelId LABEL_EMPTY = ((LabelId)0); ///< Id of the empty label
+    static constexpr uint32_t LABEL_ID_BITS = 24;        ///< Number of significant bits of a label id
+    static constexpr LabelId LABEL_ID_MAX = ((LabelId)((1u << LABEL_ID_BITS) - 1));
+
+    /**
+     * @brief Get the id of a label, adding it to the table if needed.
+     *
+     * @param label Label to intern
+     * @return LabelId Id of the label. LABEL_EMPTY if the table is full.
+     */
+    static LabelId Intern(std::string_view label);
+
+    /**
+     * @brief Get an interned label
+     *
+     * @param id Id of the label
+     * @return const char* Label, empty string if the id is unknown
+     */
+    static const char *GetLabel(LabelId id) noexcept;
+
+    /**
+     * @brief Get the number of labels interned, including the empty one
+     *
+     * @return size_t Number of labels
+     */
+    static size_t Size() noexcept;
+};
+
+/**
+ * @brief Process wide palette of 256 colors, used by compact objects (like CompactAnnotation) to reference a color with one byte.
+ * Color 0 is white.
+ *
+ * @note Thread safe.
+ */
+class MBIColorPalette
+{
+public:
+    using ColorIndex = uint8_t;                                ///< Index of a color in the palette
+    static constexpr ColorIndex COLOR_DEFAULT = ((ColorIndex)0); ///< Index of the default color (white)
+    static constexpr size_t PALETTE_SIZE = 256;                ///< Number of colors in the palette
+
+    /**
+     * @brief Get the palette index of a color, adding it to the palette if needed.
+     *
+     * @param color Color to look for
+     * @return ColorIndex Index of the color. COLOR_DEFAULT if the palette is full.
+     */
+    static ColorIndex GetIndex(const ImVec4 &color);
+
+    /**
+     * @brief Get a color of the palette
+     *
+     * @param index Index of the color
+     * @return const ImVec4 Color
+     */
+    static const ImVec4 GetColor(ColorIndex index) noexcept;
+
+    /**
+     * @brief Replace a color of the palette. Objects referencing this index will use the new color.
+     *
+     * @param index Index of the color
+     * @param color New color
+     */
+    static void SetColor(ColorIndex index, const ImVec4 &color) noexcept;
+};
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace MBIMGUI
+{
+    /**
+     * @brief Static printf-like format of a log call site, identified by an integer.
+     *
+     * Formats are registered once per call site by the MBI_LOG macro : a log then only records the format id and the
+     * raw bytes of its arguments, the message being formatted when it is displayed or written to the logfile.
+     *
+     */
+    class MBILogFormat
+    {
+    public:
+        static constexpr uint32_t MAX_FORMATS = 4096; ///< Maximum number of registered formats
+        static constexpr uint32_t PLAIN_FORMAT = 0;   ///< Format "%s" of the logs raised with a message
+
+        /**
+         * @brief Register a new format
+         *
+         * @param format printf-like format, must remain valid during the application lifetime (string literal)
+         */
+        explicit MBILogFormat(const char *format) noexcept;
+
+        MBILogFormat(const MBILogFormat &) = delete;
+        MBILogFormat &operator=(const MBILogFormat &) = delete;
+
+        /**
+         * @brief Get the format identifier
+         *
+         * @return uint32_t Format identifier, PLAIN_FORMAT if MAX_FORMATS has been reached
+         */
+        uint32_t GetId() const noexcept;
+
+        /**
+         * @brief Get a registered format. Can be called from any thread.
+         *
+         * @param id Format identifier
+         * @return const char* printf-like format, "%s" if the identifier is unknown
+         */
+        static const char *Get(uint32_t id) noexcept;
+
+        /**
+         * @brief Format encoded arguments, see MBILogArgs
+         *
+         * @param format printf-like format
+         * @param args Encoded arguments
+         * @param size Size of args in bytes
+         * @param out String to which the message is appended
+         */
+        static void Format(const char *format, const uint8_t *args, size_t size, std::string &out);
+
+        /**
+         * @brief Hash data (FNV-1a), used to detect repeated messages without comparing or formatting them
+         *
+         * @param data Data to hash
+         * @param size Size of data in bytes
+         * @param hash Hash of the previous data, to chain several calls
+         * @return uint64_t Hash
+         */
+        static uint64_t Hash(const void *data, size_t size, uint64_t hash = HASH_SEED) noexcept
+        {
+            const uint8_t *bytes = (const uint8_t *)data;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Hash a printf-like format and its arguments without formatting them : numbers are hashed by value,
+         * strings by content. Arguments after an unsupported conversion are ignored.
+         *
+         * @param format printf-like format
+         * @param args Arguments of the format
+         * @param hash Hash of the previous data, to chain several calls
+         * @return uint64_t Hash
+         */
+        static uint64_t Hash(const char *format, va_list args, uint64_t hash = HASH_SEED) noexcept;
+
+        static constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ull; ///< Initial value of Hash
+
+    private:
+        uint32_t m_id; ///< Format identifier
+    };
+
+    /**
+     * @brief Raw arguments of a log, stored inline up to INLINE_SIZE bytes and spilled to the heap beyond. Each argument
+     * is a type tag followed by its value : 8 bytes for numbers and pointers, a length byte and the characters for
+     * strings, or a 4 bytes length and the characters for strings longer than 255 characters.
+     *
+     */
+    class MBILogArgs
+    {
+    public:
+        static constexpr size_t INLINE_SIZE = 96; ///< Size of the encoded arguments stored without allocation
+
+        static constexpr uint8_t TAG_INT = 'i';         ///< int64_t argument
+        static constexpr uint8_t TAG_UINT = 'u';        ///< uint64_t argument
+        static constexpr uint8_t TAG_DOUBLE = 'd';      ///< double argument
+        static constexpr uint8_t TAG_POINTER = 'p';     ///< Pointer argument, stored as uint64_t
+        static constexpr uint8_t TAG_STRING = 's';      ///< String argument, up to 255 characters
+        static constexpr uint8_t TAG_LONG_STRING = 'S'; ///< String argument longer than 255 characters
+
+        /**
+         * @brief Encode arguments
+         *
+         * @param args Arguments to encode : numbers, pointers and strings
+         */
+        template <typename... Args>
+        void Set(const Args &...args)
+        {
+            m_size = 0;
+            m_spill.clear();
+            (Add(args), ...);
+        }
+
+        /**
+         * @brief Set the encoded arguments
+         *
+         * @param data Encoded arguments
+         * @param size Size of data
+         */
+        void Assign(const uint8_t *data, size_t size)
+        {
+            m_size = 0;
+            m_spill.clear();
+            memcpy(Reserve(size), data, size);
+        }
+
+        const uint8_t *data() const noexcept { return m_spill.empty() ? m_data : m_spill.data(); }
+        size_t size() const noexcept { return m_size; }
+
+    private:
+        uint8_t m_data[INLINE_SIZE];  ///< Encoded arguments fitting inline
+        std::vector<uint8_t> m_spill; ///< Encoded arguments once they exceed INLINE_SIZE, empty otherwise
+        uint32_t m_size = 0;          ///< Size of the encoded arguments
+
+        /**
+         * @brief Append space to the encoded arguments, moving them to the heap when they no longer fit inline
+         *
+         * @param size Size to append
+         * @return uint8_t* Appended space
+         */
+        uint8_t *Reserve(size_t size)
+        {
+            const size_t offset = m_size;
+            m_size += (uint32_t)size;
+            if (m_spill.empty() && m_size <= INLINE_SIZE)
+            {
+                return &m_data[offset];
+            }
+            if (m_spill.empty())
+            {
+                m_spill.assign(m_data, m_data + offset);
+            }
+            m_spill.resize(m_size);
+            return &m_spill[offset];
+        }
+
+        void AddRaw(uint8_t tag, const void *value)
+        {
+            uint8_t *out = Reserve(9);
+            out[0] = tag;
+            memcpy(&out[1], value, 8);
+        }
+
+        void Add(std::string_view value)
+        {
+            if (value.size() <= 255)
+            {
+                uint8_t *out = Reserve(2 + value.size());
+                out[0] = TAG_STRING;
+                out[1] = (uint8_t)value.size();
+                memcpy(&out[2], value.data(), value.size());
+            }
+            else
+            {
+                const uint32_t length = (uint32_t)value.size();
+                uint8_t *out = Reserve(5 + value.size());
+                out[0] = TAG_LONG_STRING;
+                memcpy(&out[1], &length, sizeof(length));
+                memcpy(&out[5], value.data(), value.size());
+            }
+        }
+
+        void Add(const char *value)
+        {
+            Add(std::string_view(value ? value : "(null)"));
+        }
+
+        void Add(const std::string &value)
+        {
+            Add(std::string_view(value));
+        }
+
+        template <typename T>
+        void Add(const T &value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                const double v = (double)value;
+                AddRaw(TAG_DOUBLE, &v);
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                const int64_t v = (int64_t)value;
+                AddRaw(TAG_INT, &v);
+            }
+            else if constexpr (std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>)
+            {
+                Add((const char *)value);
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                const uint64_t v = (uint64_t)(uintptr_t)value;
+                AddRaw(TAG_POINTER, &v);
+            }
+            else if constexpr (std::is_signed_v<T>)
+            {
+                const int64_t v = (int64_t)value;
+                AddRaw(TAG_INT, &v);
+            }
+            else
+            {
+                static_assert(std::is_integral_v<T>, "Unsupported log argument type");
+                const uint64_t v = (uint64_t)value;
+                AddRaw(TAG_UINT, &v);
+            }
+        }
+    };
+
+    /**
+     * @brief Rate limiting and repeat state of a log call site, declared static by the MBI_LOG macros. The checks are
+     * done before the log is built : the rate limits are lock-free, a message repeating the previous one of the site is
+     * only counted under a spinlock, see MBILogger::LogFormat.
+     *
+     */
+    class MBILogSite
+    {
+    public:
+        static constexpr size_t REPEAT_SIZE = 256; ///< Maximum size of the arguments of a message whose repeats are collapsed
+
+        MBILogSite() noexcept = default;
+        MBILogSite(const MBILogSite &) = delete;
+        MBILogSite &operator=(const MBILogSite &) = delete;
+
+        /**
+         * @brief Check whether the site logs for the first time
+         *
+         * @return true First call
+         */
+        bool Once() noexcept
+        {
+            return !m_done.load(std::memory_order_relaxed) && !m_done.exchange(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Count a call and check whether it is one of the calls 1, n + 1, 2n + 1...
+         *
+         * @param n Period in calls, 0 is handled as 1
+         * @return true The call must be logged
+         */
+        bool Every(uint64_t n) noexcept
+        {
+            return m_count.fetch_add(1, std::memory_order_relaxed) % (n ? n : 1) == 0;
+        }
+
+        /**
+         * @brief Count a call and check whether it is one of the maxLogs first calls of the current time window, the
+         * windows being aligned on multiples of period
+         *
+         * @param maxLogs Maximum number of logs per window
+         * @param period Duration of a window in us
+         * @param time Date of the call in us since epoch
+         * @return uint32_t 0 if the call must be discarded, otherwise 1 + the number of calls discarded since the
+         * previous log of the site
+         */
+        uint32_t Limit(uint32_t maxLogs, int64_t period, int64_t time) noexcept
+        {
+            /* Window and calls in it updated at once, so a window change can't lose the calls of other threads */
+            const uint64_t window = (uint64_t)(time / (period > 0 ? period : 1)) << 32;
+            uint64_t state = m_window.load(std::memory_order_relaxed);
+            uint64_t next;
+            do
+            {
+                const uint64_t calls = ((state & WINDOW_MASK) == window) ? (state & CALLS_MASK) : 0;
+                next = window | ((calls < CALLS_MASK) ? calls + 1 : CALLS_MASK);
+            } while (!m_window.compare_exchange_weak(state, next, std::memory_order_relaxed));
+
+            if ((next & CALLS_MASK) > maxLogs)
+            {
+                m_discarded.fetch_add(1, std::memory_order_relaxed);
+                return 0;
+            }
+            const uint64_t discarded = m_discarded.exchange(0, std::memory_order_relaxed);
+            return (uint32_t)((discarded < UINT32_MAX - 1) ? discarded + 1 : UINT32_MAX);
+        }
+
+    private:
+        friend class MBILogger;
+
+        static constexpr uint64_t WINDOW_MASK = 0xFFFFFFFF00000000ull; ///< Window bits of m_window
+        static constexpr uint64_t CALLS_MASK = 0x00000000FFFFFFFFull;  ///< Calls bits of m_window
+
+        std::atomic<bool> m_done{false};         ///< The site has logged once
+        std::atomic<uint64_t> m_count{0};        ///< Calls of the site for Every
+        std::atomic<uint64_t> m_window{0};       ///< Limit state : index of the current window in the high 32 bits, calls in it in the low 32 bits
+        std::atomic<uint64_t> m_discarded{0};    ///< Calls discarded by Limit since the previous log
+
+        /* Repeat state, protected by m_lock. Trivially destructible : the logger may flush a static site at exit. */
+        std::atomic_flag m_lock = ATOMIC_FLAG_INIT; ///< Spinlock of the repeat state
+        const void *m_logger = nullptr;             ///< Logger to which the site is registered while it has repeats
+        uint64_t m_hash = 0;                        ///< Hash of the level, format and arguments of the last message
+        int64_t m_repeatStart = 0;                  ///< Date of the first repeat not logged yet
+        int64_t m_repeatEnd = 0;                    ///< Date of the last repeat not logged yet
+        uint32_t m_repeats = 0;                     ///< Repeats of the last message not logged yet
+        int32_t m_level = 0;                        ///< Level of the last message
+        uint32_t m_format = 0;                      ///< Format of the last message
+        uint32_t m_thread = 0;                      ///< Thread which logged the last message
+        uint32_t m_size = 0;                        ///< Size of m_args
+        bool m_hasLast = false;                     ///< The last message is stored in m_args, its repeats are collapsed
+        uint8_t m_args[REPEAT_SIZE];                ///< Encoded arguments, or characters of a plain message, of the last message
+
+        void Lock() noexcept
+        {
+            while (m_lock.test_and_set(std::memory_order_acquire))
+            {
+            }
+        }
+
+        void Unlock() noexcept
+        {
+            m_lock.clear(std::memory_order_release);
+        }
+    };
+}
+
+/**
+ * @brief Log with deferred formatting : the format is registered once for the call site, the arguments are stored
+ * raw and the message is only formatted when displayed or written to the logfile. A message repeating the previous
+ * one of the call site is only counted, see MBILogger::LogFormat.
+ *
+ * MBI_LOG(MBIMGUI::GetLogger(), MBIMGUI::LOG_LEVEL_INFO, "Frame %d received in %.3f ms", frame, ms);
+ */
+#define MBI_LOG(logger, level, format, ...)                                           \
+    do                                                                                \
+    {                                                                                 \
+        static MBIMGUI::MBILogSite mbiLogSite_;                                       \
+        static const MBIMGUI::MBILogFormat mbiLogFormat_(format);                     \
+        (logger).LogFormat(mbiLogSite_, (level), mbiLogFormat_, ##__VA_ARGS__);       \
+    } while (0)
+
+/**
+ * @brief Log with deferred formatting, only the first time the call site is reached
+ *
+ * MBI_LOG_ONCE(MBIMGUI::GetLogger(), MBIMGUI::LOG_LEVEL_WARNING, "Device %s not calibrated", name);
+ */
+#define MBI_LOG_ONCE(logger, level, format, ...)                                      \
+    do                                                                                \
+    {                                                                                 \
+        static MBIMGUI::MBILogSite mbiLogSite_;                                       \
+        static const MBIMGUI::MBILogFormat mbiLogFormat_(format);                     \
+        (logger).LogOnce(mbiLogSite_, (level), mbiLogFormat_, ##__VA_ARGS__);         \
+    } while (0)
+
+/**
+ * @brief Log with deferred formatting, once every n times the call site is reached
+ *
+ * MBI_LOG_EVERY(MBIMGUI::GetLogger(), 1000, MBIMGUI::LOG_LEVEL_DEBUG, "Sample %d : %f", index, value);
+ */
+#define MBI_LOG_EVERY(logger, n, level, format, ...)                                  \
+    do                                                                                \
+    {                                                                                 \
+        static MBIMGUI::MBILogSite mbiLogSite_;                                       \
+        static const MBIMGUI::MBILogFormat mbiLogFormat_(format);                     \
+        (logger).LogEvery(mbiLogSite_, (n), (level), mbiLogFormat_, ##__VA_ARGS__);   \
+    } while (0)
+
+/**
+ * @brief Log with deferred formatting, at most maxLogs times per window of periodMs milliseconds for the call site.
+ * A log following discarded calls shows the number of calls it stands for : "message (×N)".
+ *
+ * MBI_LOG_LIMIT(MBIMGUI::GetLogger(), 5, 1000, MBIMGUI::LOG_LEVEL_ERROR, "CRC error on frame %d", frame);
+ */
+#define MBI_LOG_LIMIT(logger, maxLogs, periodMs, level, format, ...)                                 \
+    do                                                                                               \
+    {                                                                                                \
+        static MBIMGUI::MBILogSite mbiLogSite_;                                                      \
+        static const MBIMGUI::MBILogFormat mbiLogFormat_(format);                                    \
+        (logger).LogLimit(mbiLogSite_, (maxLogs), (periodMs), (level), mbiLogFormat_, ##__VA_ARGS__); \
+    } while (0)
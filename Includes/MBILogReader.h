@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MBILogger.h"
+
+namespace MBIMGUI
+{
+    /**
+     * @brief Reader of the binary logfiles written by MBILogger, for offline tools.
+     *
+     * A binary logfile is a sequence of sessions. Each session starts with the 8 bytes MAGIC followed by the session
+     * start date (int64, us since epoch), then holds records starting with a type byte (integers are little endian) :
+     * - RECORD_FORMAT : format identifier (uint32), length (uint16) and characters of a format, written before the
+     * first log using it in the session
+     * - RECORD_LOG : level (uint8), date (int64, us since epoch), thread identifier (uint32), format identifier (uint32),
+     * arguments size (uint32) and arguments encoded as in MBILogArgs
+     * - RECORD_MESSAGE : level (uint8), date (int64, us since epoch), thread identifier (uint32), length (uint32) and
+     * characters of a message
+     *
+     */
+    class MBILogReader
+    {
+    public:
+        static constexpr char MAGIC[8] = {'M', 'B', 'I', 'L', 'O', 'G', 'B', '1'}; ///< Session header
+        static constexpr uint8_t RECORD_FORMAT = 'F';                              ///< Format definition record
+        static constexpr uint8_t RECORD_LOG = 'L';                                 ///< Log with deferred formatting record
+        static constexpr uint8_t RECORD_MESSAGE = 'T';                             ///< Log with a message record
+
+        /**
+         * @brief Log read from the file
+         *
+         */
+        struct Record
+        {
+            MBILogLevel level;   ///< Level of the log
+            int64_t time;        ///< Date of the log in us since epoch
+            uint32_t thread;     ///< Identifier of the thread which raised the log
+            std::string message; ///< Formatted message
+        };
+
+        /**
+         * @brief Open a binary logfile
+         *
+         * @param path Path of the logfile
+         * @return true File opened and starting with a session header
+         * @return false Can't open the file or not a binary logfile
+         */
+        bool Open(std::string_view path);
+
+        /**
+         * @brief Read the next log
+         *
+         * @param record Destination of the log
+         * @return true A log has been read
+         * @return false End of file or corrupted file
+         */
+        bool Next(Record &record);
+
+        /**
+         * @brief Get the start date of the current session
+         *
+         * @return int64_t Date in us since epoch
+         */
+        int64_t GetSessionStart() const noexcept;
+
+    private:
+        static constexpr uint32_t MAX_ARGS_SIZE = 1u << 24; ///< Arguments size above which a record is corrupted
+
+        std::ifstream m_file;              ///< Logfile
+        std::vector<std::string> m_formats; ///< Formats of the current session, indexed by identifier
+        std::vector<uint8_t> m_args;        ///< Arguments of the last log read
+        int64_t m_sessionStart = 0;        ///< Start date of the current session
+
+        /**
+         * @brief Read a session header, the magic having been read
+         *
+         * @return true Header read
+         */
+        bool ReadSession();
+
+        /**
+         * @brief Read bytes from the file
+         *
+         * @param data Destination
+         * @param size Number of bytes
+         * @return true All the bytes have been read
+         */
+        bool Read(void *data, size_t size);
+    };
+}
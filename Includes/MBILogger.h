@@ -1,8 +1,18 @@
 #pragma once
 
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <string_view>
+#include <thread>
+#include <vector>
 
+#include "MBIBoundedQueue.h"
+#include "MBILogFormat.h"
 #include "MBISyncCircularBuffer.h"
 
 namespace MBIMGUI
@@ -20,6 +30,17 @@ namespace MBIMGUI
         LOG_LEVEL_DEBUG    ///< Debug log
     } MBILogLevel;
 
+    /**
+     * @brief Behaviour of the asynchronous logger when its queue is full
+     *
+     */
+    typedef enum _MBILogOverflow
+    {
+        LOG_OVERFLOW_BLOCK, ///< The caller drains the stagings itself, waiting for the writer thread if it is draining
+        LOG_OVERFLOW_DROP,  ///< The log is discarded
+        LOG_OVERFLOW_COUNT  ///< The log is discarded and counted, the writer thread then logs the number of discarded logs
+    } MBILogOverflow;
+
     /**
      * @brief This class represent the logger of the application. The logger allows you to display debug and operational
      * logs to the users, to write them into a logfile, to display error popup etc.
@@ -40,8 +61,33 @@ namespace MBIMGUI
              *
              * @param level Level of the log
              * @param msg Message of the log
+             * @param time Date of the log in us since epoch
+             */
+            explicit MBILog(MBILogLevel level = LOG_LEVEL_INFO, std::string_view msg = "", int64_t time = 0);
+
+            /**
+             * @brief Construct a new MBILog object with deferred formatting
+             *
+             * @param level Level of the log
+             * @param format Format identifier, see MBILogFormat
+             * @param time Date of the log in us since epoch
+             * @param args Arguments of the format
+             */
+            template <typename... Args>
+            MBILog(MBILogLevel level, uint32_t format, int64_t time, const Args &...args) : m_level(level), m_time(time), m_format(format)
+            {
+                m_args.Set(args...);
+            }
+
+            /**
+             * @brief Construct a new MBILog object with deferred formatting from encoded arguments
+             *
+             * @param level Level of the log
+             * @param format Format identifier, see MBILogFormat
+             * @param time Date of the log in us since epoch
+             * @param args Encoded arguments of the format
              */
-            explicit MBILog(MBILogLevel level = LOG_LEVEL_INFO, std::string_view msg = "");
+            MBILog(MBILogLevel level, uint32_t format, int64_t time, MBILogArgs &&args) : m_level(level), m_time(time), m_format(format), m_args(std::move(args)) {}
 
             /**
              * @brief Get the Log level as an object
@@ -52,44 +98,388 @@ namespace MBIMGUI
             /**
              * @brief Get the Log level as a string
              *
-             * @return const std::string level of the log
+             * @return const char* level of the log
              */
-            const std::string GetLevelString() const noexcept;
+            const char *GetLevelString() const noexcept;
             /**
-             * @brief Get the Message Log object as a string
+             * @brief Get the Message Log object as a string. Logs with deferred formatting are formatted into buffer.
              *
+             * @param buffer String used to format the message if needed
              * @return const std::string& message of the log
              */
-            const std::string &GetMessageLog() const noexcept;
+            const std::string &GetMessageLog(std::string &buffer) const;
             /**
-             * @brief Get the date when the log has been raised.
+             * @brief Get the format identifier of the log
              *
-             * @return const std::string& time as a string
+             * @return uint32_t MBILogFormat::PLAIN_FORMAT if the log has a message
              */
-            const std::string &GetTime() const noexcept;
+            uint32_t GetFormat() const noexcept;
+            /**
+             * @brief Get the arguments of the format
+             *
+             * @return const MBILogArgs& encoded arguments
+             */
+            const MBILogArgs &GetArgs() const noexcept;
+            /**
+             * @brief Get the date when the log has been raised. Use MBILogTime to format it.
+             *
+             * @return int64_t time in us since epoch
+             */
+            int64_t GetTime() const noexcept;
+            /**
+             * @brief Set the date of the log
+             *
+             * @param time time in us since epoch
+             */
+            void SetTime(int64_t time) noexcept;
+            /**
+             * @brief Get the identifier of the thread which raised the log
+             *
+             * @return uint32_t thread identifier
+             */
+            uint32_t GetThread() const noexcept;
+            /**
+             * @brief Set the identifier of the thread which raised the log
+             *
+             * @param thread thread identifier
+             */
+            void SetThread(uint32_t thread) noexcept;
+            /**
+             * @brief Get the number of occurrences the log stands for, displayed as "message (×N)" when greater than 1
+             *
+             * @return uint32_t Number of occurrences
+             */
+            uint32_t GetRepeat() const noexcept;
+            /**
+             * @brief Set the number of occurrences the log stands for
+             *
+             * @param repeat Number of occurrences
+             */
+            void SetRepeat(uint32_t repeat) noexcept;
 
         private:
             MBILogLevel m_level;   ///< Level of the log
             std::string m_message; ///< Message of the log
-            std::string m_time;    ///< Date of the log
+            int64_t m_time;        ///< Date of the log in us since epoch
+            uint32_t m_thread = 0;                          ///< Identifier of the thread which raised the log
+            uint32_t m_format = MBILogFormat::PLAIN_FORMAT; ///< Format identifier for deferred formatting
+            MBILogArgs m_args;                              ///< Arguments of the format
+            uint32_t m_repeat = 1;                          ///< Number of occurrences the log stands for
+        };
+
+        /**
+         * @brief Internal class formatting the dates of the logs. The local time is only computed when the second
+         * changes, so formatting successive logs doesn't allocate nor call localtime. One object per thread.
+         *
+         */
+        class MBILogTime
+        {
+        public:
+            /**
+             * @brief Format a date as "HH:MM:SS", or "HH:MM:SS.uuuuuu" if precise
+             *
+             * @param time Date in us since epoch
+             * @param precise Add the microseconds
+             * @return const char* Formatted date, valid until next call
+             */
+            const char *Format(int64_t time, bool precise) noexcept;
+
+        private:
+            int64_t m_second = INT64_MIN; ///< Second of m_text
+            char m_text[16] = "";         ///< Last formatted date
         };
 
-        MBISyncCircularBuffer<MBILog> m_logs; ///< List of the current logs
+        static constexpr size_t DEFAULT_HISTORY_SIZE = 1000;   ///< Default number of logs kept in the history, the ring being preallocated
+        static constexpr size_t MAX_HISTORY_SIZE = 1000000;    ///< Maximum number of logs kept in the history
+
+        std::unique_ptr<MBISyncCircularBuffer<MBILog>> m_logs; ///< List of the current logs
         friend class MBILogWindow;
+        friend class MBILogIndex;
         std::string m_logfile;      ///< Path of the current logfile
-        std::ofstream m_filestream; ///< Stream used to write into the logfile
+        void *m_file;               ///< Logfile handle
+        void *m_nextFile;           ///< Next logfile segment, created and preallocated before the rotation needs it
+        uint64_t m_fileSize;        ///< Size of the current logfile segment
+        uint64_t m_segmentStart;    ///< Size of the current logfile segment before its first log
+        uint64_t m_maxFileSize;     ///< Size from which the logfile is rotated, 0 if the rotation is disabled
+        uint32_t m_maxFiles;        ///< Number of logfile segments kept, current one included
         std::string m_errToPopup;   ///< Last error raised, to be displayed in the popup
+        mutable std::mutex m_popupMutex; ///< Protects m_errToPopup
 
-        bool m_popupOnError; ///< Is the logger must display a popup in case of an error ?
-        bool m_displayPopup; ///< True if a popup must be displayed. It means that an error has been raised in the previous frame
+        bool m_popupOnError;              ///< Is the logger must display a popup in case of an error ?
+        std::atomic<bool> m_displayPopup; ///< True if a popup must be displayed. It means that an error has been raised in the previous frame
         bool m_logToFile;    ///< Is the logger must write the logs into a file ?
+        bool m_precise;      ///< Sub-millisecond monotonic dates
+        bool m_binary;       ///< Is the logfile written in binary format ?
+        std::vector<bool> m_formatsWritten; ///< Formats already written in the binary logfile
+
+        int64_t m_startTime;                                ///< Wall clock date at logger creation in us since epoch
+        std::chrono::steady_clock::time_point m_startClock; ///< Monotonic clock at logger creation
+
+        static constexpr uint32_t WRITER_PERIOD_MS = 20; ///< Period at which the writer thread drains the logs in asynchronous mode
+        static constexpr size_t DEFAULT_STAGING_SIZE = 256; ///< Default capacity of the staging of each thread
+        static constexpr int64_t REPEAT_PERIOD_US = 1000000; ///< Maximum delay before the collapsed repeats of a message are logged
+
+        /**
+         * @brief Repeats of the last message of a site, taken from the site to be logged as "message (×N)"
+         *
+         */
+        struct Repeats
+        {
+            MBILogLevel level;                        ///< Level of the message
+            uint32_t format;                          ///< Format of the message, MBILogFormat::PLAIN_FORMAT for a plain message
+            uint32_t thread;                          ///< Thread which logged the message
+            uint32_t count;                           ///< Number of repeats
+            int64_t time;                             ///< Date of the last repeat
+            uint32_t size;                            ///< Size of args
+            uint8_t args[MBILogSite::REPEAT_SIZE];    ///< Encoded arguments, or characters of a plain message
+        };
 
         /**
-         * @brief Close the current logfile.
+         * @brief Logs raised by a thread and not stored yet. Only the owner thread pushes, only the drain pops.
+         *
+         */
+        struct Staging
+        {
+            Staging(size_t capacity, uint32_t threadId) : queue(capacity), thread(threadId), closed(false) {}
+
+            MBIBoundedQueue<MBILog> queue; ///< Logs waiting for the drain
+            uint32_t thread;               ///< Identifier of the owner thread
+            std::atomic<bool> closed;      ///< Owner thread exited, removed once drained
+            MBILogSite site;               ///< Repeat state of the plain messages of the thread, flushed by the drain with the staging
+        };
+
+        const uint64_t m_instance;                      ///< Unique identifier of the logger, to find the stagings of a thread
+        std::vector<std::shared_ptr<Staging>> m_stagings; ///< Stagings of the threads which logged
+        std::mutex m_stagingsMutex;                     ///< Protects m_stagings, taken when a thread logs for the first time
+        std::atomic<size_t> m_stagingSize;              ///< Capacity of the stagings created
+        std::mutex m_drainMutex;                        ///< Serializes the drains, owner of the history insertions and of the logfile
+        std::vector<MBILog> m_merge;                    ///< Logs of a drain, sorted by date
+        std::vector<MBILog> m_repeatLogs;               ///< Repeats of the sites added by a drain, merged into m_merge
+        std::vector<MBILogSite *> m_repeatSites;        ///< Call sites with repeats not logged yet, flushed by the drain
+        std::mutex m_repeatSitesMutex;                  ///< Protects m_repeatSites
+
+        std::atomic<bool> m_async;              ///< Asynchronous mode enabled
+        std::atomic<MBILogOverflow> m_overflow; ///< Behaviour when a staging is full
+        std::atomic<bool> m_flushOnError;       ///< Error logs drained by the calling thread before Log returns
+        std::atomic<uint64_t> m_dropped;        ///< Logs discarded because a staging was full
+        uint64_t m_droppedReported;             ///< Discarded logs already reported by the drain
+        std::mutex m_writerMutex;               ///< Protects m_stopWriter
+        std::condition_variable m_writerCv;     ///< Wakes up the writer thread
+        bool m_stopWriter;                      ///< Writer thread stop request
+        std::thread m_writer;                   ///< Writer thread
+        std::string m_batch;                    ///< Content written to the file at once by the drain
+
+        /**
+         * @brief Close the current logfile. m_drainMutex must be locked.
          *
          */
         void CloseLogFile();
 
+        /**
+         * @brief Open the current logfile segment and preallocate it if the rotation is enabled. m_drainMutex must be locked.
+         *
+         * @param append Keep the content of an existing file
+         * @return true File opened
+         */
+        bool OpenLogFile(bool append);
+
+        /**
+         * @brief Write the session header at the beginning of a logfile segment. m_drainMutex must be locked.
+         *
+         */
+        void WriteHeader();
+
+        /**
+         * @brief Write to the current logfile segment. m_drainMutex must be locked.
+         *
+         * @param data Data to write
+         * @param size Size of data
+         * @return true Data written
+         */
+        bool WriteRaw(const void *data, size_t size) noexcept;
+
+        /**
+         * @brief Close the current segment, shift the kept segments and start a new one. The new segment is the one
+         * prepared by PrepareNextSegment if any, so the switch is a handle swap. m_drainMutex must be locked, so no
+         * write uses the handle while it is replaced.
+         *
+         */
+        void Rotate();
+
+        /**
+         * @brief Create and preallocate the next logfile segment once the current one is half full. Only called by the
+         * periodic drains, so the logging threads don't create files. m_drainMutex must be locked.
+         *
+         */
+        void PrepareNextSegment();
+
+        /**
+         * @brief Close and remove the next logfile segment prepared. m_drainMutex must be locked.
+         *
+         */
+        void DiscardNextSegment() noexcept;
+
+        /**
+         * @brief Shift the kept segments : the logfile becomes segment 1, segment 1 becomes 2... the last one is replaced.
+         *
+         */
+        void ShiftSegments() noexcept;
+
+        /**
+         * @brief Get the path of a logfile segment : "log.txt", "log.1.txt", "log.2.txt"...
+         *
+         * @param index Index of the segment, 0 for the current one
+         * @return std::filesystem::path Path of the segment
+         */
+        std::filesystem::path GetSegmentPath(uint32_t index) const;
+
+        /**
+         * @brief Get the path of the next logfile segment while it is prepared : "log.next.txt"
+         *
+         * @return std::filesystem::path Path of the next segment
+         */
+        std::filesystem::path GetNextSegmentPath() const;
+
+        /**
+         * @brief Append the line of a log in the file format
+         *
+         * @param log Log to format
+         * @param line String to which the line is appended
+         */
+        void AppendLine(const MBILog &log, std::string &line) const;
+
+        /**
+         * @brief Append the record of a log in the binary file format, see MBILogReader
+         *
+         * @param log Log to encode
+         * @param record String to which the record is appended
+         */
+        void AppendBinary(const MBILog &log, std::string &record);
+
+        /**
+         * @brief Append a log to the file content, in the logfile format. If the log doesn't fit in the current
+         * segment, the content is written and the logfile rotated first. m_drainMutex must be locked.
+         *
+         * @param log Log to write
+         * @param content Content not written yet, to which the log is appended
+         */
+        void AppendRecord(const MBILog &log, std::string &content);
+
+        /**
+         * @brief Push a new log into the staging of the calling thread, applying the overflow policy if it is full
+         *
+         * @param log Log to push
+         */
+        void Post(MBILog &&log);
+
+        /**
+         * @brief Get the date of a new log
+         *
+         * @return int64_t Date in us since epoch
+         */
+        int64_t GetTimestamp() const noexcept;
+
+        /**
+         * @brief Get the staging of the calling thread, created on first call
+         *
+         * @return Staging& Staging of the calling thread
+         */
+        Staging &GetStaging();
+
+        /**
+         * @brief Writer thread entry point
+         *
+         */
+        void WriterThread();
+
+        /**
+         * @brief Count a message if it repeats the last one of its site, before the log is built. Otherwise the message
+         * becomes the last one of the site, and the repeats of the previous one are posted as "message (×N)". Repeats
+         * are also posted when REPEAT_PERIOD_US elapsed since the first one, or by the drain if the site stays quiet.
+         *
+         * @param site Call site, or staging site for the plain messages
+         * @param level Level of the message
+         * @param format Format of the message, MBILogFormat::PLAIN_FORMAT for a plain message
+         * @param hash Hash of the arguments, or of the plain message
+         * @param data Encoded arguments, or characters of the plain message. If null, only the hash is compared and
+         * the message is set by SetLastMessage once formatted.
+         * @param size Size of data
+         * @param time Date of the message
+         * @return true The message repeats the last one, it must not be logged
+         */
+        bool Repeat(MBILogSite &site, MBILogLevel level, uint32_t format, uint64_t hash, const uint8_t *data, size_t size, int64_t time);
+
+        /**
+         * @brief Set the plain message of the last message of a site once formatted, see Repeat
+         *
+         * @param site Staging site of the calling thread
+         * @param message Formatted message
+         */
+        void SetLastMessage(MBILogSite &site, std::string_view message) noexcept;
+
+        /**
+         * @brief Take the repeats of the last message of a site. The site must be locked.
+         *
+         * @param site Call site
+         * @param repeats Repeats taken
+         * @return true The site had repeats
+         */
+        static bool TakeRepeats(MBILogSite &site, Repeats &repeats) noexcept;
+
+        /**
+         * @brief Build the log "message (×N)" of repeats
+         *
+         * @param repeats Repeats taken from a site
+         * @return MBILog Log of the repeats, dated by the last repeat
+         */
+        static MBILog RepeatLog(const Repeats &repeats);
+
+        /**
+         * @brief Add the repeats of a site to m_repeatLogs if REPEAT_PERIOD_US elapsed since the first one.
+         * Must be called with m_drainMutex locked.
+         *
+         * @param site Call site
+         * @param now Date of the drain
+         * @param force Add the repeats whatever their date
+         * @param registered Site of m_repeatSites, unregistered once it has no repeats
+         * @return true The site is still registered to the logger
+         */
+        bool FlushSite(MBILogSite &site, int64_t now, bool force, bool registered);
+
+        /**
+         * @brief Drain the stagings : merge their logs by date, store them in the history and write them to the file
+         * in one batch. The repeats of the quiet sites are added. Must be called with m_drainMutex locked.
+         *
+         * @param flushRepeats Add the repeats of all the sites, e.g. when the logger is destroyed
+         */
+        void DrainUnlocked(bool flushRepeats = false);
+
+        /**
+         * @brief Drain the stagings, see DrainUnlocked
+         *
+         * @param periodic Drain of the frame or of the writer thread, which also prepares the next logfile segment
+         */
+        void Drain(bool periodic = false);
+
+        /**
+         * @brief Get the last error raised, to be displayed in the popup
+         *
+         * @return std::string Copy of the error message
+         */
+        std::string GetErrorToPopup() const;
+
+        /**
+         * @brief Clear the error displayed in the popup
+         *
+         */
+        void ClearErrorToPopup();
+
+        /**
+         * @brief Stop the writer thread, after it has written the queued logs
+         *
+         */
+        void StopWriter();
+
     public:
         /**
          * @brief Construct a new MBILogger object
@@ -115,24 +505,188 @@ namespace MBIMGUI
          *
          * @param popupOnError Any error log will be displayed in a popup to the user.
          * @param logfile All logs will be written in the specified logfile. To disable the log file, pass an empty string.
+         * @param binary Write the logfile in binary format : logs with deferred formatting are written with their raw
+         * arguments, without formatting. Use MBILogReader to read it. An existing logfile of the other format is not
+         * appended to : a new logfile is started.
+         */
+        void Configure(bool popupOnError = false, std::string_view logfile = "", bool binary = false);
+
+        /**
+         * @brief Enable the rotation of the logfile. When the logfile reaches maxFileSize, it is renamed "name.1.ext",
+         * the previous "name.1.ext" becomes "name.2.ext"... and a new logfile is started. Segments are preallocated to
+         * maxFileSize. The next segment is created and preallocated by the drain of the frame, or by the writer thread in
+         * asynchronous mode, before the current one is full. Call it before Configure.
+         * Without rotation, an existing logfile larger than 4096 bytes is truncated when opened.
+         *
+         * @param maxFileSize Size of a segment in bytes, 0 to disable the rotation
+         * @param maxFiles Number of segments kept, current one included
+         */
+        void SetRotation(uint64_t maxFileSize, uint32_t maxFiles = 5);
+
+        /**
+         * @brief Enable or disable the asynchronous mode. Log only pushes the log into a bounded lock-free staging owned
+         * by the calling thread. In asynchronous mode, a writer thread drains the stagings and writes the logs to the
+         * file by batches. Otherwise, Update drains them on the UI thread each frame and a caller whose staging is full
+         * drains them itself when the overflow policy is LOG_OVERFLOW_BLOCK. Call it at application start, before other
+         * threads log.
+         *
+         * @param async Enable the asynchronous mode
+         * @param queueSize Maximum number of logs waiting in the staging of each thread
+         * @param overflow Behaviour when a staging is full
+         */
+        void SetAsync(bool async, size_t queueSize = DEFAULT_STAGING_SIZE, MBILogOverflow overflow = LOG_OVERFLOW_BLOCK);
+
+        /**
+         * @brief Drain the stagings when the asynchronous mode is disabled, storing the collapsed repeats of a message
+         * which stopped repeating (see Log). Called by the framework each frame.
+         *
+         */
+        void Update();
+
+        /**
+         * @brief Drain the stagings on the calling thread after each error log, so errors are stored and written to the
+         * logfile before Log returns, e.g. to keep them if the application crashes. Other logs are still drained each
+         * frame or by the writer thread. Disabled by default : the logging threads then wait for each other on errors.
+         *
+         * @param flush Enable the drain on errors
+         */
+        void SetFlushOnError(bool flush) noexcept;
+
+        /**
+         * @brief Get the number of logs discarded because a staging was full
+         *
+         * @return uint64_t Number of discarded logs
+         */
+        uint64_t GetDroppedCount() const noexcept;
+
+        /**
+         * @brief Date the logs with a sub-millisecond monotonic clock instead of the system clock, and display the
+         * microseconds. Logs raised at high rate are then ordered. Call it at application start.
+         *
+         * @param precise Enable precise dates
+         */
+        void SetPreciseTime(bool precise) noexcept;
+
+        /**
+         * @brief Set the number of logs kept in the history displayed by the log window. The current history is
+         * cleared. Call it at application start, from the UI thread.
+         *
+         * @param size Number of logs, up to 1000000. Default is 1000. The history is preallocated, about 160 bytes per log.
          */
-        void Configure(bool popupOnError = false, std::string_view logfile = "");
+        void SetHistorySize(size_t size);
 
         /**
-         * @brief Log a message
+         * @brief Log a message. A message repeating the previous one of the thread is only counted, see below.
          *
          * @param level Level of the message
          * @param msg Message to be logged
          */
         void Log(MBILogLevel level, std::string_view msg);
         /**
-         * @brief Log a message
+         * @brief Log a message. A message repeating the previous one of the thread is only counted, and logged as
+         * "message (×N)" once another message is logged, or after one second. Repeats are detected from a hash of the
+         * format and of the arguments, before formatting. Messages longer than 256 characters are never collapsed.
          *
          * @param level Level of the message
          * @param msg Message to be logged
          * @param ... Varargs
          */
         void Log(MBILogLevel level, const char *msg, ...);
+        /**
+         * @brief Log a message with deferred formatting : only the format identifier and the raw arguments are
+         * stored, the message is formatted when displayed or written to the logfile. Use the MBI_LOG macro, which
+         * registers the format once per call site.
+         *
+         * @param level Level of the message
+         * @param format Format of the message
+         * @param args Arguments of the format : numbers, pointers and strings
+         */
+        template <typename... Args>
+        void LogFormat(MBILogLevel level, const MBILogFormat &format, const Args &...args)
+        {
+            Post(MBILog(level, format.GetId(), GetTimestamp(), args...));
+        }
+        /**
+         * @brief Log a message with deferred formatting, collapsing its repeats : a message with the same level and
+         * arguments as the previous one of the call site, whatever the thread, is only counted. The repeats are logged
+         * as "message (×N)" once the site logs another message, or after one second. Use the MBI_LOG macro, which
+         * declares the site.
+         *
+         * @param site Repeat state of the call site
+         * @param level Level of the message
+         * @param format Format of the message
+         * @param args Arguments of the format : numbers, pointers and strings
+         */
+        template <typename... Args>
+        void LogFormat(MBILogSite &site, MBILogLevel level, const MBILogFormat &format, const Args &...args)
+        {
+            MBILogArgs encoded;
+            encoded.Set(args...);
+            const int64_t time = GetTimestamp();
+            if (!Repeat(site, level, format.GetId(), MBILogFormat::Hash(encoded.data(), encoded.size()), encoded.data(), encoded.size(), time))
+            {
+                Post(MBILog(level, format.GetId(), time, std::move(encoded)));
+            }
+        }
+        /**
+         * @brief Log a message with deferred formatting, only the first time the call site is reached. Use the
+         * MBI_LOG_ONCE macro, which declares the site.
+         *
+         * @param site Rate limiting state of the call site
+         * @param level Level of the message
+         * @param format Format of the message
+         * @param args Arguments of the format
+         */
+        template <typename... Args>
+        void LogOnce(MBILogSite &site, MBILogLevel level, const MBILogFormat &format, const Args &...args)
+        {
+            if (site.Once())
+            {
+                LogFormat(level, format, args...);
+            }
+        }
+        /**
+         * @brief Log a message with deferred formatting, once every n times the call site is reached. Use the
+         * MBI_LOG_EVERY macro, which declares the site.
+         *
+         * @param site Rate limiting state of the call site
+         * @param n Period in calls
+         * @param level Level of the message
+         * @param format Format of the message
+         * @param args Arguments of the format
+         */
+        template <typename... Args>
+        void LogEvery(MBILogSite &site, uint64_t n, MBILogLevel level, const MBILogFormat &format, const Args &...args)
+        {
+            if (site.Every(n))
+            {
+                LogFormat(level, format, args...);
+            }
+        }
+        /**
+         * @brief Log a message with deferred formatting, at most maxLogs times per window of periodMs milliseconds for
+         * the call site. A log following discarded calls is displayed as "message (×N)", N counting them. Use the
+         * MBI_LOG_LIMIT macro, which declares the site.
+         *
+         * @param site Rate limiting state of the call site
+         * @param maxLogs Maximum number of logs per window
+         * @param periodMs Duration of a window in ms
+         * @param level Level of the message
+         * @param format Format of the message
+         * @param args Arguments of the format
+         */
+        template <typename... Args>
+        void LogLimit(MBILogSite &site, uint32_t maxLogs, uint32_t periodMs, MBILogLevel level, const MBILogFormat &format, const Args &...args)
+        {
+            const int64_t time = GetTimestamp();
+            const uint32_t repeat = site.Limit(maxLogs, (int64_t)periodMs * 1000, time);
+            if (repeat != 0)
+            {
+                MBILog log(level, format.GetId(), time, args...);
+                log.SetRepeat(repeat);
+                Post(std::move(log));
+            }
+        }
         /**
          * @brief Log a message with the level MBILogLevel::LOG_LEVEL_ERROR
          *
@@ -140,8 +694,6 @@ namespace MBIMGUI
          */
         void LogError(std::string_view msg);
 
-        // TODO : LogInfo ? LogOnce ! May be useful for debug
-
         /**
          * @brief Log a message with the level MBILogLevel::LOG_LEVEL_ERROR and display it in a popup.
          * The popup will appear even if the @ref Configure function has been used to disable automatic popup on error.
@@ -1,6 +1,8 @@
 #pragma once
+#include <chrono>
 #include <string>
 #include <map>
+#include <vector>
 
 // Include everything needed by users
 #ifndef IMGUI_DEFINE_MATH_OPERATORS
@@ -15,6 +17,7 @@
 #include "MBILogger.h"
 #include "MBIPlotChart.h"
 #include "MBIFileDialog.h"
+#include "MBIFileLoader.h"
 
 #include "IconsFontAwesome6.h"
 
@@ -56,7 +59,8 @@ namespace MBIMGUI
         MBIConfig_displayImGuiDemo = 1 << 3,  ///< Display the ImGui debug window by default (useful for debug)
         MBIConfig_displayImPlotDemo = 1 << 4, ///< Display the ImPlot debug window by default (useful for debug)
         MBIConfig_displayMenuBar = 1 << 5,    ///< Display a top menu with default options (closing, hidding/showing window, help...)
-        MBIConfig_displayLogBar = 1 << 6      ///< Display a log bar at the bottom of the main window
+        MBIConfig_displayLogBar = 1 << 6,     ///< Display a log bar at the bottom of the main window
+        MBIConfig_framePacing = 1 << 7        ///< Only render frames on input, new data or at the idle rate instead of continuously (see MBIMNG::SetFramePacing)
     };
 
     /**
@@ -88,11 +92,31 @@ namespace MBIMGUI
          */
         using MBIOpenFileHandler = void (*)(const std::string &filename);
 
+        /**
+         * @brief Callback returning the generation of a data source : the value changes each time new data are available
+         *
+         */
+        using MBIDataGenerationCb = uint64_t (*)(const void *source);
+
     private:
         /**
          * Internal types
          */
         using WindowMapPair = std::pair<MBIDockOption, MBIWindow *>; ///< Internal pair for a window and its docking location
+        using FrameClock = std::chrono::steady_clock;                 ///< Clock used for frame pacing
+
+        /**
+         * @brief Data source watched by frame pacing
+         *
+         */
+        struct DataSource
+        {
+            MBIDataGenerationCb getGeneration; ///< Function returning the generation of the source
+            const void *source;                ///< Argument of getGeneration
+            uint64_t generation;               ///< Generation of the source when the last frame was rendered
+        };
+
+        static constexpr double ANIMATION_DURATION_S = 0.5; ///< Frames keep being rendered at max FPS during this time after an input, so ImGui animations and hovering complete
 
         /**
          * Members
@@ -108,6 +132,14 @@ namespace MBIMGUI
         MBIFileDialog m_openFileDialog;         ///< File browser displayed when oppening file in File menu
         MBIOpenFileHandler m_openFileHandler;
         bool m_dndActiv;
+        std::vector<MBIFileLoader *> m_fileLoaders; ///< Background file loaders updated each frame, see AddFileLoader
+
+        std::vector<DataSource> m_dataSources; ///< Data sources waking up frame pacing, see AddDataSource
+        void *m_wakeEvent;                     ///< Event set by RequestFrame to wake up frame pacing
+        float m_maxFps;                        ///< Maximum frame rate when frame pacing is enabled
+        float m_minFps;                        ///< Frame rate when idle and frame pacing is enabled
+        FrameClock::time_point m_lastFrame;    ///< Start of the last rendered frame
+        FrameClock::time_point m_animationEnd; ///< Frames are rendered at max FPS until this time
 
         MBIConfigFlags m_confFlags; ///< Current framework flags
         MBILogger &m_logger;        ///< Logger of the application
@@ -123,6 +155,19 @@ namespace MBIMGUI
          * @param closeWindow As for ImGui::Begin, passing closeWindow displays a Close button on the upper-right corner of the window, the pointed value will be set to false when the button is pressed.
          */
         void ShowOptionWindow(bool &closeWindow);
+        /**
+         * @brief Frame pacing : wait until the next frame has to be rendered, that is an input occured, a data source changed,
+         * a frame has been requested or the idle period elapsed. Frame rate never exceeds m_maxFps.
+         *
+         */
+        void WaitNextFrame();
+        /**
+         * @brief Check if a data source changed since the last call, or if a file loader is running
+         *
+         * @return true New data to display
+         * @return false Nothing changed
+         */
+        bool DataChanged();
         /**
          * @brief Display the about window (Help-->About)
          *
@@ -186,6 +231,51 @@ namespace MBIMGUI
          */
         void EnableOpenMenu(const std::vector<std::string> &filters, MBIOpenFileHandler openFileHandler, bool enableDragAndDrop = false);
 
+        /**
+         * @brief Register a background file loader. The loader is updated at each frame, before the windows are displayed,
+         * so graphs using its columns fill in progressively. Its progress is displayed in the main menu bar while loading.
+         *
+         * @param loader A pointer to a MBIFileLoader object. Must remain valid until the application is closed.
+         */
+        void AddFileLoader(MBIFileLoader *loader);
+
+        /**
+         * @brief Set the frame rates used when frame pacing is enabled (see MBIConfig_framePacing)
+         *
+         * @param maxFps Maximum frame rate, reached while the user interacts or while live data change
+         * @param minFps Frame rate when nothing happens
+         */
+        void SetFramePacing(float maxFps, float minFps = 1.0f);
+
+        /**
+         * @brief Register a data source : with frame pacing enabled, a frame is rendered each time its generation changes
+         * (polled at most at max FPS).
+         *
+         * @param getGeneration Function returning the generation of the source
+         * @param source Argument to pass to the function. Must remain valid until the application is closed.
+         */
+        void AddDataSource(MBIDataGenerationCb getGeneration, const void *source);
+
+        /**
+         * @brief Register a circular buffer as data source, see AddDataSource
+         *
+         * @tparam T Type of the objects stored in the buffer
+         * @param buffer Buffer to watch. Must remain valid until the application is closed.
+         */
+        template <typename T>
+        void AddDataSource(const MBICircularBuffer<T> *buffer)
+        {
+            AddDataSource([](const void *source) -> uint64_t
+                          { return static_cast<const MBICircularBuffer<T> *>(source)->generation(); },
+                          buffer);
+        }
+
+        /**
+         * @brief Request a new frame. With frame pacing enabled, wakes up the UI thread. May be called from any thread.
+         *
+         */
+        void RequestFrame() noexcept;
+
         /**
          * @brief Set the small (title bar) and large (task bar) icon for the app.
          * The resourceIconId shall be defined in RC file (Windows Only).
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Unbounded lock-free queue with multiple producers and a single consumer.
+ *
+ * Producers never wait : a push is one allocation and one atomic exchange, whatever the other producers and the
+ * consumer are doing. Only one thread may pop. An object whose push is still in progress may be missed by a pop,
+ * it is then returned by a next one.
+ *
+ * @tparam T Type of the objects to store, must be default constructible and movable
+ */
+template <typename T>
+class MBIMpscQueue
+{
+public:
+    /**
+     * @brief Construct a new empty MBIMpscQueue object
+     *
+     */
+    MBIMpscQueue() : m_head(&m_stub), m_tail(&m_stub)
+    {
+    }
+
+    /**
+     * @brief Destroy the MBIMpscQueue object and the objects still queued. No producer may be pushing.
+     *
+     */
+    ~MBIMpscQueue()
+    {
+        T value;
+        while (pop(value))
+        {
+        }
+        if (m_tail != &m_stub)
+        {
+            delete m_tail;
+        }
+    }
+
+    MBIMpscQueue(const MBIMpscQueue &) = delete;
+    MBIMpscQueue &operator=(const MBIMpscQueue &) = delete;
+
+    /**
+     * @brief Add an object at the end of the queue. Can be called from any thread.
+     *
+     * @param value Object to add
+     */
+    void push(T &&value)
+    {
+        Node *const node = new Node(std::move(value));
+        Node *const prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Retrieve and remove the oldest object of the queue. Must only be called from the consumer thread.
+     *
+     * @param value Destination of the object
+     * @return true An object was retrieved
+     * @return false Queue empty
+     */
+    bool pop(T &value)
+    {
+        Node *const tail = m_tail;
+        Node *const next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+        /* The popped node becomes the new dummy tail, its object is moved out */
+        value = std::move(next->value);
+        m_tail = next;
+        if (tail != &m_stub)
+        {
+            delete tail;
+        }
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next;
+        T value;
+
+        Node() : next(nullptr) {}
+        explicit Node(T &&v) : next(nullptr), value(std::move(v)) {}
+    };
+
+    Node m_stub;                ///< Initial dummy node
+    std::atomic<Node *> m_head; ///< Last pushed node, updated by the producers
+    Node *m_tail;               ///< Dummy node before the oldest object, owned by the consumer
+};
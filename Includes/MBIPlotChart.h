@@ -1,8 +1,23 @@
 #pragma once
 
-#include <unordered_set>
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <list>
+#include <type_traits>
+#include <typeinfo>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "implot.h"
+#include "MBICircularBuffer.h"
+#include "MBISlotMap.h"
+#include "MBILabelTable.h"
+#include "MBIMpscQueue.h"
 
 /**
  * @brief Struct describing a data occurence. It's basically a value with the corresponding date.
@@ -59,6 +74,64 @@ struct DataAnnotation
     virtual const ImVec4 GetColor() const noexcept { return ImVec4(1.0f, 1.0f, 1.0f, 1.0f); };
 };
 
+/**
+ * @brief Compact annotation, 16 bytes and trivially copyable. The label is interned in MBILabelTable and the color
+ * is an index in MBIColorPalette. Use it instead of DataAnnotation for large amounts of events.
+ *
+ */
+struct CompactAnnotation
+{
+    double m_x;       ///< Time in s
+    float m_y;        ///< Data value
+    uint32_t m_infos; ///< Label id (24 lsb) and palette color index (8 msb)
+
+    /**
+     * @brief Construct a new Compact Annotation object
+     *
+     * @param x X-Axis annotation position
+     * @param y Y-Axis annotation position
+     * @param labelId Label of the annotation, see MBILabelTable::Intern
+     * @param colorIndex Color of the annotation, see MBIColorPalette::GetIndex
+     */
+    explicit CompactAnnotation(double x = 0, float y = 0, MBILabelTable::LabelId labelId = MBILabelTable::LABEL_EMPTY,
+                               MBIColorPalette::ColorIndex colorIndex = MBIColorPalette::COLOR_DEFAULT) noexcept
+        : m_x(x),
+          m_y(y),
+          m_infos((labelId & MBILabelTable::LABEL_ID_MAX) | ((uint32_t)colorIndex << MBILabelTable::LABEL_ID_BITS))
+    {
+    }
+
+    /**
+     * @brief Adapter from the polymorphic annotation : label and color are resolved once and interned.
+     *
+     * @param annotation Annotation to convert
+     */
+    explicit CompactAnnotation(const DataAnnotation &annotation)
+        : CompactAnnotation(annotation.m_x, (float)annotation.m_y, MBILabelTable::Intern(annotation.GetLabel()),
+                            MBIColorPalette::GetIndex(annotation.GetColor()))
+    {
+    }
+
+    MBILabelTable::LabelId GetLabelId() const noexcept { return m_infos & MBILabelTable::LABEL_ID_MAX; }
+    MBIColorPalette::ColorIndex GetColorIndex() const noexcept { return (MBIColorPalette::ColorIndex)(m_infos >> MBILabelTable::LABEL_ID_BITS); }
+
+    /**
+     * @brief Get the label of the annotation
+     *
+     * @return const char* Annotation
+     */
+    const char *GetLabel() const noexcept { return MBILabelTable::GetLabel(GetLabelId()); }
+
+    /**
+     * @brief Get the color of the annotation
+     *
+     * @return const ImVec4 Color of the annotation
+     */
+    const ImVec4 GetColor() const noexcept { return MBIColorPalette::GetColor(GetColorIndex()); }
+};
+static_assert(sizeof(CompactAnnotation) == 16, "CompactAnnotation shall stay 16 bytes");
+static_assert(std::is_trivially_copyable<CompactAnnotation>::value, "CompactAnnotation shall stay trivially copyable");
+
 /**
  * @brief Describe a variable displayed on the graph
  *
@@ -72,6 +145,7 @@ struct DataDescriptor
     bool bShowAnnotations; ///< Show annotations on the graph for the current variable
     bool bHidden;          ///< Data showned on the graph ?
     bool bMoved;           ///< True if the data has just been moved from a graph to another. Used to force data visibility after dnd
+    bool bOnGraph;         ///< Variable currently displayed on the graph
     ImVec4 color;          ///< Color of the curve
     std::string name;      ///< Name of the curve
     DataUnit unit;         ///< Unit of the variable. Use to determine the axis
@@ -80,6 +154,7 @@ struct DataDescriptor
     explicit DataDescriptor(bool showLabels = false) : bShowAnnotations(showLabels),
                                                        bHidden(false),
                                                        bMoved(false),
+                                                       bOnGraph(false),
                                                        color(255, 255, 255, 255),
                                                        name(""),
                                                        unit(INVALID_UNIT, ""),
@@ -89,141 +164,138 @@ struct DataDescriptor
 };
 
 /**
- * @brief Define a curve displayed on the graph
+ * @brief Statistics of a set of samples values. NaN values are ignored.
  *
  */
-template <template <typename> class Container>
-struct DataRenderInfos
+struct DataStats
 {
-public:
-    const Container<DataPoint> *const data;      ///< Curve data points
-    ImVector<DataPoint> dsData;                  ///< Down sampled curve data
-    const Container<DataAnnotation> *annotation; ///< Data annotation, if exists
+    uint64_t count; ///< Number of valid values
+    double min;     ///< Minimum value, +inf if no value
+    double max;     ///< Maximum value, -inf if no value
+    double mean;    ///< Mean value
+    double m2;      ///< Sum of the squared deviations from the mean
 
-    uint32_t dataOffset;       ///< Start display offset of data
-    uint32_t dataPeriodMs;     ///< Sampling data period in ms
-    DataDescriptor descriptor; ///< Curve descriptor
+    DataStats() noexcept : count(0), min(INFINITY), max(-INFINITY), mean(0.0), m2(0.0) {}
 
     /**
-     * @brief Construct a new DataRenderInfos object
+     * @brief Add a value (Welford's algorithm)
      *
-     * @param ptrData Pointer to the data to render.
-     * @param showLabels Show annotations on the graph.
+     * @param value Value to add, ignored if NaN
      */
-    explicit DataRenderInfos(const Container<DataPoint> *const ptrData, bool showLabels = false) : data(ptrData),
-                                                                                                   dataOffset(0),
-                                                                                                   dataPeriodMs(1),
-                                                                                                   descriptor(showLabels),
-                                                                                                   annotation(nullptr)
-
+    void Add(double value) noexcept
     {
+        if (std::isnan(value))
+            return;
+        count++;
+        const double delta = value - mean;
+        mean += delta / (double)count;
+        m2 += delta * (value - mean);
+        if (value < min)
+            min = value;
+        if (value > max)
+            max = value;
     }
 
     /**
-     * @brief Copy construct a new DataRenderInfos object
+     * @brief Merge the statistics of another set of values (Chan's parallel algorithm)
      *
-     * @param other Other instance to copy
+     * @param other Statistics to merge
      */
-    explicit DataRenderInfos(const DataRenderInfos *const other) noexcept : data(other->data),
-                                                                            descriptor(other->descriptor),
-                                                                            dataOffset(0),
-                                                                            dataPeriodMs(other->dataPeriodMs),
-                                                                            annotation(other->annotation)
+    void Merge(const DataStats &other) noexcept
     {
+        if (other.count == 0)
+            return;
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+        const double total = (double)(count + other.count);
+        const double delta = other.mean - mean;
+        mean += delta * (double)other.count / total;
+        m2 += other.m2 + delta * delta * (double)count * (double)other.count / total;
+        count += other.count;
+        if (other.min < min)
+            min = other.min;
+        if (other.max > max)
+            max = other.max;
     }
 
     /**
-     * @brief Reset the data rendering infos.
+     * @brief Get the variance of the values
      *
+     * @return double Population variance, 0 if no value
      */
-    void Clear() noexcept
+    double GetVariance() const noexcept
     {
-        dsData.clear();
-        dataOffset = 0;
+        return (count > 0) ? (m2 / (double)count) : 0.0;
     }
+};
+
+/**
+ * @brief Hit and miss counters of the down sampling cache
+ *
+ */
+struct DownSampleCacheStats
+{
+    uint64_t hits;   ///< Number of down sampling results reused from the cache
+    uint64_t misses; ///< Number of down sampling results computed
+
+    DownSampleCacheStats() noexcept : hits(0), misses(0) {}
+};
 
+/**
+ * @brief Define a curve displayed on the graph, see Sources/MBIDataRenderInfos.h
+ *
+ */
+template <template <typename> class Container>
+struct DataRenderInfos;
+
+/**
+ * @brief Group of charts sharing the same x-axis range : panning or zooming one chart of the group moves all the others.
+ * Charts of a group displaying the same data also share the computation of the displayed window of this data
+ * (see DataWindowCache), so stacking many linked charts costs little more than a single one.
+ *
+ */
+class MBIChartLinkGroup
+{
+public:
     /**
-     * @brief Apply LTTB down sampling algorithm to data and store result sampled data in dsData.
-     * Taken from https://github.com/epezent/implot/pull/389/commits/cf3e4a76bd8fea7dd067e2acd591d2365edb3c0d
-     * slightly modified by me
+     * @brief Construct a new MBIChartLinkGroup object
      *
-     * @param start Offset of the data to display
-     * @param rawSamplesCount Total size of origin data samples
-     * @param downSampleSize Down sample size
-     * @return int Size of dsData.
+     * @param xMin Initial minimum of the x-axis range
+     * @param xMax Initial maximum of the x-axis range
      */
-    int DownSampleLTTB(int start, int rawSamplesCount, int downSampleSize)
+    explicit MBIChartLinkGroup(double xMin = -10.0, double xMax = 10.0) noexcept : m_range(xMin, xMax) {}
+
+    /**
+     * @brief Set the x-axis range of all the charts of the group
+     *
+     * @param xMin Minimum of the x-axis range
+     * @param xMax Maximum of the x-axis range
+     */
+    void SetRange(double xMin, double xMax) noexcept
     {
-        // Largest Triangle Three Buckets (LTTB) Downsampling Algorithm
-        //  "Downsampling time series for visual representation" by Sveinn Steinarsson.
-        //  https://skemman.is/bitstream/1946/15343/3/SS_MSthesis.pdf
-        //  https://github.com/sveinn-steinarsson/flot-downsample
-
-        const double every = ((double)rawSamplesCount) / ((double)downSampleSize);
-        int aIndex = 0;
-        dsData.clear();
-        dsData.reserve(downSampleSize);
-
-        // fill first sample
-        dsData.push_back(GetDataAt(start, 0));
-        //   loop over samples
-        for (int i = 0; i < downSampleSize - 2; ++i)
-        {
-            int avgRangeStart = (int)(i * every) + 1;
-            int avgRangeEnd = (int)((i + 1) * every) + 1;
-            if (avgRangeEnd > downSampleSize)
-                avgRangeEnd = downSampleSize;
-
-            const int avgRangeLength = avgRangeEnd - avgRangeStart;
-            double avgX = 0.0;
-            double avgY = 0.0;
-            for (; avgRangeStart < avgRangeEnd; ++avgRangeStart)
-            {
-                DataPoint sample = GetDataAt(start, avgRangeStart);
-                if (sample.m_data != NAN)
-                {
-                    avgX += sample.m_time;
-                    avgY += sample.m_data;
-                }
-            }
-            avgX /= (double)avgRangeLength;
-            avgY /= (double)avgRangeLength;
-
-            int rangeOffs = (int)(i * every) + 1;
-            int rangeTo = (int)((i + 1) * every) + 1;
-            if (rangeTo > downSampleSize)
-                rangeTo = downSampleSize;
-            DataPoint samplePrev = GetDataAt(start, aIndex);
-            double maxArea = -1.0;
-            int nextAIndex = rangeOffs;
-            for (; rangeOffs < rangeTo; ++rangeOffs)
-            {
-                DataPoint sampleAtRangeOffs = GetDataAt(start, rangeOffs);
-                if (sampleAtRangeOffs.m_data != NAN)
-                {
-                    const double area = fabs((samplePrev.m_time - avgX) * (sampleAtRangeOffs.m_data - samplePrev.m_data) - (samplePrev.m_time - sampleAtRangeOffs.m_time) * (avgY - samplePrev.m_data)) / 2.0;
-                    if (area > maxArea)
-                    {
-                        maxArea = area;
-                        nextAIndex = rangeOffs;
-                    }
-                }
-            }
-            dsData.push_back(GetDataAt(start, nextAIndex));
-            aIndex = nextAIndex;
-        }
-        // fill last sample
-        dsData.push_back(GetDataAt(start, rawSamplesCount - 1));
-        return downSampleSize;
+        m_range.Min = xMin;
+        m_range.Max = xMax;
     }
 
-private:
-    inline const DataPoint &GetDataAt(int offset, int idx) const
+    /**
+     * @brief Get the shared x-axis range, updated by the charts of the group
+     *
+     * @return ImPlotRange& x-axis range
+     */
+    ImPlotRange &GetRange() noexcept
     {
-        return (*data)[offset + idx];
+        return m_range;
     }
+
+private:
+    ImPlotRange m_range; ///< Shared x-axis range
 };
 
+class MBICaptureFile;
+
 /**
  * @brief Generic plot chart with time as x-axis, multiple variables visualization, LTTB downsampling,
  * markers and 3 y-axis units available.
@@ -235,6 +307,7 @@ public:
     using VarId = uint32_t;                    ///< Variable unique identifier. Used as a handle for displayed variables.
     using DataContainer = ImVector<DataPoint>; ///< Displayed variable data points.
     using AnnotContainer = ImVector<DataAnnotation>;
+    using CompactAnnotContainer = ImVector<CompactAnnotation>;
     using UnitId = DataDescriptor::UnitId; ///< Variable unit unique identifier. Unit defines the y-axis on which the variable shall be drawn. Multiples variables sharing the same unit are drawn on the same axis.
     using DataUnit = DataDescriptor::DataUnit;
     using DataDescriptorHandle = const void *const;
@@ -345,6 +418,16 @@ public:
      */
     VarId CreateVariable(const DataContainer *const dataPtr, uint32_t period = 0);
 
+    /**
+     * @brief Create a variable object from a channel of a capture file and add it to the plot.
+     * Name and period of the variable are taken from the file. Samples are read from the file only when displayed.
+     *
+     * @param file Capture file, must stay open while the variable is displayed
+     * @param channel Channel index, in [0;file.GetChannelCount()[
+     * @return VarId Variable identifier to be used for other functions calls.
+     */
+    VarId CreateVariable(const MBICaptureFile &file, size_t channel);
+
     /**
      * @brief Remove the specified variable from the plot
      *
@@ -391,6 +474,7 @@ public:
 
     /**
      * @brief Get the Data Descriptor Handle object for the given variable. This method is useful when moving a variable to another plot.
+     * @warning The handle is invalidated when a new variable is created on this plot.
      *
      * @param dataId Identifier of the variable
      * @return DataDescriptorHandle Data Descriptor Handle for the variable
@@ -462,6 +546,14 @@ public:
      */
     virtual void AddDataAnnotations(const VarId &dataId, const AnnotContainer *const dataAnnotationPtr);
 
+    /**
+     * @brief Add compact annotations for the variable. Replaces annotations previously added.
+     *
+     * @param dataId Identifier of the variable
+     * @param dataAnnotationPtr Annotations to add
+     */
+    virtual void AddDataAnnotations(const VarId &dataId, const CompactAnnotContainer *const dataAnnotationPtr);
+
     /**
      * @brief Enable of disable the annotations on the plot for the given variable
      *
@@ -471,6 +563,14 @@ public:
      */
     void ToggleVarAnnotation(const VarId &dataId, bool activ);
 
+    /**
+     * @brief Set the minimum distance between two annotations labels. Closer annotations are grouped
+     * and drawn as a single "N events" badge.
+     *
+     * @param pixels Minimum distance in pixels. Set to zero to draw every annotation.
+     */
+    void SetAnnotationSpacing(float pixels) noexcept;
+
     /***********************************************************
      *
      *  Axis
@@ -522,6 +622,131 @@ public:
      */
     bool DataDownSampled() const noexcept;
 
+    /**
+     * @brief Get the down sampling cache counters of the graph, summed over all its variables.
+     * Caches are shared with the other graphs displaying the same data, so their hits and misses are included.
+     * Useful to tune the down sampling size.
+     *
+     * @return DownSampleCacheStats Cache hits and misses
+     */
+    virtual DownSampleCacheStats GetDownSamplingCacheStats() const noexcept;
+
+    /**
+     * @brief Declare samples of a variable modified in place (not only appended). The down sampled views, statistics
+     * and gaps of the data are recomputed, for all the graphs displaying it.
+     *
+     * @param dataId Identifier of the variable
+     */
+    virtual void SetVariableModified(const VarId &dataId);
+
+    /***********************************************************
+     *
+     *  Statistics
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Get the statistics of a variable values : count, min, max, mean and variance.
+     * Statistics are maintained incrementally (only samples appended since last call are read) and shared by all
+     * graphs displaying the same data, so calling it each frame (e.g. for a status widget) is cheap.
+     *
+     * @param dataId Identifier of the variable
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return DataStats Statistics of the variable values, NaN excluded
+     */
+    virtual DataStats GetVariableStats(const VarId &dataId, bool visibleOnly = false);
+
+    /**
+     * @brief Get an approximate quantile of a variable values (e.g. 0.5 for the median)
+     *
+     * @param dataId Identifier of the variable
+     * @param q Quantile, in [0;1]
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return double Quantile, NaN if the variable has no valid value
+     */
+    virtual double GetVariableQuantile(const VarId &dataId, double q, bool visibleOnly = false);
+
+    /**
+     * @brief Fit each y-axis to the values displayed on the graph, every frame.
+     * Limits are computed from the incremental statistics, without scanning the data.
+     *
+     * @param autoFit Enable or disable the automatic fit
+     */
+    void SetYAxesAutoFit(bool autoFit) noexcept;
+
+    /***********************************************************
+     *
+     *  Gaps
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Configure the detection of missing samples for periodic data. NaN samples are always considered as gaps.
+     * Curves are drawn as separated lines on each side of a gap.
+     *
+     * @param periods Time hole, in number of data periods, above which samples are considered missing. Set to zero to disable.
+     */
+    void SetGapDetection(float periods) noexcept;
+
+    /***********************************************************
+     *
+     *  Link
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Link the x-axis of the chart to a group of charts. Realtime charts follow the group range while paused.
+     *
+     * @param group Group to join, must remain valid while linked. nullptr to unlink the chart.
+     */
+    void SetLinkGroup(MBIChartLinkGroup *group) noexcept;
+
+    /***********************************************************
+     *
+     *  Commands from other threads
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Create a variable from any thread. The variable is created and added to the plot at the start of the next Display.
+     * Never blocks : the command is posted to a lock-free queue.
+     *
+     * @param dataPtr Data of the variable
+     * @param period Period of the data in ms. Set to zero for non periodic data
+     * @param name Name of the variable, empty to keep the default name
+     * @return VarId Variable identifier, usable immediately in other Post calls
+     */
+    VarId PostCreateVariable(const DataContainer *const dataPtr, uint32_t period = 0, std::string_view name = "");
+
+    /**
+     * @brief Add a variable to the plot from any thread, at the start of the next Display
+     *
+     * @param dataId Identifier of the variable
+     */
+    void PostAddVariable(const VarId &dataId);
+
+    /**
+     * @brief Remove a variable from the plot from any thread, at the start of the next Display
+     *
+     * @param dataId Identifier of the variable
+     */
+    void PostRemoveVariable(const VarId &dataId);
+
+    /**
+     * @brief Set the name of a variable from any thread, at the start of the next Display
+     *
+     * @param dataId Identifier of the variable
+     * @param name Name of the variable
+     */
+    void PostVarName(const VarId &dataId, std::string_view name);
+
+    /**
+     * @brief Add a marker from any thread, at the start of the next Display
+     *
+     * @param marker Marker to add
+     */
+    void PostAddMarker(const Marker &marker);
+
     /***********************************************************
      *
      *  Drag and Drop
@@ -565,24 +790,92 @@ protected:
 
     bool m_activDownSampling;  ///< Is downsampling activated
     size_t m_downSamplingSize; ///< Downsampling size
+    float m_gapThreshold;      ///< Time hole, in number of periods, detected as missing samples
+    float m_annotSpacing;      ///< Minimum distance between annotations labels, in pixels
+    bool m_yAutoFit;           ///< Fit y-axes to the displayed values each frame
+    MBIChartLinkGroup *m_linkGroup; ///< Group sharing the x-axis range, nullptr if not linked
 
     ImPlotScale m_xAxisScale;    ///< Type of X-axis
     ImPlotRange m_xAxisRange;    ///< X-axis range
     ImPlotRange m_yAxesRange[3]; ///< Y-axis range
 
+    double m_xOrigin;            ///< Start of the x-axis range this frame, origin of the curves axis (see SetupCurvesAxis)
+    ImPlotRange m_xStart;        ///< X-axis range at the start of this frame
+    ImPlotRange m_xCurvesRange;  ///< Range of the curves axis, linked to ImPlot
+    ImPlotRange m_xCurvesStart;  ///< Range of the curves axis at the start of this frame
+
+    bool m_axesDirty;             ///< Variables or units changed, axes assignment must be rebuilt
+    int m_axesCount;              ///< Number of y-axes used
+    UnitId m_axesUnit[3];         ///< Unit of each y-axis
+    std::string m_axesLabel[3];   ///< Label of each y-axis
+
     MBIDndCb m_callback;   ///< Pointer on the function to be called when data are dropped
     void *m_callbackArg;   ///< Argument to pass to the function
     std::string m_dndType; ///< Type of the data to accept
 
-    std::unordered_set<VarId> m_vargaph; ///< Id of the variables currently displayed on the graph
-    std::list<Marker> m_markers;         ///< List of the markers to be displayed on the graph
+    size_t m_varOnGraph;         ///< Number of variables currently displayed on the graph
+    std::list<Marker> m_markers; ///< List of the markers to be displayed on the graph
+
+    /**
+     * @brief Variables management command posted by another thread
+     *
+     */
+    struct ChartCommand
+    {
+        enum Type
+        {
+            CMD_CREATE_VARIABLE, ///< Create and add the variable id with data and period
+            CMD_ADD_VARIABLE,    ///< Add the variable id
+            CMD_REMOVE_VARIABLE, ///< Remove the variable id
+            CMD_VAR_NAME,        ///< Set the name of the variable id
+            CMD_ADD_MARKER       ///< Add the marker
+        };
+
+        Type type;                      ///< Command to apply
+        VarId id;                       ///< Variable concerned
+        const void *data;               ///< Data container of the variable to create
+        const std::type_info *dataType; ///< Type of data, checked against the DataContainer of the chart applying the command
+        uint32_t period;                ///< Period of the variable to create
+        std::string name;               ///< Name of the variable
+        Marker marker;                  ///< Marker to add
+
+        ChartCommand() noexcept : type(CMD_ADD_VARIABLE), id(0), data(nullptr), dataType(&typeid(void)), period(0) {}
+
+        /**
+         * @brief Get the data container of the variable to create
+         *
+         * @tparam Container Data container type of the chart applying the command
+         * @return const Container* Data container, nullptr if it was posted with another container type
+         */
+        template <typename Container>
+        const Container *GetData() const noexcept
+        {
+            return (*dataType == typeid(Container)) ? static_cast<const Container *>(data) : nullptr;
+        }
+    };
+
+    MBIMpscQueue<ChartCommand> m_commands; ///< Commands posted by other threads, applied by Display
 
     static VarId MakeUUID()
     {
-        static VarId cnt = 0;
+        /* Atomic : identifiers are also reserved by the Post functions, from any thread */
+        static std::atomic<VarId> cnt(0);
         return ++cnt;
     }
 
+    /**
+     * @brief Apply the commands posted by other threads. Called at the start of Display.
+     *
+     */
+    void ProcessCommands();
+
+    /**
+     * @brief Apply a command posted by another thread
+     *
+     * @param command Command to apply
+     */
+    virtual void ApplyCommand(ChartCommand &command);
+
     /**
      * @brief Display the markers for the given axis
      *
@@ -590,16 +883,59 @@ protected:
      */
     void DisplayMarkers(UnitId unit);
 
+    /**
+     * @brief Setup the hidden x-axis on which the curves are plotted : the x-axis shifted by the start of its range,
+     * m_xOrigin. The curves are then sent to ImPlot as float32 points relative to it (see DataRenderInfos::ToRelativeWindow),
+     * half the size of the time and value doubles, without precision loss on large dates. Both axes receive the same
+     * mouse inputs. Must be called between ImPlot::BeginPlot and the first plotted item.
+     *
+     * @param range X-axis range this frame, linked to the x-axis. Updated when only the curves axis has been fitted.
+     * @param forced The x-axis range is forced this frame
+     */
+    void SetupCurvesAxis(ImPlotRange &range, bool forced);
+
+    /**
+     * @brief Display the annotations of a variable in the current x-axis range.
+     * Annotations closer than m_annotSpacing pixels are drawn as a single badge.
+     * Must be called after ImPlot::SetAxes(ImAxis_X1, ...) for the variable.
+     *
+     * @param render Data renderer of the variable
+     * @param annotations Annotations of the variable (DataAnnotation or CompactAnnotation container)
+     */
+    template <typename Render, typename Annotations>
+    void DisplayAnnotations(Render &render, const Annotations &annotations);
+
+    /**
+     * @brief Rebuild the units to y-axes assignment if variables or units changed since last call, then setup the y-axes.
+     * Must be called between ImPlot::BeginPlot and the first plotted item.
+     *
+     * @param renders Data renderers of the graph
+     */
+    template <typename Renders>
+    void SetupYAxes(Renders &renders);
+
+    /**
+     * @brief Get the descriptor of a variable
+     *
+     * @param dataId Identifier of the variable
+     * @return const DataDescriptor* Descriptor of the variable, nullptr if the variable is unknown
+     */
+    virtual const DataDescriptor *FindDataDescriptor(const VarId &dataId) const noexcept;
+
+    const DataDescriptor &GetDataDescriptor(const VarId &dataId) const;
+    DataDescriptor &GetDataDescriptor(const VarId &dataId);
+
 private:
     using DataRender = DataRenderInfos<ImVector>;
 
-    std::map<uint32_t, DataRender *> m_varData; ///< Map containing the data to be displayed on the graphs
+    MBISlotMap<DataRender> m_varData; ///< Data to be displayed on the graphs, stored by value and indexed by VarId
 
     void MBIPlotChart::ComputeDataWindow(DataRender &dataRenderInfos, size_t &dataSize, int32_t &dataOffset);
 
+    VarId InsertVariable(VarId id, const DataContainer *const dataPtr, uint32_t period);
+
+    ImAxis AssignYAxis(const DataUnit &unit);
+
     DataRender &GetDataRenderInfos(const VarId &dataId);
     const DataRender &GetDataRenderInfos(const VarId &dataId) const;
-
-    virtual const DataDescriptor &GetDataDescriptor(const VarId &dataId) const;
-    virtual DataDescriptor &GetDataDescriptor(const VarId &dataId);
 };
\ No newline at end of file
@@ -1,7 +1,5 @@
 #pragma once
 
-#include <unordered_set>
-#include <map>
 #include "MBISyncCircularBuffer.h"
 #include "MBIPlotChart.h"
 
@@ -15,6 +13,7 @@ class MBIRealtimePlotChart : public MBIPlotChart
 public:
     using DataContainer = MBISyncCircularBuffer<DataPoint>;
     using AnnotContainer = MBISyncCircularBuffer<DataAnnotation>;
+    using CompactAnnotContainer = MBISyncCircularBuffer<CompactAnnotation>;
     using DataRender = DataRenderInfos<MBISyncCircularBuffer>;
 
     /***********************************************************
@@ -50,6 +49,17 @@ public:
      */
     VarId CreateVariable(const DataContainer *const dataPtr, uint32_t period = 0);
 
+    /**
+     * @brief Create a variable from any thread, typically an acquisition thread discovering a new channel.
+     * The variable is created and added to the plot at the start of the next Display. Never blocks.
+     *
+     * @param dataPtr Data of the variable
+     * @param period Period of the data in ms. Set to zero for non periodic data
+     * @param name Name of the variable, empty to keep the default name
+     * @return VarId Variable identifier, usable immediately in other Post calls
+     */
+    VarId PostCreateVariable(const DataContainer *const dataPtr, uint32_t period = 0, std::string_view name = "");
+
     /**
      * @brief Set the Data Descriptor Handle for the given variable. This method is useful when moving a variable from another plot.
      *
@@ -60,12 +70,47 @@ public:
 
     /**
      * @brief Get the Data Descriptor Handle object for the given variable. This method is useful when moving a variable to another plot.
+     * @warning The handle is invalidated when a new variable is created on this plot.
      *
      * @param dataId Identifier of the variable
      * @return DataDescriptorHandle Data Descriptor Handle for the variable
      */
     DataDescriptorHandle GetDataDescriptorHandle(const VarId &dataId) const override;
 
+    /**
+     * @brief Get the down sampling cache counters of the graph, summed over all its variables.
+     *
+     * @return DownSampleCacheStats Cache hits and misses
+     */
+    DownSampleCacheStats GetDownSamplingCacheStats() const noexcept override;
+
+    /**
+     * @brief Declare samples of a variable modified in place. Not needed for modifications done through the buffer
+     * methods, which update its generation.
+     *
+     * @param dataId Identifier of the variable
+     */
+    void SetVariableModified(const VarId &dataId) override;
+
+    /**
+     * @brief Get the statistics of a variable values. Samples evicted from the buffer are not considered.
+     *
+     * @param dataId Identifier of the variable
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return DataStats Statistics of the variable values, NaN excluded
+     */
+    DataStats GetVariableStats(const VarId &dataId, bool visibleOnly = false) override;
+
+    /**
+     * @brief Get an approximate quantile of a variable values. Samples evicted from the buffer are not considered.
+     *
+     * @param dataId Identifier of the variable
+     * @param q Quantile, in [0;1]
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return double Quantile, NaN if the variable has no valid value
+     */
+    double GetVariableQuantile(const VarId &dataId, double q, bool visibleOnly = false) override;
+
     /***********************************************************
      *
      *  Main
@@ -107,33 +152,28 @@ public:
      */
     void AddDataAnnotations(const VarId &dataId, const AnnotContainer *const dataAnnotationPtr);
 
+    /**
+     * @brief Add compact annotations for the variable. Replaces annotations previously added.
+     *
+     * @param dataId Identifier of the variable
+     * @param dataAnnotationPtr Annotations to add
+     */
+    void AddDataAnnotations(const VarId &dataId, const CompactAnnotContainer *const dataAnnotationPtr);
+
 private:
-    std::map<uint32_t, DataRender *> m_varData; ///< Map containing the data to be displayed on the graphs
+    MBISlotMap<DataRender> m_varData; ///< Data to be displayed on the graphs, stored by value and indexed by VarId
 
     bool m_pause;    ///< Pause state for the graphs
     float m_history; ///< x-axis size (time history for data)
 
-    DataDescriptor &GetDataDescriptor(const VarId &dataId) override;
-    const DataDescriptor &GetDataDescriptor(const VarId &dataId) const override;
+    const DataDescriptor *FindDataDescriptor(const VarId &dataId) const noexcept override;
 
     DataRender &GetDataRenderInfos(const VarId &dataId);
     const DataRender &GetDataRenderInfos(const VarId &dataId) const;
 
     void ComputeDataWindow(DataRender &dataRenderInfos, size_t &dataSize, int32_t &dataOffset);
 
-    /**
-     * @brief Data getter for graph plotting : converts DataRenderInfos into implot curve.
-     * @warning This routine is called every frame, for each points of the curve. So this routine must be as short as possible !
-     *
-     * @param idx Index of current point
-     * @param user_data Pointer on data infos
-     * @return ImPlotPoint Point to plot
-     */
-    static ImPlotPoint DataGetter(int idx, void *user_data)
-    {
-        const MBIRealtimePlotChart::DataRender *const comdata = static_cast<MBIRealtimePlotChart::DataRender *>(user_data);
-        /* Get point depending on current display offset and data range present on plot */
-        const DataPoint &point = (*(comdata->data))[idx + comdata->dataOffset];
-        return ImPlotPoint(point.m_time, point.m_data);
-    }
+    VarId InsertVariable(VarId id, const DataContainer *const dataPtr, uint32_t period);
+
+    void ApplyCommand(ChartCommand &command) override;
 };
\ No newline at end of file
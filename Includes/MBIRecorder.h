@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "MBIPlotChart.h"
+#include "MBISyncCircularBuffer.h"
+
+/**
+ * @brief Session recorder streaming realtime channels to disk.
+ *
+ * Each recorded channel is a MBISyncCircularBuffer fed by its producer. A background thread periodically copies
+ * the samples pushed since its last visit and appends them to the recording file. The producer is never blocked
+ * longer than the copy of the new samples (read lock of the buffer) and the UI thread is never involved.
+ * Samples overwritten in a buffer before the recorder could copy them are counted as dropped : increase the
+ * buffer capacity or decrease the drain period if it happens.
+ *
+ * File format (little endian, append-only) :
+ *
+ *      FileHeader      64 bytes
+ *                          char     magic[8]       "MBIREC01"
+ *                          uint32_t version        FORMAT_VERSION
+ *                          uint32_t channelCount   Number of channels
+ *                          uint8_t  reserved[48]   Zero
+ *      ChannelHeader   64 bytes per channel
+ *                          char     name[40]       Channel name, null terminated
+ *                          uint32_t periodMs       Sampling period in ms, 0 for non periodic data
+ *                          uint8_t  reserved[20]   Zero
+ *      Chunks          Until the end of the file, each chunk being
+ *                          ChunkHeader             32 bytes
+ *                              uint32_t magic      CHUNK_MAGIC
+ *                              uint32_t channel    Index of the channel
+ *                              uint32_t count      Number of samples in the chunk
+ *                              uint32_t dropped    Number of samples dropped just before this chunk
+ *                              double   tMin       Time of the first sample
+ *                              double   tMax       Time of the last sample
+ *                          count DataPoint {double time; double value}
+ *
+ * Chunk headers form the time index of the recording : a reader seeks to a time by walking the chunk headers only.
+ * A recording interrupted by a crash is readable up to its last complete chunk.
+ *
+ */
+class MBIRecorder
+{
+public:
+    using Channel = MBISyncCircularBuffer<DataPoint>; ///< Realtime channel recorded
+
+    static constexpr char MAGIC[8] = {'M', 'B', 'I', 'R', 'E', 'C', '0', '1'}; ///< File signature
+    static constexpr uint32_t FORMAT_VERSION = 1;                               ///< Current format version
+    static constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;                         ///< "CHNK", start of each chunk
+    static constexpr size_t CHANNEL_NAME_SIZE = 40;                             ///< Channel name maximum length, including null char
+    static constexpr size_t MAX_CHUNK_SAMPLES = 64 * 1024;                      ///< Maximum number of samples in a chunk
+
+    /**
+     * @brief Header of the file
+     *
+     */
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t channelCount;
+        uint8_t reserved[48];
+    };
+    static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+
+    /**
+     * @brief Header of a channel
+     *
+     */
+    struct ChannelHeader
+    {
+        char name[CHANNEL_NAME_SIZE];
+        uint32_t periodMs;
+        uint8_t reserved[20];
+    };
+    static_assert(sizeof(ChannelHeader) == 64, "ChannelHeader layout is part of the file format");
+
+    /**
+     * @brief Header of a chunk of samples
+     *
+     */
+    struct ChunkHeader
+    {
+        uint32_t magic;
+        uint32_t channel;
+        uint32_t count;
+        uint32_t dropped;
+        double tMin;
+        double tMax;
+    };
+    static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader layout is part of the file format");
+
+    /***********************************************************
+     *
+     *  CTOR & DTOR
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Construct a new idle MBIRecorder object
+     *
+     */
+    MBIRecorder() noexcept;
+
+    /**
+     * @brief Destroy the MBIRecorder object, stopping the recording
+     *
+     */
+    ~MBIRecorder();
+
+    MBIRecorder(const MBIRecorder &) = delete;
+    MBIRecorder &operator=(const MBIRecorder &) = delete;
+
+    /***********************************************************
+     *
+     *  Recording
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Add a channel to record. Channels can only be added while not recording.
+     * Only samples pushed after Start are recorded.
+     *
+     * @param channel Buffer fed by the producer. Must remain valid while recording.
+     * @param name Name of the channel
+     * @param periodMs Sampling period in ms, 0 for non periodic data
+     * @return size_t Index of the channel in the recording, SIZE_MAX if recording is in progress
+     */
+    size_t AddChannel(const Channel *channel, std::string_view name, uint32_t periodMs = 0);
+
+    /**
+     * @brief Create the recording file and start recording the channels.
+     *
+     * @param path Path of the file to create (overwritten if it exists)
+     * @param drainPeriodMs Period at which new samples are copied from the channels. Each channel must be able to hold
+     *                      the samples pushed during this period, otherwise samples are dropped.
+     * @param syncPeriodMs Period at which written data are flushed to the disk
+     * @return true Recording started
+     * @return false File can't be created. Error is logged.
+     */
+    bool Start(const std::filesystem::path &path, uint32_t drainPeriodMs = 100, uint32_t syncPeriodMs = 2000);
+
+    /**
+     * @brief Record the last samples, flush and close the file.
+     *
+     */
+    void Stop() noexcept;
+
+    /**
+     * @brief Is a recording in progress
+     *
+     * @return true Recording
+     * @return false Not recording
+     */
+    bool IsRecording() const noexcept;
+
+    /***********************************************************
+     *
+     *  Statistics
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Get the number of channels
+     *
+     * @return size_t Number of channels
+     */
+    size_t GetChannelCount() const noexcept;
+
+    /**
+     * @brief Get the number of samples of a channel written since Start
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return uint64_t Number of samples recorded
+     */
+    uint64_t GetRecordedCount(size_t channel) const;
+
+    /**
+     * @brief Get the number of samples of a channel overwritten in its buffer before being recorded
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return uint64_t Number of samples dropped
+     */
+    uint64_t GetDroppedCount(size_t channel) const;
+
+    /**
+     * @brief Get the size of the recording file
+     *
+     * @return uint64_t Number of bytes written since Start
+     */
+    uint64_t GetBytesWritten() const noexcept;
+
+private:
+    /**
+     * @brief Recorded channel and its recording state
+     *
+     */
+    struct RecordedChannel
+    {
+        const Channel *buffer;          ///< Buffer fed by the producer
+        std::string name;               ///< Name of the channel
+        uint32_t periodMs;              ///< Sampling period in ms
+        uint64_t next;                  ///< Stable index (see MBICircularBuffer::pushed) of the next sample to record
+        std::atomic<uint64_t> recorded; ///< Number of samples recorded
+        std::atomic<uint64_t> dropped;  ///< Number of samples dropped
+    };
+
+    std::vector<std::unique_ptr<RecordedChannel>> m_channels; ///< Recorded channels
+    std::filesystem::path m_path;                             ///< Recording file
+    void *m_file;                                             ///< Recording file handle
+    uint32_t m_drainPeriodMs;                                 ///< Period of the samples copy
+    uint32_t m_syncPeriodMs;                                  ///< Period of the flush to disk
+    std::atomic<uint64_t> m_written;                          ///< Bytes written
+    std::atomic<bool> m_recording;                            ///< Recording in progress
+    bool m_stop;                                              ///< Stop requested, protected by m_mutex
+    std::mutex m_mutex;                                       ///< Protects m_stop
+    std::condition_variable m_cv;                             ///< Wakes up the recording thread on stop
+    std::thread m_thread;                                     ///< Recording thread
+
+    /**
+     * @brief Recording thread entry point
+     *
+     */
+    void RecordThread();
+
+    /**
+     * @brief Copy the new samples of each channel and append them to the file
+     *
+     * @param samples Scratch vector, kept between calls to avoid allocations
+     * @return true Samples written
+     * @return false Write error. Error is logged.
+     */
+    bool Drain(std::vector<DataPoint> &samples);
+
+    /**
+     * @brief Append data to the file
+     *
+     * @return true Data written
+     * @return false Write error
+     */
+    bool Write(const void *data, size_t size) noexcept;
+};
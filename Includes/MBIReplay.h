@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "MBIRecorder.h"
+
+/**
+ * @brief Replay engine playing a recording (see MBIRecorder) back into realtime channels, as if the data were live.
+ *
+ * The recording is mapped in memory and indexed by its chunk headers when opened. A background thread pushes
+ * the samples into the bound MBISyncCircularBuffer channels following a simulated clock, running at a configurable
+ * speed. Pass GetTime() to MBIRealtimePlotChart::Display so the charts follow the simulated clock.
+ *
+ * As the samples pushed only depend on the recording, the seek position and the speed, a replay is also a
+ * deterministic load for the realtime pipeline : GetThroughput gives the number of samples pushed per second.
+ *
+ */
+class MBIReplay
+{
+public:
+    using Channel = MBIRecorder::Channel; ///< Realtime channel fed by the replay
+
+    static constexpr double MIN_SPEED = 0.1;    ///< Slowest replay speed
+    static constexpr double MAX_SPEED = 1000.0; ///< Fastest replay speed
+    static constexpr uint32_t TICK_MS = 1;      ///< Period of the replay thread
+
+    /***********************************************************
+     *
+     *  CTOR & DTOR
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Construct a new closed MBIReplay object
+     *
+     */
+    MBIReplay() noexcept;
+
+    /**
+     * @brief Destroy the MBIReplay object, stopping the replay and unmapping the recording
+     *
+     */
+    ~MBIReplay();
+
+    MBIReplay(const MBIReplay &) = delete;
+    MBIReplay &operator=(const MBIReplay &) = delete;
+
+    /***********************************************************
+     *
+     *  Recording
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Map and index a recording. The replay is paused at the start of the recording.
+     * A recording interrupted by a crash is replayed up to its last complete chunk.
+     *
+     * @param path Path of the recording
+     * @return true Recording ready to be replayed
+     * @return false The file can't be opened or isn't a valid recording. Error is logged.
+     */
+    bool Open(const std::filesystem::path &path);
+
+    /**
+     * @brief Stop the replay and unmap the recording
+     *
+     */
+    void Close() noexcept;
+
+    /**
+     * @brief Get the number of channels of the recording
+     *
+     * @return size_t Number of channels
+     */
+    size_t GetChannelCount() const noexcept;
+
+    /**
+     * @brief Get the name of a channel
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return std::string_view Name of the channel
+     */
+    std::string_view GetChannelName(size_t channel) const;
+
+    /**
+     * @brief Get the sampling period of a channel
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @return uint32_t Period in ms, 0 for non periodic data
+     */
+    uint32_t GetChannelPeriod(size_t channel) const;
+
+    /**
+     * @brief Set the buffer fed with the samples of a channel. Channels without buffer are not replayed.
+     *
+     * @param channel Channel index, in [0;GetChannelCount()[
+     * @param buffer Buffer to feed, must remain valid until Close. nullptr to stop replaying the channel.
+     */
+    void SetChannel(size_t channel, Channel *buffer);
+
+    /**
+     * @brief Get the time of the first recorded sample
+     *
+     * @return double Time in s
+     */
+    double GetStartTime() const noexcept;
+
+    /**
+     * @brief Get the time of the last recorded sample
+     *
+     * @return double Time in s
+     */
+    double GetEndTime() const noexcept;
+
+    /***********************************************************
+     *
+     *  Playback
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Start or resume the replay
+     *
+     */
+    void Play();
+
+    /**
+     * @brief Pause the replay. The simulated clock is frozen.
+     *
+     */
+    void Pause();
+
+    /**
+     * @brief Is the replay running
+     *
+     * @return true Replay running
+     * @return false Replay paused or finished
+     */
+    bool IsPlaying() const noexcept;
+
+    /**
+     * @brief Move the simulated clock. Samples are then replayed from the first sample at or after this time.
+     *
+     * @param timeS Time in s, clamped to [GetStartTime();GetEndTime()]
+     * @param resetChannels If true, the bound buffers are emptied so charts don't mix samples from before the seek
+     */
+    void Seek(double timeS, bool resetChannels = true);
+
+    /**
+     * @brief Set the replay speed
+     *
+     * @param speed Simulated seconds per real second, clamped to [MIN_SPEED;MAX_SPEED]
+     */
+    void SetSpeed(double speed);
+
+    /**
+     * @brief Get the replay speed
+     *
+     * @return double Simulated seconds per real second
+     */
+    double GetSpeed() const noexcept;
+
+    /**
+     * @brief Get the simulated clock. Pass it to MBIRealtimePlotChart::Display.
+     *
+     * @return double Simulated time in s
+     */
+    double GetTime() const;
+
+    /***********************************************************
+     *
+     *  Statistics
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Get the number of samples pushed into the channels since Open
+     *
+     * @return uint64_t Number of samples pushed
+     */
+    uint64_t GetPushedCount() const noexcept;
+
+    /**
+     * @brief Get the achieved throughput, measured on the last second of replay
+     *
+     * @return double Samples pushed per second
+     */
+    double GetThroughput() const noexcept;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Chunk of samples in the mapped recording
+     *
+     */
+    struct Chunk
+    {
+        const DataPoint *samples; ///< Samples of the chunk
+        uint32_t count;           ///< Number of samples
+        double tMax;              ///< Time of the last sample
+    };
+
+    /**
+     * @brief Replayed channel
+     *
+     */
+    struct ReplayedChannel
+    {
+        const MBIRecorder::ChannelHeader *header; ///< Header in the mapped recording
+        std::vector<Chunk> chunks;                ///< Chunks of the channel, in time order
+        Channel *buffer;                          ///< Buffer fed with the samples
+        size_t chunk;                             ///< Chunk of the next sample to replay
+        uint32_t sample;                          ///< Index in the chunk of the next sample to replay
+    };
+
+    /**
+     * @brief Samples of a chunk to push to a channel buffer
+     *
+     */
+    struct Span
+    {
+        Channel *buffer;          ///< Buffer fed with the samples
+        const DataPoint *samples; ///< First sample, in the mapped recording
+        uint32_t count;           ///< Number of samples
+    };
+
+    void *m_file;                             ///< File handle
+    void *m_mapping;                          ///< File mapping handle
+    const uint8_t *m_view;                    ///< Mapped recording
+    std::vector<ReplayedChannel> m_channels;  ///< Channels of the recording
+    double m_startTime;                       ///< Time of the first sample
+    double m_endTime;                         ///< Time of the last sample
+
+    mutable std::mutex m_mutex;               ///< Protects the playback state and the channels cursors
+    std::mutex m_pushMutex;                   ///< Serializes the pushes of the replay thread with Seek, locked before m_mutex
+    std::condition_variable m_cv;             ///< Wakes up the replay thread
+    bool m_playing;                           ///< Replay running
+    bool m_stop;                              ///< Replay thread stop request
+    double m_speed;                           ///< Replay speed
+    double m_baseTime;                        ///< Simulated time at m_baseWall
+    clock::time_point m_baseWall;             ///< Real time at which the simulated clock was m_baseTime
+    std::atomic<uint64_t> m_pushed;           ///< Samples pushed since Open
+    std::atomic<double> m_throughput;         ///< Samples pushed per second on the last measure window
+    std::thread m_thread;                     ///< Replay thread
+    std::vector<Span> m_spans;                ///< Samples to push on the current tick, replay thread only
+
+    /**
+     * @brief Replay thread entry point
+     *
+     */
+    void ReplayThread();
+
+    /**
+     * @brief Get the simulated clock. m_mutex must be locked.
+     *
+     */
+    double GetTimeUnlocked(clock::time_point now) const noexcept;
+
+    /**
+     * @brief Advance the cursor of a channel up to a simulated time, adding the samples to push to m_spans. m_mutex must be locked.
+     *
+     * @return uint64_t Number of samples to push
+     */
+    uint64_t CollectUntil(ReplayedChannel &channel, double timeS);
+
+    bool Fail(const std::filesystem::path &path, std::string_view reason);
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Dense associative container for small integer handles (like MBIPlotChart::VarId).
+ * Values are stored by value in a contiguous array, so iterating over all of them is cache friendly.
+ * A sparse array maps each handle to its slot in the dense array, giving O(1) lookups.
+ * Handles remain valid as long as they are not erased, even if other values move in the dense array.
+ *
+ * @warning Pointers and references to values are invalidated by insert and erase.
+ *
+ * @tparam T Type of the objects to store
+ */
+template <typename T>
+class MBISlotMap
+{
+public:
+    using Handle = uint32_t; ///< Handle of a stored object
+
+    /**
+     * @brief Construct a new empty MBISlotMap object
+     *
+     */
+    MBISlotMap() = default;
+
+    /**
+     * @brief Insert or replace the object identified by handle
+     *
+     * @param handle Handle of the object
+     * @param value Object to store
+     * @return T& Reference on the stored object
+     */
+    T &insert(Handle handle, T &&value)
+    {
+        if (handle >= m_sparse.size())
+        {
+            m_sparse.resize((size_t)handle + 1, INVALID_SLOT);
+        }
+        const uint32_t slot = m_sparse[handle];
+        if (slot != INVALID_SLOT)
+        {
+            m_dense[slot] = std::move(value);
+            return m_dense[slot];
+        }
+        m_sparse[handle] = (uint32_t)m_dense.size();
+        m_handles.push_back(handle);
+        m_dense.push_back(std::move(value));
+        return m_dense.back();
+    }
+
+    /**
+     * @brief Remove the object identified by handle. The last object of the dense array takes its slot.
+     *
+     * @param handle Handle of the object
+     * @return true If the object has been removed
+     * @return false If the handle is unknown
+     */
+    bool erase(Handle handle)
+    {
+        if (contains(handle) == false)
+        {
+            return false;
+        }
+        const uint32_t slot = m_sparse[handle];
+        const uint32_t last = (uint32_t)m_dense.size() - 1;
+        if (slot != last)
+        {
+            m_dense[slot] = std::move(m_dense[last]);
+            m_handles[slot] = m_handles[last];
+            m_sparse[m_handles[slot]] = slot;
+        }
+        m_dense.pop_back();
+        m_handles.pop_back();
+        m_sparse[handle] = INVALID_SLOT;
+        return true;
+    }
+
+    /**
+     * @brief Check if an object is stored for the given handle
+     *
+     * @param handle Handle of the object
+     * @return true The object exists
+     * @return false The handle is unknown
+     */
+    bool contains(Handle handle) const noexcept
+    {
+        return (handle < m_sparse.size()) && (m_sparse[handle] != INVALID_SLOT);
+    }
+
+    /**
+     * @brief Get the object identified by handle
+     *
+     * @param handle Handle of the object
+     * @return T* Pointer on the object, nullptr if the handle is unknown
+     */
+    T *find(Handle handle) noexcept
+    {
+        return contains(handle) ? &m_dense[m_sparse[handle]] : nullptr;
+    }
+
+    /**
+     * @brief Get the object identified by handle
+     *
+     * @param handle Handle of the object
+     * @return const T* Pointer on the object, nullptr if the handle is unknown
+     */
+    const T *find(Handle handle) const noexcept
+    {
+        return contains(handle) ? &m_dense[m_sparse[handle]] : nullptr;
+    }
+
+    /**
+     * @brief Get the number of objects stored
+     *
+     * @return size_t Number of objects
+     */
+    size_t size() const noexcept
+    {
+        return m_dense.size();
+    }
+
+    /**
+     * @brief Check if the container is empty
+     *
+     * @return true No object stored
+     * @return false At least one object stored
+     */
+    bool empty() const noexcept
+    {
+        return m_dense.empty();
+    }
+
+    /**
+     * @brief Access an object by its position in the dense array
+     *
+     * @param slot Position of the object, in [0;size()[
+     * @return T& Object
+     */
+    T &at(size_t slot) noexcept
+    {
+        return m_dense[slot];
+    }
+
+    /**
+     * @brief Access an object by its position in the dense array
+     *
+     * @param slot Position of the object, in [0;size()[
+     * @return const T& Object
+     */
+    const T &at(size_t slot) const noexcept
+    {
+        return m_dense[slot];
+    }
+
+    /**
+     * @brief Get the handle of the object at the given position in the dense array
+     *
+     * @param slot Position of the object, in [0;size()[
+     * @return Handle Handle of the object
+     */
+    Handle handle(size_t slot) const noexcept
+    {
+        return m_handles[slot];
+    }
+
+    /**
+     * @brief Iterators on the dense array
+     *
+     */
+    typename std::vector<T>::iterator begin() noexcept { return m_dense.begin(); }
+    typename std::vector<T>::iterator end() noexcept { return m_dense.end(); }
+    typename std::vector<T>::const_iterator begin() const noexcept { return m_dense.cbegin(); }
+    typename std::vector<T>::const_iterator end() const noexcept { return m_dense.cend(); }
+
+private:
+    static constexpr uint32_t INVALID_SLOT = ((uint32_t)-1);
+
+    std::vector<T> m_dense;          ///< Objects, contiguous
+    std::vector<Handle> m_handles;   ///< Handle of each object of the dense array
+    std::vector<uint32_t> m_sparse;  ///< Slot of each handle in the dense array
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "implot.h"
+#include "MBIPlotChart.h"
+#include "MBISyncCircularBuffer.h"
+
+/**
+ * @brief Spectrogram (waterfall) chart of a realtime channel : frequency as x-axis, time as y-axis and magnitude as color.
+ *
+ * A background thread copies the samples pushed into the channel, computes a Hann windowed FFT every hop samples
+ * and stores the magnitude spectrum (in dB) as a new row of a rolling history. The UI thread only copies the
+ * history when a row was added and draws it with ImPlot::PlotHeatmap, so the FFT cost never impacts the frame time.
+ *
+ * The sample rate is estimated from the time of the samples of each FFT window, so the channel is expected to be
+ * periodic. Samples overwritten in the channel before being read by the background thread are counted as dropped
+ * and restart the FFT window.
+ *
+ */
+class MBISpectrogramChart
+{
+public:
+    using DataContainer = MBISyncCircularBuffer<DataPoint>; ///< Channel analysed
+
+    static constexpr uint32_t MIN_FFT_SIZE = 16;       ///< Smallest FFT size
+    static constexpr uint32_t MAX_FFT_SIZE = 65536;    ///< Largest FFT size
+    static constexpr uint32_t WORKER_PERIOD_MS = 10;   ///< Period at which the background thread reads the channel
+
+    /***********************************************************
+     *
+     *  CTOR & DTOR
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Construct a new MBISpectrogramChart object and start the background FFT thread
+     *
+     * @param channel Channel to analyse, must remain valid during the chart lifetime
+     * @param fftSize Number of samples of each FFT, rounded down to a power of 2 in [MIN_FFT_SIZE;MAX_FFT_SIZE]
+     * @param hopSize Number of samples between two FFTs, 0 for fftSize / 2 (50% overlap). A hop larger than fftSize skips
+     * the samples between two FFTs.
+     * @param historyRows Number of spectra kept and displayed
+     */
+    explicit MBISpectrogramChart(const DataContainer *channel, uint32_t fftSize = 1024, uint32_t hopSize = 0, uint32_t historyRows = 256);
+
+    /**
+     * @brief Destroy the MBISpectrogramChart object, stopping the background thread
+     *
+     */
+    ~MBISpectrogramChart();
+
+    MBISpectrogramChart(const MBISpectrogramChart &) = delete;
+    MBISpectrogramChart &operator=(const MBISpectrogramChart &) = delete;
+
+    /***********************************************************
+     *
+     *  Configuration
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Set the magnitude range mapped on the colormap
+     *
+     * @param minDb Magnitude drawn with the first color of the colormap, in dB
+     * @param maxDb Magnitude drawn with the last color of the colormap, in dB
+     */
+    void SetScale(float minDb, float maxDb) noexcept;
+
+    /**
+     * @brief Set the colormap of the chart
+     *
+     * @param colormap ImPlot colormap
+     */
+    void SetColormap(ImPlotColormap colormap) noexcept;
+
+    /**
+     * @brief Remove all the spectra and restart the analysis from the next pushed sample
+     *
+     */
+    void Reset();
+
+    /***********************************************************
+     *
+     *  Statistics
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Get the FFT size
+     *
+     * @return uint32_t Number of samples of each FFT
+     */
+    uint32_t GetFftSize() const noexcept;
+
+    /**
+     * @brief Get the number of frequency bins of each spectrum
+     *
+     * @return uint32_t fftSize / 2 + 1
+     */
+    uint32_t GetBinCount() const noexcept;
+
+    /**
+     * @brief Get the sample rate estimated on the last FFT window
+     *
+     * @return double Sample rate in Hz, 0 if no spectrum was computed yet
+     */
+    double GetSampleRate() const;
+
+    /**
+     * @brief Get the number of spectra computed since construction
+     *
+     * @return uint64_t Number of FFTs
+     */
+    uint64_t GetSpectrumCount() const noexcept;
+
+    /**
+     * @brief Get the number of samples overwritten in the channel before being analysed
+     *
+     * @return uint64_t Number of samples dropped
+     */
+    uint64_t GetDroppedCount() const noexcept;
+
+    /***********************************************************
+     *
+     *  Main
+     *
+     * *********************************************************/
+
+    /**
+     * @brief Main function displaying the spectrogram and its color scale.
+     *
+     * @param label Title of the plot, must be unique.
+     * @param size Size of the plot area, color scale included.
+     */
+    void Display(std::string_view label, ImVec2 size);
+
+private:
+    const DataContainer *m_channel; ///< Channel analysed
+    const uint32_t m_fftSize;       ///< Number of samples of each FFT
+    const uint32_t m_hopSize;       ///< Number of samples between two FFTs
+    const uint32_t m_binCount;      ///< Number of frequency bins of each spectrum
+    const uint32_t m_historyRows;   ///< Number of spectra kept
+
+    float m_minDb;              ///< Magnitude of the first color of the colormap
+    float m_maxDb;              ///< Magnitude of the last color of the colormap
+    ImPlotColormap m_colormap;  ///< Colormap of the chart
+
+    mutable std::mutex m_mutex;   ///< Protects the spectra history and the thread requests
+    std::condition_variable m_cv; ///< Wakes up the background thread on stop
+    std::vector<float> m_rows;    ///< Spectra history, m_historyRows rows of m_binCount magnitudes
+    std::vector<double> m_times;  ///< Time of the last sample of each spectrum
+    uint32_t m_head;              ///< Row of the next spectrum
+    uint32_t m_rowCount;          ///< Number of valid rows
+    double m_sampleRate;          ///< Sample rate estimated on the last FFT window
+    uint64_t m_rowsGeneration;    ///< Incremented each time the history changes
+    bool m_resetRequest;          ///< Reset requested to the background thread
+    bool m_stop;                  ///< Background thread stop request
+
+    std::atomic<uint64_t> m_spectra; ///< Number of spectra computed
+    std::atomic<uint64_t> m_dropped; ///< Number of samples dropped
+    std::thread m_thread;            ///< Background FFT thread
+
+    std::vector<float> m_display;     ///< History ordered from the newest spectrum to the oldest, as drawn by the heatmap
+    uint32_t m_displayRows;           ///< Number of rows of m_display
+    double m_displayFirst;            ///< Time of the oldest displayed spectrum
+    double m_displayLast;             ///< Time of the newest displayed spectrum
+    double m_displayRate;             ///< Sample rate of the displayed spectra
+    uint64_t m_displayGeneration;     ///< m_rowsGeneration copied in m_display
+
+    /**
+     * @brief Background thread entry point
+     *
+     */
+    void WorkerThread();
+
+    /**
+     * @brief Add a spectrum to the history
+     *
+     * @param magnitudes m_binCount magnitudes, in dB
+     * @param time Time of the last sample of the FFT window
+     * @param sampleRate Sample rate of the FFT window
+     */
+    void PushRow(const float *magnitudes, double time, double sampleRate);
+
+    /**
+     * @brief Copy the history into m_display if a spectrum was added since last call
+     *
+     */
+    void UpdateDisplay();
+};
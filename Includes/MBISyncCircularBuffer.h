@@ -35,6 +35,17 @@ public:
         WriteLock w_lock(m_mut);
         MBICircularBuffer::push(data);
     }
+    /**
+     * @brief Add consecutive objects at the end of the buffer under a single write lock
+     *
+     * @param data Objects to add
+     * @param count Number of objects to add
+     */
+    void push(const T *data, size_t count) noexcept override
+    {
+        WriteLock w_lock(m_mut);
+        MBICircularBuffer::push(data, count);
+    }
     /**
      * @brief Empty and reset the buffer
      *
@@ -91,6 +102,99 @@ public:
         return MBICircularBuffer::size();
     }
 
+    /**
+     * @brief Get the generation of the buffer. The generation changes each time the buffer content is modified.
+     *
+     * @return uint64_t Current generation of the buffer
+     */
+    uint64_t generation() const noexcept override
+    {
+        ReadLock r_lock(m_mut);
+        return MBICircularBuffer::generation();
+    }
+
+    /**
+     * @brief Get the total number of objects pushed into the buffer since its construction.
+     *
+     * @return uint64_t Number of objects pushed
+     */
+    uint64_t pushed() const noexcept override
+    {
+        ReadLock r_lock(m_mut);
+        return MBICircularBuffer::pushed();
+    }
+
+    /**
+     * @brief Copy consecutive objects of the buffer into an array, under a single read lock
+     *
+     * @param idx Offset of the first object from the beginning of the buffer (see operator[])
+     * @param count Number of objects to copy, idx + count must not exceed size()
+     * @param out Destination array of at least count objects
+     */
+    void copy(size_t idx, size_t count, T *out) const override
+    {
+        ReadLock r_lock(m_mut);
+        MBICircularBuffer::copy(idx, count, out);
+    }
+
+    /**
+     * @brief Copy the objects pushed since a given object, identified by its stable index (see pushed()).
+     * The copy is done under a single read lock, so it is consistent with concurrent pushes.
+     *
+     * @param from Stable index of the first object to copy
+     * @param out Vector to which the objects are appended
+     * @return uint64_t Stable index of the first object copied
+     */
+    uint64_t copy_since(uint64_t from, std::vector<T> &out) const override
+    {
+        ReadLock r_lock(m_mut);
+        return MBICircularBuffer::copy_since(from, out);
+    }
+
+    /**
+     * @brief Copy at most count objects starting at a given object, identified by its stable index (see pushed()).
+     * The copy is done under a single read lock, so it is consistent with concurrent pushes.
+     *
+     * @param from Stable index of the first object to copy
+     * @param count Maximum number of objects to copy
+     * @param out Vector to which the objects are appended
+     * @return uint64_t Stable index of the first object copied
+     */
+    uint64_t copy_range(uint64_t from, size_t count, std::vector<T> &out) const override
+    {
+        ReadLock r_lock(m_mut);
+        return MBICircularBuffer::copy_range(from, count, out);
+    }
+
+    /**
+     * @brief Copy at most count objects starting at a given object, identified by its stable index (see pushed()), into
+     * an array, under a single read lock.
+     *
+     * @param from Stable index of the first object to copy
+     * @param count Maximum number of objects to copy
+     * @param out Destination array of at least count objects
+     * @param first Receives the stable index of the first object copied
+     * @return size_t Number of objects copied
+     */
+    size_t copy_range(uint64_t from, size_t count, T *out, uint64_t &first) const override
+    {
+        ReadLock r_lock(m_mut);
+        return MBICircularBuffer::copy_range(from, count, out, first);
+    }
+
+    /**
+     * @brief Get the stable indexes of the oldest object and after the newest one (see pushed()), under a single
+     * read lock
+     *
+     * @param oldest Receives the stable index of the oldest object
+     * @param end Receives the number of objects pushed
+     */
+    void bounds(uint64_t &oldest, uint64_t &end) const noexcept override
+    {
+        ReadLock r_lock(m_mut);
+        MBICircularBuffer::bounds(oldest, end);
+    }
+
     /**
      * @brief Retreive the first inserted object
      *
@@ -0,0 +1,225 @@
+#include <windows.h>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "MBIMGUI.h"
+#include "MBICaptureFile.h"
+
+MBICaptureFile::MBICaptureFile() noexcept : m_file(INVALID_HANDLE_VALUE),
+                                            m_mapping(NULL),
+                                            m_view(nullptr),
+                                            m_size(0),
+                                            m_channelHeaders(nullptr),
+                                            m_channelCount(0)
+{
+}
+
+MBICaptureFile::~MBICaptureFile()
+{
+    Close();
+}
+
+bool MBICaptureFile::Open(const std::filesystem::path &path)
+{
+    LARGE_INTEGER fileSize;
+
+    Close();
+
+    /* Map the whole file, read-only. Nothing is read until samples are accessed. */
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return Fail(path, "can't open file");
+    }
+    if (GetFileSizeEx(m_file, &fileSize) == FALSE || fileSize.QuadPart < (LONGLONG)sizeof(FileHeader))
+    {
+        return Fail(path, "file too small");
+    }
+    m_size = (uint64_t)fileSize.QuadPart;
+    m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping == NULL)
+    {
+        return Fail(path, "can't map file");
+    }
+    m_view = (const uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_view == nullptr)
+    {
+        return Fail(path, "can't map file");
+    }
+
+    /* Check headers */
+    const FileHeader *const header = (const FileHeader *)m_view;
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        return Fail(path, "not a capture file");
+    }
+    if (header->version != FORMAT_VERSION)
+    {
+        return Fail(path, "unsupported format version");
+    }
+    if (header->tableOffset > m_size || (m_size - header->tableOffset) / sizeof(ChannelHeader) < header->channelCount)
+    {
+        return Fail(path, "truncated channel table");
+    }
+    m_channelHeaders = (const ChannelHeader *)(m_view + header->tableOffset);
+    m_channelCount = header->channelCount;
+
+    /* Build the read-only views on each channel column */
+    m_views.reset(new ImVector<DataPoint>[m_channelCount]);
+    for (size_t i = 0; i < m_channelCount; i++)
+    {
+        const ChannelHeader &channel = m_channelHeaders[i];
+        if (channel.offset % sizeof(double) != 0 || channel.offset > m_size || (m_size - channel.offset) / sizeof(DataPoint) < channel.count)
+        {
+            return Fail(path, "truncated channel");
+        }
+        if (channel.count > (uint64_t)INT_MAX)
+        {
+            return Fail(path, "too many samples in channel");
+        }
+        m_views[i].Data = (DataPoint *)(m_view + channel.offset);
+        m_views[i].Size = (int)channel.count;
+        m_views[i].Capacity = (int)channel.count;
+    }
+    return true;
+}
+
+void MBICaptureFile::Close() noexcept
+{
+    if (m_views != nullptr)
+    {
+        /* Detach views from the mapped memory, ImVector would otherwise free it */
+        for (size_t i = 0; i < m_channelCount; i++)
+        {
+            m_views[i].Data = nullptr;
+            m_views[i].Size = 0;
+            m_views[i].Capacity = 0;
+        }
+        m_views.reset();
+    }
+    if (m_view != nullptr)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping != NULL)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_size = 0;
+    m_channelHeaders = nullptr;
+    m_channelCount = 0;
+}
+
+bool MBICaptureFile::IsOpen() const noexcept
+{
+    return (m_view != nullptr);
+}
+
+bool MBICaptureFile::Write(const std::filesystem::path &path, const std::vector<ChannelSource> &channels)
+{
+    static const char padding[SAMPLES_ALIGNMENT] = {0};
+    FileHeader header = {};
+    std::vector<ChannelHeader> table(channels.size());
+
+    /* Layout : header, channel table, then aligned channel columns */
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.channelCount = (uint32_t)channels.size();
+    header.tableOffset = sizeof(FileHeader);
+
+    uint64_t offset = header.tableOffset + table.size() * sizeof(ChannelHeader);
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        const ChannelSource &source = channels[i];
+        ChannelHeader &channel = table[i];
+        const int count = (source.data != nullptr) ? source.data->Size : 0;
+
+        memset(&channel, 0, sizeof(channel));
+        strncpy_s(channel.name, source.name.c_str(), CHANNEL_NAME_SIZE - 1);
+        channel.periodMs = source.periodMs;
+        channel.offset = (offset + SAMPLES_ALIGNMENT - 1) / SAMPLES_ALIGNMENT * SAMPLES_ALIGNMENT;
+        channel.count = (uint64_t)count;
+
+        /* Continuous : no NaN and, for periodic data, no hole larger than one and a half period */
+        const double maxDelta = 1.5 * (double)source.periodMs / 1000.0;
+        bool continuous = true;
+        for (int s = 0; s < count && continuous; s++)
+        {
+            const DataPoint &sample = (*source.data)[s];
+            continuous = !std::isnan(sample.m_time) && !std::isnan(sample.m_data);
+            if (continuous && s > 0 && source.periodMs != 0)
+            {
+                continuous = (sample.m_time - (*source.data)[s - 1].m_time) <= maxDelta;
+            }
+        }
+        channel.flags = continuous ? CHANNEL_FLAG_CONTINUOUS : 0;
+
+        offset = channel.offset + channel.count * sizeof(DataPoint);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Can't create capture file %s", path.string().c_str());
+        return false;
+    }
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)table.data(), table.size() * sizeof(ChannelHeader));
+    offset = header.tableOffset + table.size() * sizeof(ChannelHeader);
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        file.write(padding, (std::streamsize)(table[i].offset - offset));
+        if (table[i].count > 0)
+        {
+            file.write((const char *)channels[i].data->Data, (std::streamsize)(table[i].count * sizeof(DataPoint)));
+        }
+        offset = table[i].offset + table[i].count * sizeof(DataPoint);
+    }
+    if (file.fail())
+    {
+        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Error while writing capture file %s", path.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t MBICaptureFile::GetChannelCount() const noexcept
+{
+    return m_channelCount;
+}
+
+std::string_view MBICaptureFile::GetChannelName(size_t channel) const
+{
+    const ChannelHeader &header = m_channelHeaders[channel];
+    return std::string_view(header.name, strnlen(header.name, CHANNEL_NAME_SIZE));
+}
+
+uint32_t MBICaptureFile::GetChannelPeriod(size_t channel) const
+{
+    return m_channelHeaders[channel].periodMs;
+}
+
+bool MBICaptureFile::IsChannelContinuous(size_t channel) const
+{
+    return (m_channelHeaders[channel].flags & CHANNEL_FLAG_CONTINUOUS) != 0;
+}
+
+const ImVector<DataPoint> *MBICaptureFile::GetChannel(size_t channel) const
+{
+    return &m_views[channel];
+}
+
+bool MBICaptureFile::Fail(const std::filesystem::path &path, std::string_view reason)
+{
+    MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Capture file %s : %s", path.string().c_str(), reason.data());
+    Close();
+    return false;
+}
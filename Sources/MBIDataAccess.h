@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+
+#include "MBIPlotChart.h"
+
+/**
+ * @brief Get the generation of a static data container. Static data are expected to be append only, so the number
+ * of samples is used as generation. In-place modifications are tracked by the channel, see DataChannel::Modified.
+ *
+ * @param container Data container
+ * @return uint64_t Generation of the container
+ */
+template <typename T>
+inline uint64_t DataGeneration(const ImVector<T> &container) noexcept
+{
+    return (uint64_t)container.Size;
+}
+
+/**
+ * @brief Get the generation of a circular data container.
+ *
+ * @param container Data container
+ * @return uint64_t Generation of the container
+ */
+template <typename T>
+inline uint64_t DataGeneration(const MBICircularBuffer<T> &container) noexcept
+{
+    return container.generation();
+}
+
+/**
+ * @brief Get the number of samples ever appended to a static data container.
+ *
+ * @param container Data container
+ * @return uint64_t Number of samples appended
+ */
+template <typename T>
+inline uint64_t DataPushedCount(const ImVector<T> &container) noexcept
+{
+    return (uint64_t)container.Size;
+}
+
+/**
+ * @brief Get the number of samples ever pushed into a circular data container.
+ *
+ * @param container Data container
+ * @return uint64_t Number of samples pushed
+ */
+template <typename T>
+inline uint64_t DataPushedCount(const MBICircularBuffer<T> &container) noexcept
+{
+    return container.pushed();
+}
+
+/**
+ * @brief Copy consecutive samples of a static data container.
+ *
+ * @param container Data container
+ * @param offset Offset of the first sample to copy
+ * @param count Number of samples to copy
+ * @param out Destination array of at least count samples
+ */
+template <typename T>
+inline void DataCopy(const ImVector<T> &container, size_t offset, size_t count, T *out) noexcept
+{
+    memcpy(out, container.Data + offset, count * sizeof(T));
+}
+
+/**
+ * @brief Copy consecutive samples of a circular data container.
+ *
+ * @param container Data container
+ * @param offset Offset of the first sample to copy
+ * @param count Number of samples to copy
+ * @param out Destination array of at least count samples
+ */
+template <typename T>
+inline void DataCopy(const MBICircularBuffer<T> &container, size_t offset, size_t count, T *out)
+{
+    container.copy(offset, count, out);
+}
+
+/**
+ * @brief Get the absolute indexes of the first sample and after the last sample of a static data container.
+ *
+ * @param container Data container
+ * @param start Receives the absolute index of the first sample
+ * @param pushed Receives the number of samples appended
+ */
+template <typename T>
+inline void DataBounds(const ImVector<T> &container, uint64_t &start, uint64_t &pushed) noexcept
+{
+    start = 0;
+    pushed = (uint64_t)container.Size;
+}
+
+/**
+ * @brief Get the absolute indexes of the first sample and after the last sample of a circular data container, read
+ * together so they are consistent with concurrent pushes.
+ *
+ * @param container Data container
+ * @param start Receives the absolute index of the first sample
+ * @param pushed Receives the number of samples pushed
+ */
+template <typename T>
+inline void DataBounds(const MBICircularBuffer<T> &container, uint64_t &start, uint64_t &pushed) noexcept
+{
+    container.bounds(start, pushed);
+}
+
+/**
+ * @brief Copy at most count consecutive samples of a static data container, from an absolute index.
+ *
+ * @param container Data container
+ * @param from Absolute index of the first sample to copy
+ * @param count Maximum number of samples to copy
+ * @param out Destination array of at least count samples
+ * @param first Receives the absolute index of the first sample copied
+ * @return size_t Number of samples copied
+ */
+template <typename T>
+inline size_t DataCopyRange(const ImVector<T> &container, uint64_t from, size_t count, T *out, uint64_t &first) noexcept
+{
+    first = from;
+    if (from >= (uint64_t)container.Size)
+    {
+        return 0;
+    }
+    const size_t copied = (size_t)std::min<uint64_t>(count, (uint64_t)container.Size - from);
+    std::copy_n(container.Data + from, copied, out);
+    return copied;
+}
+
+/**
+ * @brief Copy at most count consecutive samples of a circular data container, from an absolute index. Samples
+ * already overwritten are skipped.
+ *
+ * @param container Data container
+ * @param from Absolute index of the first sample to copy
+ * @param count Maximum number of samples to copy
+ * @param out Destination array of at least count samples
+ * @param first Receives the absolute index of the first sample copied
+ * @return size_t Number of samples copied
+ */
+template <typename T>
+inline size_t DataCopyRange(const MBICircularBuffer<T> &container, uint64_t from, size_t count, T *out, uint64_t &first)
+{
+    return container.copy_range(from, count, out, first);
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+
+#include "MBIDataAccess.h"
+
+/**
+ * @brief Group of annotations close enough on screen to be drawn as a single badge.
+ * Annotations are identified by their absolute index (see DataPushedCount).
+ *
+ */
+struct AnnotationCluster
+{
+    uint64_t index; ///< Absolute index of the first annotation of the cluster (lowest x)
+    int count;      ///< Number of annotations in the cluster
+};
+
+/**
+ * @brief Index of annotations sorted by x position, used to find the annotations of the displayed range
+ * with binary searches instead of walking the whole container.
+ *
+ * The index is built incrementally : only annotations appended since the previous update are parsed.
+ * Annotations are usually appended in time order, in which case indexing is a simple append.
+ * Annotations are identified by their absolute index (number of annotations pushed before them), so the index
+ * remains valid when a circular buffer wraps.
+ *
+ */
+class DataAnnotationIndex
+{
+public:
+    DataAnnotationIndex() noexcept : m_start(0), m_indexed(0), m_inOrder(true) {}
+
+    /**
+     * @brief Index the annotations appended since the last update and forget the evicted ones.
+     *
+     * @param annotations Annotation container
+     */
+    template <typename Container>
+    void Update(const Container &annotations)
+    {
+        static constexpr uint64_t BATCH_SIZE = 64;
+        using Annotation = std::decay_t<decltype(annotations[0])>;
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(annotations, start, pushed);
+
+        /* Annotation container has been cleared : restart indexing */
+        if (pushed < m_indexed)
+        {
+            Clear();
+        }
+        /* Annotations overwritten before being indexed */
+        if (m_indexed < start)
+        {
+            m_indexed = start;
+        }
+
+        /* Annotations read by absolute index, by batches copied under the container lock */
+        Annotation batch[BATCH_SIZE];
+        while (m_indexed < pushed)
+        {
+            uint64_t copied;
+            const size_t count = DataCopyRange(annotations, m_indexed, (size_t)std::min(pushed - m_indexed, BATCH_SIZE), batch, copied);
+            if (count == 0)
+            {
+                break;
+            }
+            m_indexed = copied;
+            for (size_t i = 0; i < count; i++, m_indexed++)
+            {
+                const Entry entry = {batch[i].m_x, m_indexed};
+                if (m_entries.empty() || entry.x >= m_entries.back().x)
+                {
+                    m_entries.push_back(entry);
+                }
+                else
+                {
+                    /* Out of order annotation : insert after the annotations with the same position */
+                    m_entries.insert(m_entries.begin() + UpperBound(entry.x), entry);
+                    m_inOrder = false;
+                }
+            }
+        }
+
+        /* Forget evicted annotations */
+        if (start > m_start)
+        {
+            if (m_inOrder)
+            {
+                /* Sorted by position and by insertion : evicted annotations are the first ones */
+                int evicted = 0;
+                while (evicted < m_entries.Size && m_entries[evicted].index < start)
+                {
+                    evicted++;
+                }
+                if (evicted > 0)
+                {
+                    m_entries.erase(m_entries.begin(), m_entries.begin() + evicted);
+                }
+            }
+            else
+            {
+                int kept = 0;
+                for (int i = 0; i < m_entries.Size; i++)
+                {
+                    if (m_entries[i].index >= start)
+                    {
+                        m_entries[kept++] = m_entries[i];
+                    }
+                }
+                m_entries.resize(kept);
+            }
+        }
+        if (m_entries.empty())
+        {
+            m_inOrder = true;
+        }
+        m_start = start;
+    }
+
+    /**
+     * @brief Group the annotations of [xMin;xMax[ into clusters. A cluster starts at its first annotation position x
+     * and contains all annotations before nextX(x). Number of clusters, and so the rendering cost, is bounded by
+     * the plot size instead of the number of annotations.
+     *
+     * @param xMin Start of the displayed range
+     * @param xMax End of the displayed range
+     * @param nextX Callable returning the first position not overlapping an annotation drawn at the given position
+     * @param clusters Clusters of the range, cleared before use
+     */
+    template <typename NextX>
+    void GetClusters(double xMin, double xMax, NextX nextX, ImVector<AnnotationCluster> &clusters) const
+    {
+        clusters.resize(0);
+        int first = LowerBound(xMin, 0);
+        const int end = LowerBound(xMax, first);
+        while (first < end)
+        {
+            int next = LowerBound(nextX(m_entries[first].x), first + 1);
+            if (next > end)
+                next = end;
+            clusters.push_back(AnnotationCluster{m_entries[first].index, next - first});
+            first = next;
+        }
+    }
+
+    /**
+     * @brief Reset the index
+     *
+     */
+    void Clear() noexcept
+    {
+        m_entries.clear();
+        m_start = 0;
+        m_indexed = 0;
+        m_inOrder = true;
+    }
+
+private:
+    /**
+     * @brief Indexed annotation
+     *
+     */
+    struct Entry
+    {
+        double x;       ///< Position of the annotation
+        uint64_t index; ///< Absolute index of the annotation
+    };
+
+    ImVector<Entry> m_entries; ///< Indexed annotations, sorted by position
+    uint64_t m_start;          ///< Absolute index of the first annotation of the container
+    uint64_t m_indexed;        ///< Absolute index of the next annotation to index
+    bool m_inOrder;            ///< Annotations have been appended in position order
+
+    /**
+     * @brief Binary search of the first entry at or after x, starting from the given entry
+     *
+     * @param x Position to look for
+     * @param from First entry to consider
+     * @return int Offset of the entry
+     */
+    int LowerBound(double x, int from) const noexcept
+    {
+        int lo = from;
+        int hi = m_entries.Size;
+        while (lo < hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            if (m_entries[mid].x < x)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Binary search of the first entry after x
+     *
+     * @param x Position to look for
+     * @return int Offset of the entry
+     */
+    int UpperBound(double x) const noexcept
+    {
+        int lo = 0;
+        int hi = m_entries.Size;
+        while (lo < hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            if (m_entries[mid].x <= x)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+};
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstring>
+#include "MBIDataBus.h"
+
+MBIDataBus::MBIDataBus(uint32_t channelCount, size_t capacity) : m_channelCount(channelCount),
+                                                                 m_capacity(std::max<size_t>(capacity, 2)),
+                                                                 m_times(new double[std::max<size_t>(capacity, 2)]),
+                                                                 m_values(new double[std::max<size_t>(capacity, 2) * channelCount]),
+                                                                 m_committed(0),
+                                                                 m_next(0),
+                                                                 m_dropped(0)
+{
+    m_batch.resize(BATCH_SIZE);
+}
+
+uint32_t MBIDataBus::GetChannelCount() const noexcept
+{
+    return m_channelCount;
+}
+
+void MBIDataBus::Publish(double time, const double *values) noexcept
+{
+    const uint64_t frame = m_committed.load(std::memory_order_relaxed);
+    const size_t slot = (size_t)(frame % m_capacity);
+
+    m_times[slot] = time;
+    memcpy(&m_values[slot * m_channelCount], values, m_channelCount * sizeof(double));
+
+    /* Single commit for the whole frame : the consumer sees all the values or none */
+    m_committed.store(frame + 1, std::memory_order_release);
+}
+
+uint64_t MBIDataBus::GetPublishedCount() const noexcept
+{
+    return m_committed.load(std::memory_order_acquire);
+}
+
+uint64_t MBIDataBus::GetGeneration(const void *bus) noexcept
+{
+    return static_cast<const MBIDataBus *>(bus)->GetPublishedCount();
+}
+
+const MBIDataBus::Channel *MBIDataBus::Subscribe(ChannelId channel, size_t historySize)
+{
+    if (channel >= m_channelCount)
+    {
+        return nullptr;
+    }
+    for (const Subscription &subscription : m_subscriptions)
+    {
+        if (subscription.id == channel)
+        {
+            return subscription.buffer.get();
+        }
+    }
+    m_subscriptions.push_back({channel, std::make_unique<Channel>(historySize)});
+    return m_subscriptions.back().buffer.get();
+}
+
+void MBIDataBus::Update()
+{
+    const uint64_t committed = m_committed.load(std::memory_order_acquire);
+    uint64_t first = m_next;
+
+    while (first < committed)
+    {
+        /* Frames the producer may be overwriting are never read */
+        const uint64_t oldest = GetOldestReadable();
+        if (first < oldest)
+        {
+            m_dropped += oldest - first;
+            first = oldest;
+            if (first >= committed)
+            {
+                break;
+            }
+        }
+
+        const size_t count = (size_t)std::min<uint64_t>(committed - first, BATCH_SIZE);
+        size_t overwritten = 0;
+        for (Subscription &subscription : m_subscriptions)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                const size_t slot = (size_t)((first + i) % m_capacity);
+                m_batch[i] = DataPoint(m_times[slot], m_values[slot * m_channelCount + subscription.id]);
+            }
+
+            /* Frames overwritten by the producer while being copied are discarded */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t valid = GetOldestReadable();
+            const size_t skip = (valid > first) ? (size_t)std::min<uint64_t>(valid - first, count) : 0;
+            overwritten = std::max(overwritten, skip);
+            subscription.buffer->push(m_batch.data() + skip, count - skip);
+        }
+        m_dropped += overwritten;
+        first += count;
+    }
+    m_next = first;
+}
+
+uint64_t MBIDataBus::GetOldestReadable() const noexcept
+{
+    const uint64_t committed = m_committed.load(std::memory_order_relaxed);
+    return (committed > m_capacity - 1) ? (committed - (m_capacity - 1)) : 0;
+}
+
+uint64_t MBIDataBus::GetDroppedCount() const noexcept
+{
+    return m_dropped;
+}
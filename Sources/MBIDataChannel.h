@@ -0,0 +1,187 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "MBIPlotChart.h"
+#include "MBIDataWindowCache.h"
+#include "MBIDataGapIndex.h"
+#include "MBIDownSampleCache.h"
+#include "MBIDataStatsIndex.h"
+
+/**
+ * @brief State of a data channel shared by all the graphs displaying it : gap index and down sampled views.
+ * A channel shown in an overview graph and several detail graphs is indexed once, and a view requested by
+ * several graphs (same range and resolution) is down sampled once.
+ *
+ */
+struct DataChannel
+{
+    static constexpr size_t MAX_GAP_INDEXES = 4; ///< Gap detection settings indexed at once, the least recently used is replaced
+
+    DownSampleCache dsCache; ///< Recently computed down sampled views
+    DataStatsIndex stats;    ///< Values statistics, updated on demand
+    DataWindowCache window;  ///< Data window of the current frame, shared by the linked graphs
+    uint64_t edits = 0;      ///< Generation of the in-place modifications of the data, part of the down sampled views keys
+
+    /**
+     * @brief Declare samples of the data modified in place. Data generations only track appended samples, so the
+     * views down sampled before the modification are no longer used and the indexes are rebuilt.
+     *
+     */
+    void Modified() noexcept
+    {
+        edits++;
+        stats.Clear();
+        window.Clear();
+        ClearGaps();
+    }
+
+    /**
+     * @brief Get the gap index of a gap detection setting, creating it if needed. Graphs displaying the data with
+     * different settings each keep their own index instead of rebuilding a shared one every frame.
+     *
+     * @param periodMs Sampling period of the data in ms
+     * @param gapThreshold Gap detection threshold, in number of periods
+     * @return DataGapIndex& Gap index. Once MAX_GAP_INDEXES settings are in use, it may be rebuilt for another setting
+     * by a later call.
+     */
+    DataGapIndex &GetGaps(uint32_t periodMs, float gapThreshold)
+    {
+        /* Settings giving the same time hole build the same index */
+        const double maxDelta = (double)gapThreshold * (double)periodMs / 1000.0;
+        GapEntry *lru = nullptr;
+        for (GapEntry &entry : m_gaps)
+        {
+            if (entry.maxDelta == maxDelta)
+            {
+                entry.lastUse = ++m_gapsTick;
+                return *entry.index;
+            }
+            if (lru == nullptr || entry.lastUse < lru->lastUse)
+            {
+                lru = &entry;
+            }
+        }
+        if (m_gaps.size() < MAX_GAP_INDEXES)
+        {
+            m_gaps.push_back(GapEntry{0.0, 0, std::make_unique<DataGapIndex>()});
+            lru = &m_gaps.back();
+        }
+        lru->maxDelta = maxDelta;
+        lru->lastUse = ++m_gapsTick;
+        lru->index->SetContinuous(m_continuous);
+        lru->index->SetLazy(m_lazyGaps);
+        return *lru->index;
+    }
+
+    /**
+     * @brief Declare the data as gap free, see DataGapIndex::SetContinuous
+     *
+     * @param continuous True if the data is known to be gap free
+     */
+    void SetContinuous(bool continuous) noexcept
+    {
+        m_continuous = continuous;
+        for (GapEntry &entry : m_gaps)
+        {
+            entry.index->SetContinuous(continuous);
+        }
+    }
+
+    /**
+     * @brief Index only the displayed windows, see DataGapIndex::SetLazy
+     *
+     * @param lazy True to index the displayed windows only
+     */
+    void SetLazyGaps(bool lazy) noexcept
+    {
+        m_lazyGaps = lazy;
+        for (GapEntry &entry : m_gaps)
+        {
+            entry.index->SetLazy(lazy);
+        }
+    }
+
+    /**
+     * @brief Reset the gap indexes
+     *
+     */
+    void ClearGaps() noexcept
+    {
+        m_gaps.clear();
+    }
+
+private:
+    /**
+     * @brief Gap index of a gap detection setting
+     *
+     */
+    struct GapEntry
+    {
+        double maxDelta;                     ///< Time hole, in s, of the setting
+        uint64_t lastUse;                    ///< Value of m_gapsTick when last used
+        std::unique_ptr<DataGapIndex> index; ///< Gap index, allocated so references remain valid when entries are added
+    };
+
+    std::vector<GapEntry> m_gaps; ///< Gap indexes of the settings in use
+    uint64_t m_gapsTick = 0;      ///< Use counter, for the LRU replacement
+    bool m_continuous = false;    ///< Data is known to be gap free
+    bool m_lazyGaps = false;      ///< Gap indexes only index the displayed windows
+};
+
+/**
+ * @brief Process wide registry of data channels, keyed by data container. Graphs hold a shared reference on
+ * the channel of each of their variables, the channel is released when no graph displays it anymore.
+ *
+ */
+class MBIChannelRegistry
+{
+public:
+    /**
+     * @brief Get the channel of a data container, creating it if needed
+     *
+     * @param data Data container of the channel
+     * @return std::shared_ptr<DataChannel> Shared channel state
+     */
+    static std::shared_ptr<DataChannel> Acquire(const void *data)
+    {
+        if (data == nullptr)
+        {
+            return std::make_shared<DataChannel>();
+        }
+
+        std::lock_guard<std::mutex> lock(GetMutex());
+        std::unordered_map<const void *, std::weak_ptr<DataChannel>> &channels = GetChannels();
+        std::shared_ptr<DataChannel> channel = channels[data].lock();
+        if (channel == nullptr)
+        {
+            /* Forget released channels before adding a new one */
+            for (auto it = channels.begin(); it != channels.end();)
+            {
+                if (it->second.expired())
+                    it = channels.erase(it);
+                else
+                    it++;
+            }
+            channel = std::make_shared<DataChannel>();
+            channels[data] = channel;
+        }
+        return channel;
+    }
+
+private:
+    static std::mutex &GetMutex()
+    {
+        static std::mutex mut;
+        return mut;
+    }
+
+    static std::unordered_map<const void *, std::weak_ptr<DataChannel>> &GetChannels()
+    {
+        static std::unordered_map<const void *, std::weak_ptr<DataChannel>> channels;
+        return channels;
+    }
+};
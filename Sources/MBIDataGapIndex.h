@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "MBIDataAccess.h"
+
+/**
+ * @brief Part of a curve without any gap. Offset is relative to the first sample of the data container.
+ *
+ */
+struct DataSegment
+{
+    int offset; ///< Offset of the first sample of the segment
+    int size;   ///< Number of samples in the segment
+};
+
+/**
+ * @brief Index of the gap free segments of a curve.
+ *
+ * A gap is either a NaN sample or, for periodic data, a time hole larger than a given number of periods.
+ * The index is built incrementally : only samples appended since the previous update are parsed.
+ * Samples are identified by their absolute index (number of samples pushed before them), so the index
+ * remains valid when a circular buffer wraps. In lazy mode, only the displayed window is indexed (see SetLazy).
+ *
+ */
+class DataGapIndex
+{
+public:
+    DataGapIndex() noexcept : m_start(0), m_indexed(0), m_lastTime(0.0), m_lastTimeGap(NO_GAP), m_open(false), m_maxDelta(0.0), m_continuous(false),
+                              m_lazy(false), m_lazyFirst(0), m_lazyEnd(0) {}
+
+    /**
+     * @brief Index the samples appended since the last update and forget the evicted ones.
+     *
+     * @param data Data container
+     * @param periodMs Sampling period of the data in ms. Zero for non periodic data (no time gap detection)
+     * @param gapThreshold Time hole, in number of periods, above which a gap is detected. Zero disables time gap detection.
+     */
+    template <typename Container>
+    void Update(const Container &data, uint32_t periodMs, float gapThreshold)
+    {
+        static constexpr uint64_t BATCH_SIZE = 256;
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(data, start, pushed);
+        const double maxDelta = (double)gapThreshold * (double)periodMs / 1000.0;
+
+        /* Data known to be gap free : a single segment, no sample is read */
+        if (m_continuous)
+        {
+            m_segments.resize(0);
+            if (pushed > start)
+            {
+                m_segments.push_back(Segment{start, pushed});
+            }
+            m_start = start;
+            m_indexed = pushed;
+            return;
+        }
+
+        /* Windows indexed on demand by GetSegments : only the bounds are tracked */
+        if (m_lazy)
+        {
+            if (pushed != m_indexed || start != m_start || maxDelta != m_maxDelta)
+            {
+                m_segments.resize(0);
+                m_lazyFirst = 0;
+                m_lazyEnd = 0;
+            }
+            m_maxDelta = maxDelta;
+            m_start = start;
+            m_indexed = pushed;
+            return;
+        }
+
+        /* Data container has been cleared or detection settings changed : restart indexing */
+        if (pushed < m_indexed || maxDelta != m_maxDelta)
+        {
+            Clear();
+            m_maxDelta = maxDelta;
+        }
+        /* Samples overwritten before being indexed */
+        if (m_indexed < start)
+        {
+            m_indexed = start;
+            m_open = false;
+        }
+
+        /* Samples read by absolute index, by batches copied under the container lock */
+        DataPoint batch[BATCH_SIZE];
+        while (m_indexed < pushed)
+        {
+            uint64_t copied;
+            const size_t count = DataCopyRange(data, m_indexed, (size_t)std::min(pushed - m_indexed, BATCH_SIZE), batch, copied);
+            if (count == 0)
+            {
+                break;
+            }
+            if (copied != m_indexed)
+            {
+                /* Samples overwritten before being indexed */
+                m_indexed = copied;
+                m_open = false;
+            }
+            for (size_t i = 0; i < count; i++, m_indexed++)
+            {
+                const DataPoint &sample = batch[i];
+                if (std::isnan(sample.m_data) || std::isnan(sample.m_time))
+                {
+                    /* Invalid sample : close current segment */
+                    m_open = false;
+                    continue;
+                }
+                if (m_open && maxDelta > 0.0 && (sample.m_time - m_lastTime) > maxDelta)
+                {
+                    /* Missing samples : close current segment */
+                    m_open = false;
+                    m_lastTimeGap = m_indexed;
+                }
+                if (m_open)
+                {
+                    m_segments.back().end = m_indexed + 1;
+                }
+                else
+                {
+                    m_segments.push_back(Segment{m_indexed, m_indexed + 1});
+                    m_open = true;
+                }
+                m_lastTime = sample.m_time;
+            }
+        }
+
+        /* Forget evicted segments */
+        int evicted = 0;
+        while (evicted < m_segments.Size && m_segments[evicted].end <= start)
+        {
+            evicted++;
+        }
+        if (evicted > 0)
+        {
+            m_segments.erase(m_segments.begin(), m_segments.begin() + evicted);
+        }
+        if (m_segments.empty() == false && m_segments[0].first < start)
+        {
+            m_segments[0].first = start;
+        }
+        m_start = start;
+    }
+
+    /**
+     * @brief Compute the gap free parts of a window of data. In lazy mode, the window is indexed first if it is not
+     * the last one indexed.
+     *
+     * @param data Data container, indexed by Update
+     * @param offset Offset of the window, relative to the first sample of the container
+     * @param size Number of samples of the window
+     * @param segments Gap free parts of the window, cleared before use
+     */
+    template <typename Container>
+    void GetSegments(const Container &data, int offset, int size, ImVector<DataSegment> &segments)
+    {
+        const uint64_t first = m_start + (uint64_t)offset;
+        const uint64_t end = first + (uint64_t)size;
+        if (m_lazy && !m_continuous && (first != m_lazyFirst || end != m_lazyEnd))
+        {
+            IndexWindow(data, first, end);
+        }
+
+        segments.resize(0);
+        /* Segments are sorted, look for the first one ending after the window start */
+        int lo = 0;
+        int hi = m_segments.Size;
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) / 2;
+            if (m_segments[mid].end <= first)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (int i = lo; i < m_segments.Size && m_segments[i].first < end; i++)
+        {
+            const uint64_t segFirst = (m_segments[i].first > first) ? m_segments[i].first : first;
+            const uint64_t segEnd = (m_segments[i].end < end) ? m_segments[i].end : end;
+            segments.push_back(DataSegment{(int)(segFirst - m_start), (int)(segEnd - segFirst)});
+        }
+    }
+
+    /**
+     * @brief Check if the currently indexed data contain missing samples (time holes).
+     *
+     * @return true Some samples are missing, the data period can't be used to compute sample offsets
+     * @return false Data are strictly periodic
+     */
+    bool HasTimeGaps() const noexcept
+    {
+        /* Lazy mode : unknown outside the indexed window, the data period can't be trusted */
+        if (m_lazy && !m_continuous)
+        {
+            return true;
+        }
+        return (m_lastTimeGap != NO_GAP) && (m_lastTimeGap >= m_start);
+    }
+
+    /**
+     * @brief Declare the data as gap free (no NaN, no missing sample). Indexing then doesn't read any sample,
+     * which avoids paging in the whole data set for file backed data.
+     *
+     * @param continuous True if the data is known to be gap free
+     */
+    void SetContinuous(bool continuous) noexcept
+    {
+        m_continuous = continuous;
+        Clear();
+    }
+
+    /**
+     * @brief Index only the windows requested by GetSegments instead of the whole data. Used for large file backed
+     * data which is not known to be gap free, so only the displayed samples are paged in. Time gaps are then
+     * reported as always possible (see HasTimeGaps), so windows are located by time.
+     *
+     * @param lazy True to index the displayed windows only
+     */
+    void SetLazy(bool lazy) noexcept
+    {
+        m_lazy = lazy;
+        Clear();
+    }
+
+    /**
+     * @brief Reset the index
+     *
+     */
+    void Clear() noexcept
+    {
+        m_segments.clear();
+        m_start = 0;
+        m_indexed = 0;
+        m_lastTimeGap = NO_GAP;
+        m_open = false;
+        m_lazyFirst = 0;
+        m_lazyEnd = 0;
+    }
+
+private:
+    static constexpr uint64_t NO_GAP = ((uint64_t)-1);
+
+    /**
+     * @brief Replace the segments by the ones of a window, for the lazy mode
+     *
+     * @param data Data container
+     * @param first Absolute index of the first sample of the window
+     * @param end Absolute index after the last sample of the window
+     */
+    template <typename Container>
+    void IndexWindow(const Container &data, uint64_t first, uint64_t end)
+    {
+        static constexpr uint64_t BATCH_SIZE = 256;
+        DataPoint batch[BATCH_SIZE];
+        bool open = false;
+        double lastTime = 0.0;
+
+        m_segments.resize(0);
+        m_lazyFirst = first;
+        m_lazyEnd = end;
+        uint64_t index = first;
+        while (index < end)
+        {
+            uint64_t copied;
+            const size_t count = DataCopyRange(data, index, (size_t)std::min(end - index, BATCH_SIZE), batch, copied);
+            if (count == 0)
+            {
+                break;
+            }
+            if (copied != index)
+            {
+                open = false;
+            }
+            index = copied;
+            for (size_t i = 0; i < count; i++, index++)
+            {
+                const DataPoint &sample = batch[i];
+                if (std::isnan(sample.m_data) || std::isnan(sample.m_time))
+                {
+                    open = false;
+                    continue;
+                }
+                if (open && m_maxDelta > 0.0 && (sample.m_time - lastTime) > m_maxDelta)
+                {
+                    open = false;
+                }
+                if (open)
+                {
+                    m_segments.back().end = index + 1;
+                }
+                else
+                {
+                    m_segments.push_back(Segment{index, index + 1});
+                    open = true;
+                }
+                lastTime = sample.m_time;
+            }
+        }
+    }
+
+    /**
+     * @brief Gap free segment, as absolute indexes [first;end[
+     *
+     */
+    struct Segment
+    {
+        uint64_t first;
+        uint64_t end;
+    };
+
+    ImVector<Segment> m_segments; ///< Gap free segments, sorted
+    uint64_t m_start;             ///< Absolute index of the first sample of the container
+    uint64_t m_indexed;           ///< Absolute index of the next sample to index
+    double m_lastTime;            ///< Time of the last valid indexed sample
+    uint64_t m_lastTimeGap;       ///< Absolute index of the last time hole detected
+    bool m_open;                  ///< The last segment can be extended
+    double m_maxDelta;            ///< Time hole, in s, used to build the index
+    bool m_continuous;            ///< Data is known to be gap free
+    bool m_lazy;                  ///< Only the window requested by GetSegments is indexed
+    uint64_t m_lazyFirst;         ///< Lazy mode : absolute index of the first sample of the indexed window
+    uint64_t m_lazyEnd;           ///< Lazy mode : absolute index after the last sample of the indexed window
+};
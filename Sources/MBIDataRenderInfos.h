@@ -0,0 +1,510 @@
+#pragma once
+
+#include "MBIPlotChart.h"
+#include "MBIDataAccess.h"
+#include "MBIDataChannel.h"
+#include "MBIDataAnnotationIndex.h"
+
+/**
+ * @brief Define a curve displayed on the graph
+ *
+ */
+template <template <typename> class Container>
+struct DataRenderInfos
+{
+public:
+    const Container<DataPoint> *data;                      ///< Curve data points
+    ImVector<DataPoint> dsData;                            ///< Down sampled curve data
+    ImVector<int> dsSegments;                              ///< Size of each gap free segment of dsData
+    std::shared_ptr<DataChannel> channel;                  ///< State shared with the other graphs displaying the same data
+    ImVector<DataSegment> visibleSegments;                 ///< Gap free segments of the displayed window
+    ImVector<ImVec2> relData;                              ///< Points plotted this frame, float32 relative to the curves axis origin. Scratch buffer reused each frame
+    const Container<DataAnnotation> *annotation;           ///< Data annotation, if exists
+    const Container<CompactAnnotation> *compactAnnotation; ///< Compact data annotation, if exists
+    DataAnnotationIndex annotIndex;                        ///< Annotations sorted by position
+    ImVector<AnnotationCluster> annotClusters;             ///< Annotations of the displayed window, grouped by screen proximity
+
+    uint32_t dataOffset;       ///< Start display offset of data
+    uint32_t dataPeriodMs;     ///< Sampling data period in ms
+    DataDescriptor descriptor; ///< Curve descriptor
+    uint64_t windowStart;      ///< Absolute index of the first displayed sample on last frame
+    uint64_t windowEnd;        ///< Absolute index after the last displayed sample on last frame
+
+    /**
+     * @brief Construct a new DataRenderInfos object
+     *
+     * @param ptrData Pointer to the data to render.
+     * @param showLabels Show annotations on the graph.
+     */
+    explicit DataRenderInfos(const Container<DataPoint> *const ptrData, bool showLabels = false) : data(ptrData),
+                                                                                                   channel(MBIChannelRegistry::Acquire(ptrData)),
+                                                                                                   annotation(nullptr),
+                                                                                                   compactAnnotation(nullptr),
+                                                                                                   dataOffset(0),
+                                                                                                   dataPeriodMs(1),
+                                                                                                   descriptor(showLabels),
+                                                                                                   windowStart(0),
+                                                                                                   windowEnd(0)
+
+    {
+    }
+
+    /**
+     * @brief Copy construct a new DataRenderInfos object
+     *
+     * @param other Other instance to copy
+     */
+    explicit DataRenderInfos(const DataRenderInfos *const other) noexcept : data(other->data),
+                                                                            channel(other->channel),
+                                                                            annotation(other->annotation),
+                                                                            compactAnnotation(other->compactAnnotation),
+                                                                            dataOffset(0),
+                                                                            dataPeriodMs(other->dataPeriodMs),
+                                                                            descriptor(other->descriptor),
+                                                                            windowStart(0),
+                                                                            windowEnd(0)
+    {
+        /* Display state belongs to the destination graph */
+        descriptor.bOnGraph = false;
+    }
+
+    /**
+     * @brief Reset the data rendering infos.
+     *
+     */
+    void Clear() noexcept
+    {
+        dsData.clear();
+        dsSegments.clear();
+        channel->dsCache.Clear();
+        channel->ClearGaps();
+        channel->stats.Clear();
+        channel->window.Clear();
+        visibleSegments.clear();
+        relData.clear();
+        annotIndex.Clear();
+        annotClusters.clear();
+        dataOffset = 0;
+        windowStart = 0;
+        windowEnd = 0;
+    }
+
+    /**
+     * @brief Get the data window computed for the same x-axis range during this frame by another graph displaying the same data
+     *
+     * @param range Displayed x-axis range
+     * @param gapThreshold Gap detection threshold of the graph
+     * @param dataSize Destination of the number of samples to display
+     * @param dataOffset Destination of the offset of the first sample to display
+     * @return true Window found, visibleSegments is updated
+     * @return false Window must be computed, then shared with ShareWindow
+     */
+    bool FindSharedWindow(const ImPlotRange &range, float gapThreshold, size_t &dataSize, int32_t &dataOffset)
+    {
+        const DataWindowCache::Key key = {ImGui::GetFrameCount(), range.Min, range.Max, dataPeriodMs, gapThreshold};
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(*data, start, pushed);
+        return channel->window.Lookup(key, start, dataOffset, dataSize, visibleSegments);
+    }
+
+    /**
+     * @brief Share the data window computed for this frame with the other graphs displaying the same data
+     *
+     * @param range Displayed x-axis range
+     * @param gapThreshold Gap detection threshold of the graph
+     * @param dataSize Number of samples to display
+     * @param dataOffset Offset of the first sample to display
+     */
+    void ShareWindow(const ImPlotRange &range, float gapThreshold, size_t dataSize, int32_t dataOffset)
+    {
+        const DataWindowCache::Key key = {ImGui::GetFrameCount(), range.Min, range.Max, dataPeriodMs, gapThreshold};
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(*data, start, pushed);
+        channel->window.Store(key, start, dataOffset, dataSize, visibleSegments);
+    }
+
+    /**
+     * @brief Store the displayed window, used by the statistics of the visible samples
+     *
+     * @param offset Offset of the first displayed sample
+     * @param size Number of displayed samples
+     */
+    void SetWindow(int32_t offset, size_t size) noexcept
+    {
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(*data, start, pushed);
+        windowStart = start + (uint64_t)offset;
+        windowEnd = windowStart + (uint64_t)size;
+    }
+
+    /**
+     * @brief Get the statistics of the curve values. Samples appended since the last call are indexed first.
+     *
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return DataStats Statistics of the values
+     */
+    DataStats GetStats(bool visibleOnly)
+    {
+        channel->stats.Update(*data);
+        if (visibleOnly)
+        {
+            return channel->stats.GetStats(*data, windowStart, windowEnd);
+        }
+        return channel->stats.GetStats(*data, 0, UINT64_MAX);
+    }
+
+    /**
+     * @brief Get an approximate quantile of the curve values. Samples appended since the last call are indexed first.
+     *
+     * @param q Quantile, in [0;1]
+     * @param visibleOnly If true, only the samples displayed on last frame are considered
+     * @return double Quantile, NaN if there is no valid value
+     */
+    double GetQuantile(double q, bool visibleOnly)
+    {
+        channel->stats.Update(*data);
+        if (visibleOnly)
+        {
+            return channel->stats.GetQuantile(*data, q, windowStart, windowEnd);
+        }
+        return channel->stats.GetQuantile(*data, q, 0, UINT64_MAX);
+    }
+
+    /**
+     * @brief Compute the window of data to display using sample times instead of the data period.
+     * Used when samples are missing, as the period can't be used anymore to find sample offsets.
+     *
+     * @param range Displayed time range
+     * @param dataSize Number of samples to display
+     * @param dataOffset Offset of the first sample to display
+     */
+    void ComputeWindowByTime(const ImPlotRange &range, size_t &dataSize, int32_t &dataOffset) const
+    {
+        const int size = (int)data->size();
+        /* Keep one sample on each side so the curve reaches the plot borders */
+        int first = LowerBoundTime(range.Min) - 1;
+        int end = LowerBoundTime(range.Max) + 1;
+        if (first < 0)
+            first = 0;
+        if (end > size)
+            end = size;
+        dataOffset = first;
+        dataSize = (end > first) ? (size_t)(end - first) : 0;
+    }
+
+    static constexpr size_t RELATIVE_BATCH_SIZE = 1024; ///< Samples copied at once by ToRelativeWindow
+
+    /**
+     * @brief Convert the samples spanned by visibleSegments into relData, relative to origin. The samples are copied by
+     * batches of RELATIVE_BATCH_SIZE, with a single lock of a synchronized container each. The segment i starts at
+     * relData[visibleSegments[i].offset - visibleSegments[0].offset].
+     *
+     * @param origin Time subtracted from the samples time, see MBIPlotChart::SetupCurvesAxis
+     */
+    void ToRelativeWindow(double origin)
+    {
+        relData.resize(0);
+        if (visibleSegments.empty())
+        {
+            return;
+        }
+        const int first = visibleSegments.front().offset;
+        const size_t count = (size_t)(visibleSegments.back().offset + visibleSegments.back().size - first);
+        relData.resize((int)count);
+
+        /* Window offsets are relative to the oldest sample, copies use absolute indexes */
+        uint64_t start = 0;
+        uint64_t pushed = 0;
+        DataBounds(*data, start, pushed);
+        DataPoint batch[RELATIVE_BATCH_SIZE];
+        for (size_t done = 0; done < count;)
+        {
+            const uint64_t from = start + (uint64_t)first + done;
+            const size_t wanted = std::min(count - done, RELATIVE_BATCH_SIZE);
+            uint64_t copiedFirst = from;
+            const size_t copied = DataCopyRange(*data, from, wanted, batch, copiedFirst);
+            /* Samples overwritten since the window was computed are replaced by the oldest one copied */
+            const size_t skipped = (size_t)std::min<uint64_t>(copiedFirst - from, wanted);
+            for (size_t i = 0; i < wanted; i++)
+            {
+                const DataPoint point = (copied == 0) ? DataPoint(origin, NAN) : batch[std::min((i >= skipped) ? i - skipped : 0, copied - 1)];
+                relData[(int)(done + i)] = ImVec2((float)(point.m_time - origin), (float)point.m_data);
+            }
+            done += wanted;
+        }
+    }
+
+    /**
+     * @brief Convert the down sampled points dsData into relData, relative to origin
+     *
+     * @param origin Time subtracted from the points time, see MBIPlotChart::SetupCurvesAxis
+     */
+    void ToRelativeDownSampled(double origin)
+    {
+        relData.resize(dsData.Size);
+        for (int i = 0; i < dsData.Size; i++)
+        {
+            relData[i] = ImVec2((float)(dsData[i].m_time - origin), (float)dsData[i].m_data);
+        }
+    }
+
+    /**
+     * @brief Down sample data into dsData, reusing a previously computed result if the same view is in the cache.
+     * Each gap free segment of visibleSegments is down sampled separately, with a share of downSampleSize
+     * proportional to its length. Segments whose share is below 2 points are merged into the budget of the next ones,
+     * so the result never exceeds downSampleSize.
+     *
+     * @param start Offset of the data to display
+     * @param rawSamplesCount Total size of origin data samples
+     * @param downSampleSize Down sample size
+     * @param gapThreshold Gap detection threshold which computed visibleSegments
+     * @return int Size of dsData.
+     */
+    int DownSample(int start, int rawSamplesCount, int downSampleSize, float gapThreshold)
+    {
+        const DownSampleCache::Key key = {DataGeneration(*data), channel->edits, start, rawSamplesCount, downSampleSize, dataPeriodMs, gapThreshold};
+        if (channel->dsCache.Lookup(key, dsData, dsSegments) == false)
+        {
+            dsData.resize(0);
+            dsSegments.resize(0);
+            dsData.reserve(downSampleSize);
+            /* Budget accumulated over the segments, so many small segments share downSampleSize instead of each
+            taking a minimum */
+            double budget = 0.0;
+            for (const DataSegment &segment : visibleSegments)
+            {
+                budget += ((double)downSampleSize * segment.size) / rawSamplesCount;
+                const int segmentTarget = (budget < (double)segment.size) ? (int)budget : segment.size;
+                if (segmentTarget < 2)
+                {
+                    /* Sub pixel segment : left out until the accumulated budget can draw one */
+                    continue;
+                }
+                budget -= segmentTarget;
+
+                const int previousSize = dsData.Size;
+                if (segment.size <= segmentTarget || segmentTarget < 3)
+                {
+                    /* Whole segment, or only its ends when the budget is too small for LTTB */
+                    const int step = (segment.size <= segmentTarget) ? 1 : segment.size - 1;
+                    for (int i = 0; i < segment.size; i += step)
+                    {
+                        dsData.push_back(GetDataAt(segment.offset, i));
+                    }
+                }
+                else
+                {
+                    DownSampleLTTB(segment.offset, segment.size, segmentTarget);
+                }
+                dsSegments.push_back(dsData.Size - previousSize);
+            }
+            channel->dsCache.Store(key, dsData, dsSegments);
+        }
+        return dsData.Size;
+    }
+
+    /**
+     * @brief Apply LTTB down sampling algorithm to data and append the resulting sampled data to dsData.
+     * Taken from https://github.com/epezent/implot/pull/389/commits/cf3e4a76bd8fea7dd067e2acd591d2365edb3c0d
+     * slightly modified by me
+     *
+     * @warning The data range must not contain any gap (NaN), see DataGapIndex.
+     *
+     * @param start Offset of the data to display
+     * @param rawSamplesCount Total size of origin data samples
+     * @param downSampleSize Down sample size, at least 3
+     * @return int Number of samples appended to dsData.
+     */
+    int DownSampleLTTB(int start, int rawSamplesCount, int downSampleSize)
+    {
+        // Largest Triangle Three Buckets (LTTB) Downsampling Algorithm
+        //  "Downsampling time series for visual representation" by Sveinn Steinarsson.
+        //  https://skemman.is/bitstream/1946/15343/3/SS_MSthesis.pdf
+        //  https://github.com/sveinn-steinarsson/flot-downsample
+
+        /* Bucket size, first and last samples are kept */
+        const double every = ((double)(rawSamplesCount - 2)) / ((double)(downSampleSize - 2));
+        int aIndex = 0;
+
+        // fill first sample
+        dsData.push_back(GetDataAt(start, 0));
+        //   loop over samples
+        for (int i = 0; i < downSampleSize - 2; ++i)
+        {
+            /* Average of the next bucket */
+            int avgRangeStart = (int)((i + 1) * every) + 1;
+            int avgRangeEnd = (int)((i + 2) * every) + 1;
+            if (avgRangeEnd > rawSamplesCount)
+                avgRangeEnd = rawSamplesCount;
+
+            const int avgRangeLength = avgRangeEnd - avgRangeStart;
+            double avgX = 0.0;
+            double avgY = 0.0;
+            for (; avgRangeStart < avgRangeEnd; ++avgRangeStart)
+            {
+                const DataPoint sample = GetDataAt(start, avgRangeStart);
+                avgX += sample.m_time;
+                avgY += sample.m_data;
+            }
+            if (avgRangeLength > 0)
+            {
+                avgX /= (double)avgRangeLength;
+                avgY /= (double)avgRangeLength;
+            }
+            else
+            {
+                /* Last bucket : use the last sample */
+                const DataPoint sample = GetDataAt(start, rawSamplesCount - 1);
+                avgX = sample.m_time;
+                avgY = sample.m_data;
+            }
+
+            /* Current bucket */
+            int rangeOffs = (int)(i * every) + 1;
+            int rangeTo = (int)((i + 1) * every) + 1;
+            if (rangeTo > rawSamplesCount - 1)
+                rangeTo = rawSamplesCount - 1;
+            const DataPoint samplePrev = GetDataAt(start, aIndex);
+            double maxArea = -1.0;
+            int nextAIndex = rangeOffs;
+            for (; rangeOffs < rangeTo; ++rangeOffs)
+            {
+                const DataPoint sampleAtRangeOffs = GetDataAt(start, rangeOffs);
+                const double area = fabs((samplePrev.m_time - avgX) * (sampleAtRangeOffs.m_data - samplePrev.m_data) - (samplePrev.m_time - sampleAtRangeOffs.m_time) * (avgY - samplePrev.m_data)) / 2.0;
+                if (area > maxArea)
+                {
+                    maxArea = area;
+                    nextAIndex = rangeOffs;
+                }
+            }
+            dsData.push_back(GetDataAt(start, nextAIndex));
+            aIndex = nextAIndex;
+        }
+        // fill last sample
+        dsData.push_back(GetDataAt(start, rawSamplesCount - 1));
+        return downSampleSize;
+    }
+
+private:
+    inline const DataPoint &GetDataAt(int offset, int idx) const
+    {
+        return (*data)[offset + idx];
+    }
+
+    /**
+     * @brief Binary search of the first sample at or after the given time
+     *
+     * @param time Time to look for
+     * @return int Offset of the sample
+     */
+    int LowerBoundTime(double time) const
+    {
+        int lo = 0;
+        int hi = (int)data->size();
+        while (lo < hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            if ((*data)[mid].m_time < time)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+};
+
+/**
+ * @brief Sum the down sampling cache counters of the variables of a graph
+ *
+ * @param renders Variables of the graph
+ * @return DownSampleCacheStats Cache hits and misses
+ */
+template <typename Renders>
+DownSampleCacheStats SumDownSampleCacheStats(const Renders &renders) noexcept
+{
+    DownSampleCacheStats stats;
+    for (const auto &render : renders)
+    {
+        stats.hits += render.channel->dsCache.GetStats().hits;
+        stats.misses += render.channel->dsCache.GetStats().misses;
+    }
+    return stats;
+}
+
+template <typename Render, typename Annotations>
+void MBIPlotChart::DisplayAnnotations(Render &render, const Annotations &annotations)
+{
+    render.annotIndex.Update(annotations);
+
+    const float spacing = m_annotSpacing;
+    auto nextX = [spacing](double x)
+    {
+        const ImVec2 pixels = ImPlot::PlotToPixels(x, 0.0);
+        return ImPlot::PixelsToPlot(pixels.x + spacing, pixels.y).x;
+    };
+    render.annotIndex.GetClusters(m_xAxisRange.Min, m_xAxisRange.Max, nextX, render.annotClusters);
+
+    for (const AnnotationCluster &cluster : render.annotClusters)
+    {
+        /* Copied under the container lock, skipped if overwritten since the index update */
+        std::decay_t<decltype(annotations[0])> annot;
+        uint64_t copied;
+        if (DataCopyRange(annotations, cluster.index, 1, &annot, copied) == 0 || copied != cluster.index)
+        {
+            continue;
+        }
+        if (cluster.count == 1)
+        {
+            ImPlot::Annotation(annot.m_x, annot.m_y, annot.GetColor(), ImVec2(5, -5), false, "%s", annot.GetLabel());
+        }
+        else
+        {
+            ImPlot::Annotation(annot.m_x, annot.m_y, annot.GetColor(), ImVec2(5, -5), false, "%d events", cluster.count);
+        }
+    }
+}
+
+template <typename Renders>
+void MBIPlotChart::SetupYAxes(Renders &renders)
+{
+    if (m_axesDirty)
+    {
+        m_axesCount = 0;
+        for (auto &render : renders)
+        {
+            if (render.descriptor.bOnGraph)
+            {
+                render.descriptor.axis = AssignYAxis(render.descriptor.unit);
+            }
+        }
+        m_axesDirty = false;
+    }
+    for (int i = 0; i < m_axesCount; i++)
+    {
+        ImPlot::SetupAxis(ImAxis_Y1 + i, m_axesLabel[i].c_str());
+    }
+    if (m_yAutoFit)
+    {
+        /* Union of the values displayed on last frame on each axis */
+        DataStats axesStats[3];
+        for (auto &render : renders)
+        {
+            if (render.descriptor.bOnGraph && render.data->empty() == false)
+            {
+                axesStats[render.descriptor.axis - ImAxis_Y1].Merge(render.GetStats(true));
+            }
+        }
+        for (int i = 0; i < m_axesCount; i++)
+        {
+            if (axesStats[i].count > 0)
+            {
+                const double range = axesStats[i].max - axesStats[i].min;
+                const double margin = (range > 0.0) ? (range * 0.05) : ((std::abs(axesStats[i].max) > 0.0) ? (std::abs(axesStats[i].max) * 0.05) : 0.5);
+                ImPlot::SetupAxisLimits(ImAxis_Y1 + i, axesStats[i].min - margin, axesStats[i].max + margin, ImGuiCond_Always);
+            }
+        }
+    }
+}
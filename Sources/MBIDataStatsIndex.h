@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include "MBIDataAccess.h"
+
+/**
+ * @brief Incremental statistics of a curve values, queried on any range of samples without a full scan.
+ *
+ * Samples are grouped by blocks of BLOCK_SIZE consecutive absolute indexes. Each complete block keeps its statistics
+ * and a quantile sketch (SKETCH_SIZE evenly spaced values of the sorted block). A range query merges the blocks it
+ * fully covers and only reads the samples of the partially covered blocks at its ends, so its cost is
+ * O(range / BLOCK_SIZE + BLOCK_SIZE). Blocks evicted from a circular buffer are dropped with it.
+ *
+ */
+class DataStatsIndex
+{
+public:
+    static constexpr uint64_t BLOCK_SIZE = 256;            ///< Number of samples per block
+    static constexpr int SKETCH_SIZE = 16;                 ///< Number of sketch values per block
+    static constexpr uint64_t MAX_UPDATE_SAMPLES = 1 << 22; ///< Maximum number of samples indexed per update, so a large data set is indexed over several frames
+
+    DataStatsIndex() noexcept : m_firstBlock(0), m_start(0), m_indexed(0) {}
+
+    /**
+     * @brief Index the samples appended since the last update and forget the evicted blocks.
+     *
+     * @param data Data container
+     */
+    template <typename Container>
+    void Update(const Container &data)
+    {
+        uint64_t start;
+        uint64_t pushed;
+        DataBounds(data, start, pushed);
+
+        /* Data container has been cleared : restart indexing */
+        if (pushed < m_indexed)
+        {
+            Clear();
+        }
+        /* Samples overwritten before being indexed : the partial block can't be completed */
+        if (m_indexed < start)
+        {
+            m_current = Block();
+            m_currentValues.clear();
+            m_indexed = start;
+        }
+        m_start = start;
+
+        /* Forget evicted blocks */
+        while (!m_blocks.empty() && (m_firstBlock + 1) * BLOCK_SIZE <= start)
+        {
+            m_blocks.pop_front();
+            m_firstBlock++;
+        }
+
+        const uint64_t end = (pushed - m_indexed > MAX_UPDATE_SAMPLES) ? (m_indexed + MAX_UPDATE_SAMPLES) : pushed;
+        uint64_t expected = m_indexed;
+        ReadValues(data, m_indexed, end, [this, &expected](uint64_t index, double value)
+                   {
+                       /* Samples overwritten while reading : the partial block can't be completed */
+                       if (index != expected)
+                       {
+                           m_current = Block();
+                           m_currentValues.clear();
+                       }
+                       expected = index + 1;
+                       m_current.stats.Add(value);
+                       if (!std::isnan(value))
+                       {
+                           m_currentValues.push_back(value);
+                       }
+                       /* Block complete */
+                       if ((index + 1) % BLOCK_SIZE == 0)
+                       {
+                           CloseBlock(index / BLOCK_SIZE);
+                       } });
+        m_indexed = end;
+    }
+
+    /**
+     * @brief Get the statistics of a range of samples
+     *
+     * @param data Data container, Update must have been called first
+     * @param first Absolute index of the first sample
+     * @param end Absolute index after the last sample
+     * @return DataStats Statistics of the indexed samples of the range
+     */
+    template <typename Container>
+    DataStats GetStats(const Container &data, uint64_t first, uint64_t end)
+    {
+        DataStats stats;
+        ForEachPart(data, first, end, [&stats](const Block &block)
+                    { stats.Merge(block.stats); },
+                    [&stats](double value)
+                    { stats.Add(value); });
+        return stats;
+    }
+
+    /**
+     * @brief Get an approximate quantile of a range of samples. Error is bounded by the spread of one sketch step of the blocks.
+     *
+     * @param data Data container, Update must have been called first
+     * @param q Quantile, in [0;1] (0.5 for the median)
+     * @param first Absolute index of the first sample
+     * @param end Absolute index after the last sample
+     * @return double Quantile, NaN if the range has no valid value
+     */
+    template <typename Container>
+    double GetQuantile(const Container &data, double q, uint64_t first, uint64_t end)
+    {
+        /* Weighted values : sketch values of the complete blocks, raw values at the ends of the range */
+        m_weighted.clear();
+        ForEachPart(data, first, end, [this](const Block &block)
+                    {
+                        /* Blocks without valid value have a NaN sketch, NaN would break the sort */
+                        if (block.stats.count == 0)
+                        {
+                            return;
+                        }
+                        const double weight = (double)block.stats.count / (double)SKETCH_SIZE;
+                        for (const double value : block.sketch)
+                        {
+                            if (!std::isnan(value))
+                            {
+                                m_weighted.push_back({value, weight});
+                            }
+                        } },
+                    [this](double value)
+                    {
+                        if (!std::isnan(value))
+                        {
+                            m_weighted.push_back({value, 1.0});
+                        } });
+        if (m_weighted.empty())
+        {
+            return NAN;
+        }
+        std::sort(m_weighted.begin(), m_weighted.end(), [](const WeightedValue &a, const WeightedValue &b)
+                  { return a.value < b.value; });
+        double total = 0.0;
+        for (const WeightedValue &weighted : m_weighted)
+        {
+            total += weighted.weight;
+        }
+        const double target = std::clamp(q, 0.0, 1.0) * total;
+        double cumulated = 0.0;
+        for (const WeightedValue &weighted : m_weighted)
+        {
+            cumulated += weighted.weight;
+            if (cumulated >= target)
+            {
+                return weighted.value;
+            }
+        }
+        return m_weighted.back().value;
+    }
+
+    /**
+     * @brief Get the absolute index of the first sample of the container
+     *
+     * @return uint64_t Absolute index
+     */
+    uint64_t GetStart() const noexcept
+    {
+        return m_start;
+    }
+
+    /**
+     * @brief Get the absolute index after the last indexed sample
+     *
+     * @return uint64_t Absolute index
+     */
+    uint64_t GetIndexed() const noexcept
+    {
+        return m_indexed;
+    }
+
+    /**
+     * @brief Reset the index
+     *
+     */
+    void Clear() noexcept
+    {
+        m_blocks.clear();
+        m_firstBlock = 0;
+        m_current = Block();
+        m_currentValues.clear();
+        m_start = 0;
+        m_indexed = 0;
+    }
+
+private:
+    /**
+     * @brief Statistics of a block of samples
+     *
+     */
+    struct Block
+    {
+        DataStats stats;             ///< Statistics of the block
+        double sketch[SKETCH_SIZE];  ///< Evenly spaced values of the sorted block
+    };
+
+    /**
+     * @brief Value with a weight, for quantile computation
+     *
+     */
+    struct WeightedValue
+    {
+        double value;
+        double weight;
+    };
+
+    std::deque<Block> m_blocks;                ///< Complete blocks, m_blocks[i] covers the block m_firstBlock + i
+    uint64_t m_firstBlock;                     ///< Block number of m_blocks.front()
+    Block m_current;                           ///< Statistics of the block being filled
+    std::vector<double> m_currentValues;       ///< Valid values of the block being filled, to build its sketch
+    uint64_t m_start;                          ///< Absolute index of the first sample of the container
+    uint64_t m_indexed;                        ///< Absolute index of the next sample to index
+    std::vector<WeightedValue> m_weighted;     ///< Scratch buffer of GetQuantile
+
+    /**
+     * @brief Store the block being filled
+     *
+     * @param blockNumber Number of the block (absolute index / BLOCK_SIZE)
+     */
+    void CloseBlock(uint64_t blockNumber)
+    {
+        if (m_blocks.empty() || m_firstBlock + m_blocks.size() != blockNumber)
+        {
+            m_blocks.clear();
+            m_firstBlock = blockNumber;
+        }
+        std::sort(m_currentValues.begin(), m_currentValues.end());
+        for (int i = 0; i < SKETCH_SIZE; i++)
+        {
+            m_current.sketch[i] = m_currentValues.empty() ? NAN : m_currentValues[((size_t)i * 2 + 1) * m_currentValues.size() / (2 * SKETCH_SIZE)];
+        }
+        m_blocks.push_back(m_current);
+        m_current = Block();
+        m_currentValues.clear();
+    }
+
+    /**
+     * @brief Read the values of a range of samples, by batches
+     *
+     * @param data Data container
+     * @param first Absolute index of the first sample
+     * @param end Absolute index after the last sample
+     * @param onValue Function called with the absolute index and the value of each sample. Samples overwritten
+     * during the read are skipped.
+     */
+    template <typename Container, typename Callback>
+    void ReadValues(const Container &data, uint64_t first, uint64_t end, Callback &&onValue) const
+    {
+        static constexpr uint64_t BATCH_SIZE = 256;
+        DataPoint batch[BATCH_SIZE];
+        uint64_t index = first;
+        while (index < end)
+        {
+            uint64_t copied;
+            const size_t count = DataCopyRange(data, index, (size_t)std::min(end - index, BATCH_SIZE), batch, copied);
+            if (count == 0)
+            {
+                break;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                onValue(copied + i, batch[i].m_data);
+            }
+            index = copied + count;
+        }
+    }
+
+    /**
+     * @brief Split a range into the complete blocks it fully covers and the samples at its ends
+     *
+     * @param onBlock Function called for each fully covered block
+     * @param onValue Function called for each value outside the fully covered blocks
+     */
+    template <typename Container, typename BlockCallback, typename ValueCallback>
+    void ForEachPart(const Container &data, uint64_t first, uint64_t end, BlockCallback &&onBlock, ValueCallback &&onValue) const
+    {
+        if (first < m_start)
+            first = m_start;
+        if (end > m_indexed)
+            end = m_indexed;
+        if (first >= end)
+            return;
+
+        /* Complete blocks fully inside the range */
+        uint64_t blockFirst = (first + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        uint64_t blockEnd = end / BLOCK_SIZE;
+        if (blockFirst < m_firstBlock)
+            blockFirst = m_firstBlock;
+        if (blockEnd > m_firstBlock + m_blocks.size())
+            blockEnd = m_firstBlock + m_blocks.size();
+        if (blockFirst >= blockEnd)
+        {
+            ReadValues(data, first, end, [&onValue](uint64_t, double value)
+                       { onValue(value); });
+            return;
+        }
+        ReadValues(data, first, blockFirst * BLOCK_SIZE, [&onValue](uint64_t, double value)
+                   { onValue(value); });
+        for (uint64_t block = blockFirst; block < blockEnd; block++)
+        {
+            onBlock(m_blocks[(size_t)(block - m_firstBlock)]);
+        }
+        ReadValues(data, blockEnd * BLOCK_SIZE, end, [&onValue](uint64_t, double value)
+                   { onValue(value); });
+    }
+};
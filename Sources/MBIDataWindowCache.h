@@ -0,0 +1,111 @@
+#pragma once
+
+#include "MBIDataGapIndex.h"
+
+/**
+ * @brief Data window (displayed samples and their gap free segments) computed for an x-axis range during a frame.
+ * Charts displaying the same data on the same range (see MBIChartLinkGroup) reuse the window computed by the first
+ * of them instead of computing it again.
+ *
+ */
+class DataWindowCache
+{
+public:
+    /**
+     * @brief Identify a data window
+     *
+     */
+    struct Key
+    {
+        int frame;          ///< ImGui frame of the computation
+        double xMin;        ///< Minimum of the x-axis range
+        double xMax;        ///< Maximum of the x-axis range
+        uint32_t periodMs;  ///< Data period used for the computation
+        float gapThreshold; ///< Gap detection threshold used for the computation
+
+        bool operator==(const Key &other) const noexcept
+        {
+            return frame == other.frame && xMin == other.xMin && xMax == other.xMax && periodMs == other.periodMs && gapThreshold == other.gapThreshold;
+        }
+    };
+
+    DataWindowCache() noexcept : m_key{-1, 0.0, 0.0, 0, 0.0f}, m_start(0), m_offset(0), m_size(0) {}
+
+    /**
+     * @brief Look for the window and copy it if found. Samples evicted from a circular buffer since the
+     * computation are removed from the window.
+     *
+     * @param key Window to look for
+     * @param start Absolute index of the first sample of the data (pushed - size)
+     * @param offset Destination of the offset of the first displayed sample
+     * @param size Destination of the number of displayed samples
+     * @param segments Destination of the gap free segments of the window
+     * @return true The window was computed during this frame
+     * @return false The window must be computed
+     */
+    bool Lookup(const Key &key, uint64_t start, int32_t &offset, size_t &size, ImVector<DataSegment> &segments)
+    {
+        if (!(m_key == key) || start < m_start)
+        {
+            return false;
+        }
+        const int shift = (int)(start - m_start);
+        offset = m_offset - shift;
+        int windowSize = (int)m_size;
+        if (offset < 0)
+        {
+            windowSize += offset;
+            offset = 0;
+        }
+        size = (windowSize > 0) ? (size_t)windowSize : 0;
+        segments.clear();
+        for (const DataSegment &segment : m_segments)
+        {
+            DataSegment shifted = {segment.offset - shift, segment.size};
+            if (shifted.offset < 0)
+            {
+                shifted.size += shifted.offset;
+                shifted.offset = 0;
+            }
+            if (shifted.size > 0)
+            {
+                segments.push_back(shifted);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Store a computed window
+     *
+     * @param key Window computed
+     * @param start Absolute index of the first sample of the data (pushed - size)
+     * @param offset Offset of the first displayed sample
+     * @param size Number of displayed samples
+     * @param segments Gap free segments of the window
+     */
+    void Store(const Key &key, uint64_t start, int32_t offset, size_t size, const ImVector<DataSegment> &segments)
+    {
+        m_key = key;
+        m_start = start;
+        m_offset = offset;
+        m_size = size;
+        m_segments = segments;
+    }
+
+    /**
+     * @brief Invalidate the stored window
+     *
+     */
+    void Clear() noexcept
+    {
+        m_key.frame = -1;
+    }
+
+private:
+    Key m_key;                         ///< Stored window
+    uint64_t m_start;                  ///< Absolute index of the first sample of the data at computation
+    int32_t m_offset;                  ///< Offset of the first displayed sample
+    size_t m_size;                     ///< Number of displayed samples
+    ImVector<DataSegment> m_segments;  ///< Gap free segments of the window
+};
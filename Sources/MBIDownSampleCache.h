@@ -0,0 +1,130 @@
+#pragma once
+
+#include "MBIPlotChart.h"
+
+/**
+ * @brief Small LRU cache of down sampled data. Results are keyed by the data generation and the requested view
+ * (offset, size and target size), so going back to a previously displayed view doesn't recompute the down sampling.
+ *
+ */
+class DownSampleCache
+{
+public:
+    static constexpr int CACHE_SIZE = 8; ///< Number of down sampled views kept per channel, shared by all graphs displaying it
+
+    /**
+     * @brief Identify a down sampled view
+     *
+     */
+    struct Key
+    {
+        uint64_t generation; ///< Generation of the data when the view was computed
+        uint64_t edits;      ///< In-place modifications of the data when the view was computed, see DataChannel::edits
+        int offset;          ///< Offset of the first raw sample
+        int size;            ///< Number of raw samples
+        int target;          ///< Down sample size
+        uint32_t periodMs;   ///< Data period of the gap detection which split the view into segments
+        float gapThreshold;  ///< Threshold of the gap detection which split the view into segments
+
+        bool operator==(const Key &other) const noexcept
+        {
+            return generation == other.generation && edits == other.edits && offset == other.offset && size == other.size && target == other.target &&
+                   periodMs == other.periodMs && gapThreshold == other.gapThreshold;
+        }
+    };
+
+    DownSampleCache() noexcept : m_tick(0) {}
+
+    /**
+     * @brief Look for a view in the cache and copy it into dsData if found.
+     *
+     * @param key View to look for
+     * @param dsData Destination of the cached down sampled data
+     * @param dsSegments Destination of the cached gap free segments sizes
+     * @return true The view was in the cache
+     * @return false The view must be computed
+     */
+    bool Lookup(const Key &key, ImVector<DataPoint> &dsData, ImVector<int> &dsSegments) noexcept
+    {
+        for (Entry &entry : m_entries)
+        {
+            if (entry.valid && entry.key == key)
+            {
+                entry.lastUse = ++m_tick;
+                dsData = entry.data;
+                dsSegments = entry.segments;
+                m_stats.hits++;
+                return true;
+            }
+        }
+        m_stats.misses++;
+        return false;
+    }
+
+    /**
+     * @brief Store a computed view in the cache, replacing the least recently used one.
+     *
+     * @param key View computed
+     * @param dsData Down sampled data of the view
+     * @param dsSegments Sizes of the gap free segments of dsData
+     */
+    void Store(const Key &key, const ImVector<DataPoint> &dsData, const ImVector<int> &dsSegments)
+    {
+        Entry *lru = &m_entries[0];
+        for (Entry &entry : m_entries)
+        {
+            if (entry.valid == false)
+            {
+                lru = &entry;
+                break;
+            }
+            if (entry.lastUse < lru->lastUse)
+            {
+                lru = &entry;
+            }
+        }
+        lru->key = key;
+        lru->data = dsData;
+        lru->segments = dsSegments;
+        lru->lastUse = ++m_tick;
+        lru->valid = true;
+    }
+
+    /**
+     * @brief Invalidate all cached views
+     *
+     */
+    void Clear() noexcept
+    {
+        for (Entry &entry : m_entries)
+        {
+            entry.valid = false;
+        }
+    }
+
+    /**
+     * @brief Get the hit and miss counters of the cache
+     *
+     * @return const DownSampleCacheStats& Cache counters
+     */
+    const DownSampleCacheStats &GetStats() const noexcept
+    {
+        return m_stats;
+    }
+
+private:
+    struct Entry
+    {
+        Key key;
+        uint64_t lastUse;
+        bool valid;
+        ImVector<DataPoint> data;
+        ImVector<int> segments;
+
+        Entry() noexcept : key{0, 0, 0, 0}, lastUse(0), valid(false) {}
+    };
+
+    Entry m_entries[CACHE_SIZE];  ///< Cached views
+    uint64_t m_tick;              ///< Usage counter for LRU replacement
+    DownSampleCacheStats m_stats; ///< Hit and miss counters
+};
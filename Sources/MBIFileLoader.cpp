@@ -0,0 +1,490 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#include "MBIMGUI.h"
+#include "MBICaptureFile.h"
+#include "MBIFileLoader.h"
+
+/* Use anonymous namespace to hide parsing functions from users */
+namespace
+{
+    constexpr size_t MIN_LINES_PER_THREAD = 64 * 1024;     ///< Minimum size in bytes of the part of a chunk parsed by one thread
+    constexpr size_t MAX_PARSE_THREADS = 8;                ///< Maximum number of threads parsing a chunk
+    constexpr size_t CAPTURE_SAMPLES_PER_CHUNK = 1 << 20; ///< Number of samples copied per chunk from a capture file
+
+    /**
+     * @brief Remove spaces and carriage return around a field
+     *
+     */
+    std::string_view Trim(std::string_view field) noexcept
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t' || field.front() == '\r'))
+        {
+            field.remove_prefix(1);
+        }
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r'))
+        {
+            field.remove_suffix(1);
+        }
+        return field;
+    }
+
+    /**
+     * @brief Parse a numeric field
+     *
+     * @param field Field to parse
+     * @param value Parsed value, NaN if the field is empty or not a number
+     * @return true The field is a number
+     */
+    bool ParseDouble(std::string_view field, double &value) noexcept
+    {
+        field = Trim(field);
+        if (!field.empty() && field.front() == '+')
+        {
+            field.remove_prefix(1);
+        }
+        const auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (field.empty() || result.ec != std::errc() || result.ptr != field.data() + field.size())
+        {
+            value = std::numeric_limits<double>::quiet_NaN();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the next field of a line
+     *
+     * @param line Remaining part of the line, the field and its separator are removed
+     * @param sep Separator
+     * @return std::string_view Field
+     */
+    std::string_view NextField(std::string_view &line, char sep) noexcept
+    {
+        const size_t pos = line.find(sep);
+        const std::string_view field = line.substr(0, pos);
+        line = (pos == std::string_view::npos) ? std::string_view() : line.substr(pos + 1);
+        return field;
+    }
+
+    /**
+     * @brief Parse CSV lines. Lines whose time field isn't a number are skipped.
+     *
+     * @param text Lines to parse
+     * @param sep Separator
+     * @param columns Parsed samples, one vector per column
+     */
+    void ParseLines(std::string_view text, char sep, std::vector<std::vector<DataPoint>> &columns)
+    {
+        /* Reserve from a rough line count so vectors don't grow by steps */
+        const size_t lines = (size_t)std::count(text.begin(), text.end(), '\n') + 1;
+        for (std::vector<DataPoint> &column : columns)
+        {
+            column.reserve(lines);
+        }
+
+        while (!text.empty())
+        {
+            std::string_view line = NextField(text, '\n');
+            double time;
+            if (ParseDouble(NextField(line, sep), time) == false)
+            {
+                continue;
+            }
+            for (std::vector<DataPoint> &column : columns)
+            {
+                double value = std::numeric_limits<double>::quiet_NaN();
+                if (!line.empty())
+                {
+                    ParseDouble(NextField(line, sep), value);
+                }
+                column.emplace_back(time, value);
+            }
+        }
+    }
+}
+
+MBIMGUI::MBIFileLoader::MBIFileLoader() noexcept : m_readyCb(nullptr),
+                                                   m_readyCbArg(nullptr),
+                                                   m_ready(false),
+                                                   m_state(LOADER_IDLE),
+                                                   m_loaded(0),
+                                                   m_total(0),
+                                                   m_cancel(false),
+                                                   m_columnsKnown(false),
+                                                   m_finished(false),
+                                                   m_result(LOADER_IDLE)
+{
+}
+
+MBIMGUI::MBIFileLoader::~MBIFileLoader()
+{
+    Stop();
+}
+
+void MBIMGUI::MBIFileLoader::Start(const std::filesystem::path &path, MBILoaderReadyCb readyCb, void *arg)
+{
+    Stop();
+
+    m_path = path;
+    m_readyCb = readyCb;
+    m_readyCbArg = arg;
+    m_ready = false;
+    m_data.clear();
+    m_columns.clear();
+    m_chunks.clear();
+    m_columnsKnown = false;
+    m_finished = false;
+    m_loaded = 0;
+    m_total = 0;
+    m_cancel = false;
+    m_state = LOADER_RUNNING;
+    m_thread = std::thread(&MBIFileLoader::LoadThread, this);
+}
+
+void MBIMGUI::MBIFileLoader::Cancel() noexcept
+{
+    {
+        /* Set under the lock, so a worker between its predicate check and its wait doesn't miss the wakeup */
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = true;
+    }
+    m_cv.notify_all();
+}
+
+void MBIMGUI::MBIFileLoader::Stop() noexcept
+{
+    Cancel();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void MBIMGUI::MBIFileLoader::Update()
+{
+    std::deque<ParsedChunk> chunks;
+    bool columnsKnown;
+    bool finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        columnsKnown = m_columnsKnown;
+        if (columnsKnown && !m_ready)
+        {
+            /* Columns containers must exist before the user creates variables on them */
+            for (size_t i = 0; i < m_columns.size(); i++)
+            {
+                m_data.push_back(std::make_unique<MBIPlotChart::DataContainer>());
+            }
+        }
+        for (size_t i = 0; i < MAX_CHUNKS_PER_FRAME && !m_chunks.empty(); i++)
+        {
+            chunks.push_back(std::move(m_chunks.front()));
+            m_chunks.pop_front();
+        }
+        finished = m_finished && m_chunks.empty();
+    }
+    m_cv.notify_all();
+
+    if (columnsKnown && !m_ready)
+    {
+        m_ready = true;
+        if (m_readyCb)
+        {
+            m_readyCb(m_readyCbArg, *this);
+        }
+    }
+
+    /* Append on the UI thread : graphs read the containers while displaying, in the same thread */
+    for (const ParsedChunk &chunk : chunks)
+    {
+        for (size_t c = 0; c < chunk.columns.size() && c < m_data.size(); c++)
+        {
+            MBIPlotChart::DataContainer &data = *m_data[c];
+            const std::vector<DataPoint> &samples = chunk.columns[c];
+            if (samples.empty())
+            {
+                continue;
+            }
+            data.reserve(data._grow_capacity(data.Size + (int)samples.size()));
+            memcpy(data.Data + data.Size, samples.data(), samples.size() * sizeof(DataPoint));
+            data.Size += (int)samples.size();
+        }
+    }
+
+    if (finished && m_thread.joinable())
+    {
+        m_thread.join();
+        m_state = m_result;
+    }
+}
+
+void MBIMGUI::MBIFileLoader::DisplayProgress(const char *label)
+{
+    if (m_state != LOADER_RUNNING)
+    {
+        return;
+    }
+    ImGui::PushID(label);
+    ImGui::DoubleCircularSpinner("##spinner");
+    ImGui::SameLine();
+    const std::string overlay = m_path.filename().string() + " " + std::to_string((int)(GetProgress() * 100.0f)) + "%";
+    ImGui::ProgressBar(GetProgress(), ImVec2(ImGui::GetFontSize() * 15, 0), overlay.c_str());
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Cancel"))
+    {
+        Cancel();
+    }
+    ImGui::PopID();
+}
+
+MBIMGUI::MBILoaderState MBIMGUI::MBIFileLoader::GetState() const noexcept
+{
+    return m_state;
+}
+
+float MBIMGUI::MBIFileLoader::GetProgress() const noexcept
+{
+    const uint64_t total = m_total;
+    return (total == 0) ? 0.0f : (float)((double)m_loaded / (double)total);
+}
+
+const std::filesystem::path &MBIMGUI::MBIFileLoader::GetPath() const noexcept
+{
+    return m_path;
+}
+
+size_t MBIMGUI::MBIFileLoader::GetColumnCount() const noexcept
+{
+    return m_data.size();
+}
+
+const MBIPlotChart::DataContainer *MBIMGUI::MBIFileLoader::GetColumn(size_t column) const
+{
+    return m_data.at(column).get();
+}
+
+const std::string &MBIMGUI::MBIFileLoader::GetColumnName(size_t column) const
+{
+    return m_columns.at(column).name;
+}
+
+uint32_t MBIMGUI::MBIFileLoader::GetColumnPeriod(size_t column) const
+{
+    return m_columns.at(column).periodMs;
+}
+
+void MBIMGUI::MBIFileLoader::LoadThread()
+{
+    std::error_code ec;
+    bool success;
+
+    m_total = std::filesystem::file_size(m_path, ec);
+    if (ec)
+    {
+        GetLogger().Log(LOG_LEVEL_ERROR, "Can't load %s : %s", m_path.string().c_str(), ec.message().c_str());
+        success = false;
+    }
+    else
+    {
+        char magic[sizeof(MBICaptureFile::MAGIC)] = {0};
+        std::ifstream(m_path, std::ios::binary).read(magic, sizeof(magic));
+        const bool isCapture = (memcmp(magic, MBICaptureFile::MAGIC, sizeof(magic)) == 0);
+        success = isCapture ? LoadCapture() : LoadCSV();
+    }
+
+    if (m_cancel)
+    {
+        GetLogger().Log(LOG_LEVEL_INFO, "Loading of %s cancelled", m_path.string().c_str());
+    }
+    /* State is published by Update once the pending chunks are appended */
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_result = m_cancel ? LOADER_CANCELLED : (success ? LOADER_DONE : LOADER_ERROR);
+    m_finished = true;
+}
+
+bool MBIMGUI::MBIFileLoader::LoadCSV()
+{
+    std::ifstream file(m_path, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        GetLogger().Log(LOG_LEVEL_ERROR, "Can't open %s", m_path.string().c_str());
+        return false;
+    }
+
+    /* First line gives the separator, the number of columns and, if its time field isn't a number, their names */
+    std::string firstLine;
+    std::getline(file, firstLine);
+    const std::string_view first = Trim(firstLine);
+    char sep = ',';
+    for (const char candidate : {';', '\t', ','})
+    {
+        if (first.find(candidate) != std::string_view::npos)
+        {
+            sep = candidate;
+            break;
+        }
+    }
+    std::string_view fields = first;
+    double time;
+    const bool header = (ParseDouble(NextField(fields, sep), time) == false);
+    std::vector<ColumnInfo> columns;
+    while (!fields.empty())
+    {
+        const std::string_view name = Trim(NextField(fields, sep));
+        columns.push_back({(header && !name.empty()) ? std::string(name) : "Column " + std::to_string(columns.size() + 1), 0});
+    }
+    if (columns.empty())
+    {
+        GetLogger().Log(LOG_LEVEL_ERROR, "Can't load %s : no data column", m_path.string().c_str());
+        return false;
+    }
+    const size_t columnCount = columns.size();
+    SetColumns(std::move(columns));
+    if (header)
+    {
+        m_loaded = firstLine.size() + 1;
+    }
+    else
+    {
+        file.seekg(0);
+    }
+
+    /* Read by chunks, the incomplete last line of a chunk is carried to the next one */
+    std::string buffer;
+    size_t carry = 0;
+    while (!m_cancel)
+    {
+        buffer.resize(carry + CHUNK_SIZE);
+        file.read(buffer.data() + carry, CHUNK_SIZE);
+        const size_t read = (size_t)file.gcount();
+        m_loaded += read;
+        const bool eof = (read < CHUNK_SIZE);
+        buffer.resize(carry + read);
+
+        const size_t lastLine = buffer.rfind('\n');
+        const size_t end = (eof || lastLine == std::string::npos) ? buffer.size() : lastLine + 1;
+        const std::string_view text(buffer.data(), end);
+
+        /* Split the chunk on line boundaries, one part per thread */
+        const size_t threadCount = std::clamp<size_t>(text.size() / MIN_LINES_PER_THREAD, 1, std::min<size_t>(MAX_PARSE_THREADS, std::max(1u, std::thread::hardware_concurrency())));
+        std::vector<std::vector<std::vector<DataPoint>>> parts(threadCount, std::vector<std::vector<DataPoint>>(columnCount));
+        std::vector<std::thread> parsers;
+        size_t partStart = 0;
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            size_t partEnd = (t == threadCount - 1) ? text.size() : text.find('\n', std::max(partStart, text.size() * (t + 1) / threadCount));
+            partEnd = (partEnd == std::string_view::npos) ? text.size() : std::min(partEnd + 1, text.size());
+            const std::string_view part = text.substr(partStart, partEnd - partStart);
+            if (t == threadCount - 1)
+            {
+                ParseLines(part, sep, parts[t]);
+            }
+            else
+            {
+                parsers.emplace_back(ParseLines, part, sep, std::ref(parts[t]));
+            }
+            partStart = partEnd;
+        }
+        for (std::thread &parser : parsers)
+        {
+            parser.join();
+        }
+
+        /* Parts are merged in file order */
+        ParsedChunk chunk;
+        chunk.columns.resize(columnCount);
+        for (size_t c = 0; c < columnCount; c++)
+        {
+            size_t count = 0;
+            for (const auto &part : parts)
+            {
+                count += part[c].size();
+            }
+            chunk.columns[c].reserve(count);
+            for (const auto &part : parts)
+            {
+                chunk.columns[c].insert(chunk.columns[c].end(), part[c].begin(), part[c].end());
+            }
+        }
+        if (PushChunk(std::move(chunk)) == false)
+        {
+            break;
+        }
+        if (eof)
+        {
+            break;
+        }
+        buffer.erase(0, end);
+        carry = buffer.size();
+    }
+    if (!m_cancel)
+    {
+        m_loaded = m_total.load();
+    }
+    return true;
+}
+
+bool MBIMGUI::MBIFileLoader::LoadCapture()
+{
+    MBICaptureFile capture;
+    if (capture.Open(m_path) == false)
+    {
+        return false;
+    }
+
+    std::vector<ColumnInfo> columns;
+    uint64_t samples = 0;
+    for (size_t c = 0; c < capture.GetChannelCount(); c++)
+    {
+        columns.push_back({std::string(capture.GetChannelName(c)), capture.GetChannelPeriod(c)});
+        samples += (uint64_t)capture.GetChannel(c)->Size;
+    }
+    SetColumns(std::move(columns));
+    m_loaded = 0;
+    m_total = samples;
+
+    /* Copy channels by blocks of samples, pages are read by the OS as they are accessed */
+    for (size_t c = 0; c < capture.GetChannelCount() && !m_cancel; c++)
+    {
+        const ImVector<DataPoint> &channel = *capture.GetChannel(c);
+        for (int first = 0; first < channel.Size && !m_cancel; first += (int)CAPTURE_SAMPLES_PER_CHUNK)
+        {
+            const int count = std::min(channel.Size - first, (int)CAPTURE_SAMPLES_PER_CHUNK);
+            ParsedChunk chunk;
+            chunk.columns.resize(capture.GetChannelCount());
+            chunk.columns[c].assign(channel.Data + first, channel.Data + first + count);
+            if (PushChunk(std::move(chunk)) == false)
+            {
+                break;
+            }
+            m_loaded += (uint64_t)count;
+        }
+    }
+    return true;
+}
+
+bool MBIMGUI::MBIFileLoader::PushChunk(ParsedChunk &&chunk)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]
+              { return m_cancel || m_chunks.size() < MAX_PENDING_CHUNKS; });
+    if (m_cancel)
+    {
+        return false;
+    }
+    m_chunks.push_back(std::move(chunk));
+    return true;
+}
+
+void MBIMGUI::MBIFileLoader::SetColumns(std::vector<ColumnInfo> &&columns)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_columns = std::move(columns);
+    m_columnsKnown = true;
+}
@@ -0,0 +1,147 @@
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+
+#include "MBILabelTable.h"
+
+/* Use anonymous namespace to hide tables from users */
+namespace
+{
+    using WriteLock = std::unique_lock<std::shared_mutex>;
+    using ReadLock = std::shared_lock<std::shared_mutex>;
+
+    /**
+     * @brief Storage of the interned labels
+     *
+     */
+    struct LabelStorage
+    {
+        std::shared_mutex mut;                                             ///< Table protection
+        std::deque<std::string> labels;                                    ///< Labels, by id. Deque never moves its elements on push_back
+        std::unordered_map<std::string_view, MBILabelTable::LabelId> ids; ///< Id of each label, keys are views on labels
+
+        LabelStorage()
+        {
+            labels.emplace_back("");
+            ids[labels.back()] = MBILabelTable::LABEL_EMPTY;
+        }
+    };
+
+    /**
+     * @brief Storage of the palette
+     *
+     */
+    struct PaletteStorage
+    {
+        std::shared_mutex mut;                              ///< Palette protection
+        ImVec4 colors[MBIColorPalette::PALETTE_SIZE];       ///< Colors of the palette
+        size_t used;                                        ///< Number of colors added through GetIndex
+
+        PaletteStorage() : used(1)
+        {
+            for (ImVec4 &color : colors)
+            {
+                color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+            }
+        }
+    };
+
+    LabelStorage &GetLabelStorage()
+    {
+        static LabelStorage g_labels;
+        return g_labels;
+    }
+
+    PaletteStorage &GetPaletteStorage()
+    {
+        static PaletteStorage g_palette;
+        return g_palette;
+    }
+}
+
+MBILabelTable::LabelId MBILabelTable::Intern(std::string_view label)
+{
+    LabelStorage &storage = GetLabelStorage();
+    {
+        ReadLock r_lock(storage.mut);
+        auto it = storage.ids.find(label);
+        if (it != storage.ids.end())
+        {
+            return it->second;
+        }
+    }
+
+    WriteLock w_lock(storage.mut);
+    /* Label may have been added between the two locks */
+    auto it = storage.ids.find(label);
+    if (it != storage.ids.end())
+    {
+        return it->second;
+    }
+    if (storage.labels.size() > LABEL_ID_MAX)
+    {
+        return LABEL_EMPTY;
+    }
+    const LabelId id = (LabelId)storage.labels.size();
+    storage.labels.emplace_back(label);
+    storage.ids[storage.labels.back()] = id;
+    return id;
+}
+
+const char *MBILabelTable::GetLabel(LabelId id) noexcept
+{
+    LabelStorage &storage = GetLabelStorage();
+    ReadLock r_lock(storage.mut);
+    if (id < storage.labels.size())
+    {
+        return storage.labels[id].c_str();
+    }
+    return "";
+}
+
+size_t MBILabelTable::Size() noexcept
+{
+    LabelStorage &storage = GetLabelStorage();
+    ReadLock r_lock(storage.mut);
+    return storage.labels.size();
+}
+
+MBIColorPalette::ColorIndex MBIColorPalette::GetIndex(const ImVec4 &color)
+{
+    PaletteStorage &storage = GetPaletteStorage();
+    WriteLock w_lock(storage.mut);
+    for (size_t i = 0; i < storage.used; i++)
+    {
+        const ImVec4 &known = storage.colors[i];
+        if (known.x == color.x && known.y == color.y && known.z == color.z && known.w == color.w)
+        {
+            return (ColorIndex)i;
+        }
+    }
+    if (storage.used >= PALETTE_SIZE)
+    {
+        return COLOR_DEFAULT;
+    }
+    storage.colors[storage.used] = color;
+    return (ColorIndex)storage.used++;
+}
+
+const ImVec4 MBIColorPalette::GetColor(ColorIndex index) noexcept
+{
+    PaletteStorage &storage = GetPaletteStorage();
+    ReadLock r_lock(storage.mut);
+    return storage.colors[index];
+}
+
+void MBIColorPalette::SetColor(ColorIndex index, const ImVec4 &color) noexcept
+{
+    PaletteStorage &storage = GetPaletteStorage();
+    WriteLock w_lock(storage.mut);
+    storage.colors[index] = color;
+    if (index >= storage.used)
+    {
+        storage.used = (size_t)index + 1;
+    }
+}
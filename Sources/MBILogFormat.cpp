@@ -0,0 +1,376 @@
+#include <atomic>
+#include <cstdio>
+#include <cwchar>
+
+#include "MBILogFormat.h"
+
+/* Registered formats, never moved so that they can be read from any thread without lock */
+static std::atomic<const char *> s_formats[MBIMGUI::MBILogFormat::MAX_FORMATS] = {};
+static std::atomic<uint32_t> s_formatCount(MBIMGUI::MBILogFormat::PLAIN_FORMAT + 1);
+
+MBIMGUI::MBILogFormat::MBILogFormat(const char *format) noexcept : m_id(PLAIN_FORMAT)
+{
+    const uint32_t id = s_formatCount.fetch_add(1, std::memory_order_relaxed);
+    if (id < MAX_FORMATS)
+    {
+        s_formats[id].store(format, std::memory_order_release);
+        m_id = id;
+    }
+}
+
+uint32_t MBIMGUI::MBILogFormat::GetId() const noexcept
+{
+    return m_id;
+}
+
+const char *MBIMGUI::MBILogFormat::Get(uint32_t id) noexcept
+{
+    const char *format = (id < MAX_FORMATS) ? s_formats[id].load(std::memory_order_acquire) : nullptr;
+    return (format != nullptr) ? format : "%s";
+}
+
+/**
+ * @brief Decoded argument of a log
+ *
+ */
+struct LogArg
+{
+    uint8_t tag = 0;              ///< Type of the argument, 0 if missing
+    int64_t i = 0;                ///< Value of TAG_INT
+    uint64_t u = 0;               ///< Value of TAG_UINT and TAG_POINTER
+    double d = 0;                 ///< Value of TAG_DOUBLE
+    std::string_view s;           ///< Value of TAG_STRING
+
+    /* Conversions used when the format doesn't match the argument type */
+    int64_t AsInt() const noexcept { return (tag == MBIMGUI::MBILogArgs::TAG_DOUBLE) ? (int64_t)d : (tag == MBIMGUI::MBILogArgs::TAG_INT) ? i : (int64_t)u; }
+    uint64_t AsUint() const noexcept { return (tag == MBIMGUI::MBILogArgs::TAG_DOUBLE) ? (uint64_t)d : (tag == MBIMGUI::MBILogArgs::TAG_INT) ? (uint64_t)i : u; }
+    double AsDouble() const noexcept { return (tag == MBIMGUI::MBILogArgs::TAG_DOUBLE) ? d : (tag == MBIMGUI::MBILogArgs::TAG_INT) ? (double)i : (double)u; }
+};
+
+/**
+ * @brief Decode the next argument
+ *
+ * @param args Encoded arguments
+ * @param size Size of args
+ * @param pos Position of the argument, moved to the next one
+ * @return LogArg Argument, with a null tag if there is no more argument
+ */
+static LogArg NextArg(const uint8_t *args, size_t size, size_t &pos) noexcept
+{
+    LogArg arg;
+    if (pos >= size)
+    {
+        return arg;
+    }
+    const uint8_t tag = args[pos];
+    if (tag == MBIMGUI::MBILogArgs::TAG_STRING)
+    {
+        if (pos + 2 <= size && pos + 2 + args[pos + 1] <= size)
+        {
+            arg.tag = tag;
+            arg.s = std::string_view((const char *)&args[pos + 2], args[pos + 1]);
+            pos += 2 + args[pos + 1];
+            return arg;
+        }
+    }
+    else if (tag == MBIMGUI::MBILogArgs::TAG_LONG_STRING)
+    {
+        uint32_t length = 0;
+        if (pos + 5 <= size)
+        {
+            memcpy(&length, &args[pos + 1], sizeof(length));
+        }
+        if (pos + 5 <= size && length <= size - pos - 5)
+        {
+            /* Decoded as any string argument */
+            arg.tag = MBIMGUI::MBILogArgs::TAG_STRING;
+            arg.s = std::string_view((const char *)&args[pos + 5], length);
+            pos += 5 + length;
+            return arg;
+        }
+    }
+    else if (pos + 9 <= size)
+    {
+        arg.tag = tag;
+        if (tag == MBIMGUI::MBILogArgs::TAG_INT)
+            memcpy(&arg.i, &args[pos + 1], 8);
+        else if (tag == MBIMGUI::MBILogArgs::TAG_DOUBLE)
+            memcpy(&arg.d, &args[pos + 1], 8);
+        else
+            memcpy(&arg.u, &args[pos + 1], 8);
+        pos += 9;
+        return arg;
+    }
+    /* Corrupted arguments */
+    pos = size;
+    return arg;
+}
+
+/**
+ * @brief Append a value formatted with a printf conversion specification
+ *
+ */
+template <typename T>
+static void AppendFormatted(std::string &out, const char *spec, T value)
+{
+    char buffer[128];
+    const int length = snprintf(buffer, sizeof(buffer), spec, value);
+    if (length < 0)
+    {
+        return;
+    }
+    if ((size_t)length < sizeof(buffer))
+    {
+        out.append(buffer, length);
+    }
+    else
+    {
+        const size_t start = out.size();
+        out.resize(start + length + 1);
+        snprintf(&out[start], length + 1, spec, value);
+        out.resize(start + length);
+    }
+}
+
+void MBIMGUI::MBILogFormat::Format(const char *format, const uint8_t *args, size_t size, std::string &out)
+{
+    size_t pos = 0;
+    const char *c = format;
+
+    while (*c != '\0')
+    {
+        if (*c != '%')
+        {
+            const char *next = strchr(c, '%');
+            const size_t length = (next != nullptr) ? (size_t)(next - c) : strlen(c);
+            out.append(c, length);
+            c += length;
+            continue;
+        }
+        if (c[1] == '%')
+        {
+            out += '%';
+            c += 2;
+            continue;
+        }
+
+        /* Conversion specification : flags, width and precision are kept, length modifiers are replaced since
+        numbers are stored on 64 bits */
+        char spec[32] = "%";
+        size_t specLength = 1;
+        c++;
+        while (*c != '\0' && strchr("-+ #0123456789.*", *c) != nullptr)
+        {
+            if (*c == '*')
+            {
+                /* Width or precision given as argument */
+                char number[24];
+                const int length = snprintf(number, sizeof(number), "%lld", (long long)NextArg(args, size, pos).AsInt());
+                for (int i = 0; i < length && specLength < sizeof(spec) - 8; i++)
+                    spec[specLength++] = number[i];
+            }
+            else if (specLength < sizeof(spec) - 8)
+            {
+                spec[specLength++] = *c;
+            }
+            c++;
+        }
+        while (*c != '\0' && strchr("hlLqjztI0123456789", *c) != nullptr)
+        {
+            c++;
+        }
+        if (*c == '\0')
+        {
+            break;
+        }
+
+        const char conversion = *c++;
+        const LogArg arg = NextArg(args, size, pos);
+        if (arg.tag == 0)
+        {
+            /* Missing argument */
+            continue;
+        }
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+            memcpy(&spec[specLength], "lld", 4);
+            AppendFormatted(out, spec, (long long)arg.AsInt());
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec[specLength] = 'l';
+            spec[specLength + 1] = 'l';
+            spec[specLength + 2] = conversion;
+            spec[specLength + 3] = '\0';
+            AppendFormatted(out, spec, (unsigned long long)arg.AsUint());
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec[specLength] = conversion;
+            spec[specLength + 1] = '\0';
+            AppendFormatted(out, spec, arg.AsDouble());
+            break;
+        case 'c':
+            memcpy(&spec[specLength], "c", 2);
+            AppendFormatted(out, spec, (int)arg.AsInt());
+            break;
+        case 'p':
+            memcpy(&spec[specLength], "p", 2);
+            AppendFormatted(out, spec, (void *)(uintptr_t)arg.AsUint());
+            break;
+        case 's':
+            if (arg.tag == MBILogArgs::TAG_STRING && specLength == 1)
+            {
+                out.append(arg.s);
+            }
+            else if (arg.tag == MBILogArgs::TAG_STRING)
+            {
+                /* Strings are not null terminated in the arguments */
+                const std::string str(arg.s);
+                memcpy(&spec[specLength], "s", 2);
+                AppendFormatted(out, spec, str.c_str());
+            }
+            else
+            {
+                memcpy(&spec[specLength], "lld", 4);
+                AppendFormatted(out, spec, (long long)arg.AsInt());
+            }
+            break;
+        default:
+            /* Unsupported conversion (%n...), argument skipped */
+            break;
+        }
+    }
+}
+
+uint64_t MBIMGUI::MBILogFormat::Hash(const char *format, va_list args, uint64_t hash) noexcept
+{
+    const char *c = format;
+
+    hash = Hash(format, strlen(format), hash);
+    while ((c = strchr(c, '%')) != nullptr)
+    {
+        c++;
+        if (*c == '%')
+        {
+            c++;
+            continue;
+        }
+
+        /* Flags, width and precision : only the widths and precisions given as argument are hashed */
+        while (*c != '\0' && strchr("-+ #0123456789.*", *c) != nullptr)
+        {
+            if (*c == '*')
+            {
+                const int value = va_arg(args, int);
+                hash = Hash(&value, sizeof(value), hash);
+            }
+            c++;
+        }
+
+        /* Length modifier, it gives the type of the argument */
+        bool isLong = false;
+        bool isLongLong = false;
+        bool isSize = false;
+        bool isLongDouble = false;
+        while (*c != '\0' && strchr("hlLqjztI", *c) != nullptr)
+        {
+            if (*c == 'l')
+            {
+                isLongLong = isLong;
+                isLong = true;
+            }
+            else if (*c == 'L')
+            {
+                isLongDouble = true;
+            }
+            else if (*c == 'q' || *c == 'j' || (c[0] == 'I' && c[1] == '6' && c[2] == '4'))
+            {
+                isLongLong = true;
+            }
+            else if (*c == 'z' || *c == 't' || (c[0] == 'I' && c[1] != '3'))
+            {
+                isSize = true;
+            }
+            c += (c[0] == 'I' && (c[1] == '6' || c[1] == '3')) ? 3 : 1;
+        }
+
+        switch (*c++)
+        {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+        {
+            uint64_t value;
+            if (isLongLong)
+                value = (uint64_t)va_arg(args, long long);
+            else if (isSize)
+                value = (uint64_t)va_arg(args, size_t);
+            else if (isLong)
+                value = (uint64_t)va_arg(args, long);
+            else
+                value = (uint64_t)va_arg(args, int);
+            hash = Hash(&value, sizeof(value), hash);
+            break;
+        }
+        case 'c':
+        case 'C':
+        {
+            /* Characters are promoted to int */
+            const int value = va_arg(args, int);
+            hash = Hash(&value, sizeof(value), hash);
+            break;
+        }
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            const double value = isLongDouble ? (double)va_arg(args, long double) : va_arg(args, double);
+            hash = Hash(&value, sizeof(value), hash);
+            break;
+        }
+        case 's':
+        case 'S':
+            if (isLong || c[-1] == 'S')
+            {
+                const wchar_t *value = va_arg(args, const wchar_t *);
+                hash = (value != nullptr) ? Hash(value, wcslen(value) * sizeof(wchar_t), hash) : Hash("", 1, hash);
+            }
+            else
+            {
+                const char *value = va_arg(args, const char *);
+                hash = (value != nullptr) ? Hash(value, strlen(value), hash) : Hash("", 1, hash);
+            }
+            break;
+        case 'p':
+        case 'n':
+        {
+            const void *value = va_arg(args, const void *);
+            hash = Hash(&value, sizeof(value), hash);
+            break;
+        }
+        default:
+            /* Unknown conversion, the type of the following arguments is unknown */
+            return hash;
+        }
+    }
+    return hash;
+}
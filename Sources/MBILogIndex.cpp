@@ -0,0 +1,278 @@
+#include <algorithm>
+
+#include "MBILogIndex.h"
+
+/**
+ * @brief Get the key of the n-gram starting at a position of a lowercase text
+ *
+ */
+static inline uint32_t Gram(const std::string &text, size_t pos, size_t length) noexcept
+{
+    uint32_t key = (uint32_t)length << 24;
+    for (size_t i = 0; i < length; i++)
+    {
+        key |= (uint32_t)(uint8_t)text[pos + i] << (8 * (length - 1 - i));
+    }
+    return key;
+}
+
+const std::string &MBIMGUI::MBILogIndex::GetLowerMessage(const MBILogger::MBILog &log)
+{
+    const std::string &message = log.GetMessageLog(m_message);
+    m_lower.resize(message.size());
+    std::transform(message.begin(), message.end(), m_lower.begin(), [](char c)
+                   { return (char)tolower((unsigned char)c); });
+    return m_lower;
+}
+
+bool MBIMGUI::MBILogIndex::Matches(const MBILogger::MBILog &log)
+{
+    if ((m_levelMask & (1u << log.GetLevel())) == 0)
+    {
+        return false;
+    }
+    return m_search.empty() || GetLowerMessage(log).find(m_search) != std::string::npos;
+}
+
+void MBIMGUI::MBILogIndex::Clear()
+{
+    m_history = nullptr;
+    m_indexed = 0;
+    m_compacted = 0;
+    for (auto &level : m_levels)
+    {
+        level.clear();
+    }
+    m_grams.clear();
+    m_matches.clear();
+}
+
+void MBIMGUI::MBILogIndex::Prune(uint64_t oldest, size_t size)
+{
+    for (auto &level : m_levels)
+    {
+        while (!level.empty() && level.front() < oldest)
+        {
+            level.pop_front();
+        }
+    }
+    while (!m_matches.empty() && m_matches.front() < oldest)
+    {
+        m_matches.pop_front();
+    }
+
+    /* Postings are only compacted once the evicted ones reach a quarter of the history, searches skip them meanwhile */
+    const uint64_t oldestBlock = oldest / BLOCK_SIZE;
+    if (oldestBlock >= m_compacted + std::max<uint64_t>(MIN_COMPACT_PERIOD, size / BLOCK_SIZE / 4))
+    {
+        for (auto it = m_grams.begin(); it != m_grams.end();)
+        {
+            std::vector<Posting> &postings = it->second;
+            postings.erase(postings.begin(), std::find_if(postings.begin(), postings.end(), [oldestBlock](const Posting &posting)
+                                                          { return posting.block >= oldestBlock; }));
+            if (postings.empty())
+            {
+                it = m_grams.erase(it);
+            }
+            else
+            {
+                /* Release the memory of the postings of rare n-grams no longer in the history */
+                if (postings.capacity() > 2 * postings.size())
+                {
+                    postings.shrink_to_fit();
+                }
+                ++it;
+            }
+        }
+        m_compacted = oldestBlock;
+    }
+}
+
+void MBIMGUI::MBILogIndex::Update(const History &history)
+{
+    uint64_t oldest = 0;
+    uint64_t pushed = 0;
+    history.bounds(oldest, pushed);
+
+    /* History replaced (see MBILogger::SetHistorySize) */
+    if (&history != m_history || pushed < m_indexed)
+    {
+        Clear();
+        m_history = &history;
+    }
+    if (pushed == m_indexed)
+    {
+        return;
+    }
+
+    /* Work bounded per call : a large backlog, e.g. while the window was hidden, is indexed over several frames */
+    m_logs.clear();
+    uint64_t index = history.copy_range(m_indexed, MAX_UPDATE_LOGS, m_logs);
+    Prune(oldest, (size_t)(pushed - oldest));
+
+    for (const MBILogger::MBILog &log : m_logs)
+    {
+        const uint32_t level = (uint32_t)log.GetLevel();
+        if (level < LEVEL_COUNT)
+        {
+            m_levels[level].push_back(index);
+        }
+
+        const std::string &lower = GetLowerMessage(log);
+        const uint64_t block = index / BLOCK_SIZE;
+        const uint32_t bit = 1u << (index % BLOCK_SIZE);
+        for (size_t length = 1; length <= MAX_GRAM; length++)
+        {
+            for (size_t i = 0; i + length <= lower.size(); i++)
+            {
+                std::vector<Posting> &postings = m_grams[Gram(lower, i, length)];
+                if (postings.empty() || postings.back().block != block)
+                {
+                    postings.push_back({block, bit});
+                }
+                else
+                {
+                    postings.back().logs |= bit;
+                }
+            }
+        }
+
+        /* Matches of the current filter kept up to date */
+        if (IsFiltering() && (m_levelMask & (1u << level)) != 0 && lower.find(m_search) != std::string::npos)
+        {
+            m_matches.push_back(index);
+        }
+        index++;
+    }
+    m_indexed = index;
+}
+
+bool MBIMGUI::MBILogIndex::IsLevelKept(uint64_t index) const
+{
+    for (uint32_t level = 0; level < LEVEL_COUNT; level++)
+    {
+        if ((m_levelMask & (1u << level)) && std::binary_search(m_levels[level].begin(), m_levels[level].end(), index))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MBIMGUI::MBILogIndex::Verify(const History &history, uint64_t block, uint32_t logs)
+{
+    m_logs.clear();
+    uint64_t index = history.copy_range(block * BLOCK_SIZE, BLOCK_SIZE, m_logs);
+    for (const MBILogger::MBILog &log : m_logs)
+    {
+        /* Only the logs already indexed, the next ones are checked by Update */
+        if ((logs & (1u << (index % BLOCK_SIZE))) && index < m_indexed && Matches(log))
+        {
+            m_matches.push_back(index);
+        }
+        index++;
+    }
+}
+
+void MBIMGUI::MBILogIndex::SetFilter(const History &history, std::string_view search, uint32_t levelMask)
+{
+    m_search.resize(search.size());
+    std::transform(search.begin(), search.end(), m_search.begin(), [](char c)
+                   { return (char)tolower((unsigned char)c); });
+    m_levelMask = levelMask & ALL_LEVELS;
+    m_matches.clear();
+    if (!IsFiltering() || m_history != &history)
+    {
+        return;
+    }
+
+    uint64_t oldest = 0;
+    uint64_t end = 0;
+    history.bounds(oldest, end);
+    if (m_search.empty())
+    {
+        /* Level filter only : merge the logs of the selected levels */
+        std::vector<uint64_t> merged;
+        for (uint32_t level = 0; level < LEVEL_COUNT; level++)
+        {
+            if (m_levelMask & (1u << level))
+            {
+                const size_t middle = merged.size();
+                merged.insert(merged.end(), m_levels[level].begin(), m_levels[level].end());
+                std::inplace_merge(merged.begin(), merged.begin() + middle, merged.end());
+            }
+        }
+        m_matches.assign(std::lower_bound(merged.begin(), merged.end(), oldest), merged.end());
+        return;
+    }
+
+    /* Postings of the searched text, or of its trigrams, the shortest first */
+    const size_t length = std::min<size_t>(m_search.size(), MAX_GRAM);
+    std::vector<const std::vector<Posting> *> lists;
+    for (size_t i = 0; i + length <= m_search.size(); i++)
+    {
+        const auto it = m_grams.find(Gram(m_search, i, length));
+        if (it == m_grams.end())
+        {
+            /* A n-gram never seen, no match */
+            return;
+        }
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<Posting> *a, const std::vector<Posting> *b)
+              { return a->size() < b->size(); });
+
+    /* Logs containing all the n-grams */
+    const uint64_t oldestBlock = oldest / BLOCK_SIZE;
+    m_candidates.assign(std::find_if(lists[0]->begin(), lists[0]->end(), [oldestBlock](const Posting &posting)
+                                     { return posting.block >= oldestBlock; }),
+                        lists[0]->end());
+    for (size_t i = 1; i < lists.size() && !m_candidates.empty(); i++)
+    {
+        auto it = lists[i]->begin();
+        size_t kept = 0;
+        for (const Posting &candidate : m_candidates)
+        {
+            it = std::lower_bound(it, lists[i]->end(), candidate.block, [](const Posting &posting, uint64_t block)
+                                  { return posting.block < block; });
+            if (it == lists[i]->end())
+            {
+                break;
+            }
+            if (it->block == candidate.block && (candidate.logs & it->logs) != 0)
+            {
+                m_candidates[kept++] = {candidate.block, candidate.logs & it->logs};
+            }
+        }
+        m_candidates.resize(kept);
+    }
+
+    for (const Posting &candidate : m_candidates)
+    {
+        if (m_search.size() > MAX_GRAM)
+        {
+            /* All the trigrams found, but maybe not contiguous : check the messages */
+            Verify(history, candidate.block, candidate.logs);
+            continue;
+        }
+        /* The n-gram of the searched text, exact match */
+        for (uint32_t bit = 0; bit < BLOCK_SIZE; bit++)
+        {
+            const uint64_t index = candidate.block * BLOCK_SIZE + bit;
+            if ((candidate.logs & (1u << bit)) && index >= oldest && (m_levelMask == ALL_LEVELS || IsLevelKept(index)))
+            {
+                m_matches.push_back(index);
+            }
+        }
+    }
+}
+
+bool MBIMGUI::MBILogIndex::IsFiltering() const noexcept
+{
+    return !m_search.empty() || m_levelMask != ALL_LEVELS;
+}
+
+const std::deque<uint64_t> &MBIMGUI::MBILogIndex::GetMatches() const noexcept
+{
+    return m_matches;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MBILogger.h"
+
+namespace MBIMGUI
+{
+    /**
+     * @brief Search index of the log history, maintained incrementally as logs arrive.
+     *
+     * Logs are identified by their stable index in the history (see MBICircularBuffer::pushed()). The index keeps the
+     * logs of each level, and an n-gram index of the lowercase messages : for each n-gram of 1 to 3 characters, the
+     * blocks of BLOCK_SIZE logs containing it, with a bitmask of these logs. A search of up to 3 characters is directly
+     * answered by its n-gram. A longer search intersects the bitmasks of its trigrams, then only checks the messages of
+     * the remaining logs. The logs matching the current filter are updated as logs arrive.
+     *
+     */
+    class MBILogIndex
+    {
+    public:
+        using History = MBISyncCircularBuffer<MBILogger::MBILog>; ///< Log history indexed
+
+        static constexpr uint32_t BLOCK_SIZE = 32;            ///< Number of logs of a block of the n-gram index, one bit each
+        static constexpr uint32_t LEVEL_COUNT = 4;            ///< Number of log levels
+        static constexpr uint32_t ALL_LEVELS = 0xF;           ///< Level mask selecting all the levels
+        static constexpr uint32_t MAX_GRAM = 3;               ///< Length of the longest n-grams indexed
+        static constexpr uint64_t MIN_COMPACT_PERIOD = 64;    ///< Minimum number of evicted blocks between two n-gram index compactions
+        static constexpr size_t MAX_UPDATE_LOGS = 4096;       ///< Maximum number of logs indexed by an Update, the next ones by the next calls
+
+        /**
+         * @brief Index the logs pushed in the history since last call, up to MAX_UPDATE_LOGS, and forget the logs
+         * evicted from it. The postings of the evicted logs are compacted once they exceed a quarter of the history,
+         * so the index memory remains proportional to the history size.
+         *
+         * @param history Log history
+         */
+        void Update(const History &history);
+
+        /**
+         * @brief Set the filter and compute the logs matching it
+         *
+         * @param history Log history, indexed by Update
+         * @param search Text searched in the messages, case insensitive. Empty to match all the messages.
+         * @param levelMask Levels to keep, bit (1 << level) for each level
+         */
+        void SetFilter(const History &history, std::string_view search, uint32_t levelMask);
+
+        /**
+         * @brief Is a filter set ?
+         *
+         * @return true Only the matches of the filter must be displayed
+         */
+        bool IsFiltering() const noexcept;
+
+        /**
+         * @brief Get the logs matching the filter, by increasing stable index
+         *
+         * @return const std::deque<uint64_t>& Stable indexes of the matching logs
+         */
+        const std::deque<uint64_t> &GetMatches() const noexcept;
+
+        /**
+         * @brief Forget all the logs
+         *
+         */
+        void Clear();
+
+    private:
+        const History *m_history = nullptr; ///< Indexed history
+        uint64_t m_indexed = 0;             ///< Stable index of the next log to index
+        uint64_t m_compacted = 0;           ///< Oldest block kept in the n-gram index at last compaction
+
+        /**
+         * @brief Logs of a block containing a n-gram
+         *
+         */
+        struct Posting
+        {
+            uint64_t block; ///< Block index, stable index of its first log divided by BLOCK_SIZE
+            uint32_t logs;  ///< Bit i set when the log i of the block contains the n-gram
+        };
+
+        std::deque<uint64_t> m_levels[LEVEL_COUNT];                 ///< Logs of each level
+        std::unordered_map<uint32_t, std::vector<Posting>> m_grams; ///< Blocks of logs containing each n-gram
+
+        std::string m_search;                ///< Searched text, lowercase
+        uint32_t m_levelMask = ALL_LEVELS;   ///< Levels kept
+        std::deque<uint64_t> m_matches;      ///< Logs matching the filter
+
+        std::vector<MBILogger::MBILog> m_logs; ///< Scratch buffer of logs copied from the history
+        std::vector<Posting> m_candidates;     ///< Scratch buffer of the candidate logs of a search
+        std::string m_message;                 ///< Scratch buffer of formatted messages
+        std::string m_lower;                   ///< Scratch buffer of lowercase messages
+
+        /**
+         * @brief Does a log match the filter ?
+         *
+         * @param log Log to check
+         * @return true Log matching the level mask and containing the searched text
+         */
+        bool Matches(const MBILogger::MBILog &log);
+
+        /**
+         * @brief Get the lowercase message of a log
+         *
+         * @param log Log
+         * @return const std::string& Lowercase message, valid until next call
+         */
+        const std::string &GetLowerMessage(const MBILogger::MBILog &log);
+
+        /**
+         * @brief Is the level of a log kept by the level mask ?
+         *
+         * @param index Stable index of the log
+         * @return true Log of a kept level
+         */
+        bool IsLevelKept(uint64_t index) const;
+
+        /**
+         * @brief Check the messages of the candidate logs of a block, appending the matches
+         *
+         * @param history Log history
+         * @param block Block index
+         * @param logs Bitmask of the candidate logs of the block
+         */
+        void Verify(const History &history, uint64_t block, uint32_t logs);
+
+        /**
+         * @brief Forget the logs evicted from the history
+         *
+         * @param oldest Stable index of the oldest log of the history
+         * @param size Number of logs of the history
+         */
+        void Prune(uint64_t oldest, size_t size);
+    };
+}
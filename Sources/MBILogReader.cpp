@@ -0,0 +1,125 @@
+#include <cstring>
+
+#include "MBILogReader.h"
+
+bool MBIMGUI::MBILogReader::Open(std::string_view path)
+{
+    char magic[sizeof(MAGIC)];
+
+    m_file.close();
+    m_file.clear();
+    m_formats.clear();
+    m_file.open(std::string(path), std::ios::in | std::ios::binary);
+    if (m_file.fail())
+    {
+        return false;
+    }
+    if (!Read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+    return ReadSession();
+}
+
+bool MBIMGUI::MBILogReader::ReadSession()
+{
+    /* Format identifiers are only valid in their session */
+    m_formats.clear();
+    return Read(&m_sessionStart, sizeof(m_sessionStart));
+}
+
+bool MBIMGUI::MBILogReader::Read(void *data, size_t size)
+{
+    m_file.read((char *)data, size);
+    return (size_t)m_file.gcount() == size;
+}
+
+bool MBIMGUI::MBILogReader::Next(Record &record)
+{
+    uint8_t type;
+
+    while (m_file.is_open() && Read(&type, 1))
+    {
+        if (type == RECORD_FORMAT)
+        {
+            uint32_t id;
+            uint16_t length;
+            if (!Read(&id, sizeof(id)) || !Read(&length, sizeof(length)) || id >= MBILogFormat::MAX_FORMATS)
+            {
+                return false;
+            }
+            if (id >= m_formats.size())
+            {
+                m_formats.resize(id + 1);
+            }
+            m_formats[id].resize(length);
+            if (!Read(m_formats[id].data(), length))
+            {
+                return false;
+            }
+        }
+        else if (type == RECORD_LOG || type == RECORD_MESSAGE)
+        {
+            uint8_t level;
+            if (!Read(&level, sizeof(level)) || !Read(&record.time, sizeof(record.time)) || !Read(&record.thread, sizeof(record.thread)))
+            {
+                return false;
+            }
+            record.level = (MBILogLevel)level;
+            record.message.clear();
+
+            if (type == RECORD_LOG)
+            {
+                uint32_t id;
+                uint32_t size;
+                if (!Read(&id, sizeof(id)) || !Read(&size, sizeof(size)) || size > MAX_ARGS_SIZE)
+                {
+                    return false;
+                }
+                m_args.resize(size);
+                if (!Read(m_args.data(), size))
+                {
+                    return false;
+                }
+                const char *format = (id < m_formats.size() && !m_formats[id].empty()) ? m_formats[id].c_str() : "%s";
+                MBILogFormat::Format(format, m_args.data(), size, record.message);
+            }
+            else
+            {
+                uint32_t length;
+                if (!Read(&length, sizeof(length)))
+                {
+                    return false;
+                }
+                record.message.resize(length);
+                if (!Read(record.message.data(), length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        else if (type == (uint8_t)MAGIC[0])
+        {
+            /* Next session, appended to the same file */
+            char magic[sizeof(MAGIC)];
+            magic[0] = (char)type;
+            if (!Read(&magic[1], sizeof(magic) - 1) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !ReadSession())
+            {
+                return false;
+            }
+        }
+        else
+        {
+            /* Corrupted file */
+            return false;
+        }
+    }
+    return false;
+}
+
+int64_t MBIMGUI::MBILogReader::GetSessionStart() const noexcept
+{
+    return m_sessionStart;
+}
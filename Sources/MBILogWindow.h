@@ -2,6 +2,7 @@
 #pragma once
 #include "MBIWindow.h"
 #include "MBILogger.h"
+#include "MBILogIndex.h"
 
 namespace MBIMGUI
 {
@@ -41,25 +42,27 @@ namespace MBIMGUI
          */
         void Display()
         {
-            static constexpr ImGuiTableFlags flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+            static constexpr ImGuiTableFlags flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_ScrollY;
 
             if (m_mode == MODE_BAR)
             {
-                if (m_logger.m_logs.empty() == false)
+                const MBISyncCircularBuffer<MBILogger::MBILog> &logs = *m_logger.m_logs;
+                m_rows.clear();
+                logs.copy_range(logs.pushed() - 1, 1, m_rows);
+                if (m_rows.empty() == false)
                 {
-                    std::string log;
+                    std::string log = m_logger.GetErrorToPopup();
                     ImVec4 color;
                     /* Always show the latest error in priority */
-                    if (m_logger.m_errToPopup.empty() == false)
+                    if (log.empty() == false)
                     {
-                        log = m_logger.m_errToPopup;
                         color = GetLevelColor(LOG_LEVEL_ERROR);
                     }
                     else
                     {
                         /* Otherwise, display the latest log */
-                        log = m_logger.m_logs.last().GetMessageLog();
-                        color = GetLevelColor(m_logger.m_logs.last().GetLevel());
+                        log = m_rows.front().GetMessageLog(m_message);
+                        color = GetLevelColor(m_rows.front().GetLevel());
                     }
                     ImGui::ColorButton("#LevelColor", color, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoTooltip, ImVec2(15, 15));
                     ImGui::SameLine();
@@ -68,61 +71,79 @@ namespace MBIMGUI
             }
             else
             {
+                /* Filters, the matching logs are updated by the index as logs arrive */
+                const MBISyncCircularBuffer<MBILogger::MBILog> &logs = *m_logger.m_logs;
+                m_index.Update(logs);
+                if (DisplayFilters())
+                {
+                    uint32_t levelMask = 0;
+                    for (uint32_t level = 0; level < MBILogIndex::LEVEL_COUNT; level++)
+                    {
+                        levelMask |= m_showLevels[level] ? (1u << level) : 0;
+                    }
+                    m_index.SetFilter(logs, m_search, levelMask);
+                }
+
                 /* Show logs in a table */
-                if (ImGui::BeginTable("##logTable", 3, flags))
+                if (ImGui::BeginTable("##logTable", 4, flags))
                 {
                     /* Submit columns name */
                     ImGui::TableSetupColumn(ICON_FA_BUG " Level");
+                    ImGui::TableSetupColumn(ICON_FA_LIST " Thread");
                     ImGui::TableSetupColumn(ICON_FA_BOOK_OPEN " Message", ImGuiTableColumnFlags_WidthStretch);
                     ImGui::TableSetupColumn(ICON_FA_CALENDAR " Date");
+                    ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableHeadersRow();
-                    for (const auto log : m_logger.m_logs)
+
+                    if (m_index.IsFiltering())
                     {
-                        /* Add a new row */
-                        ImGui::TableNextRow();
-                        /* Display log level */
-                        ImGui::TableNextColumn();
-                        ImGui::TextColored(GetLevelColor(log.GetLevel()), log.GetLevelString().c_str());
-                        /* Display log text */
-                        ImGui::TableNextColumn();
-                        ImGui::Selectable(log.GetMessageLog().c_str());
-                        if (ImGui::IsItemHovered())
+                        /* Only the visible matches are copied from the history and displayed */
+                        const std::deque<uint64_t> &matches = m_index.GetMatches();
+                        ImGuiListClipper clipper;
+                        clipper.Begin((int)matches.size());
+                        while (clipper.Step())
                         {
-                            // Show tooltip if column is too tight to display full text
-                            ImVec2 textSize = ImGui::CalcTextSize(log.GetMessageLog().c_str());
-                            if (ImGui::GetColumnWidth() < textSize.x)
+                            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
                             {
-                                ImGui::SetTooltip(log.GetMessageLog().c_str());
+                                ImGui::TableNextRow();
+                                m_rows.clear();
+                                /* Matches overwritten since last index update are left empty */
+                                if (logs.copy_range(matches[row], 1, m_rows) == matches[row] && m_rows.empty() == false)
+                                {
+                                    DisplayRow(m_rows.front(), row);
+                                }
                             }
                         }
-                        /* Display log date */
-                        ImGui::TableNextColumn();
-                        ImGui::Text(log.GetTime().c_str());
+                        clipper.End();
+                    }
+                    else
+                    {
+                        /* Only the visible rows are copied from the history and displayed */
+                        DisplayRows(logs);
                     }
-                    ImGui::EndTable();
 
                     /* Auto scroll down when adding new logs */
                     if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
                         ImGui::SetScrollHereY(1.0f);
+                    ImGui::EndTable();
                 }
             }
             /* If popup has been activated */
             if (m_logger.m_popupOnError)
             {
-                if (m_logger.m_displayPopup)
+                if (m_logger.m_displayPopup.exchange(false))
                 {
                     /* Open the popup */
                     ImGui::OpenPopup("ERROR##popup");
-                    m_logger.m_displayPopup = false;
                 }
                 /* Prepare popup for errors */
                 if (ImGui::BeginPopupModal("ERROR##popup", NULL, ImGuiWindowFlags_AlwaysAutoResize))
                 {
-                    ImGui::Text(m_logger.m_errToPopup.c_str());
+                    ImGui::Text(m_logger.GetErrorToPopup().c_str());
                     ImGui::Separator();
                     if (ImGui::Button("OK", ImVec2(120, 0)))
                     {
-                        m_logger.m_errToPopup.clear();
+                        m_logger.ClearErrorToPopup();
                         ImGui::CloseCurrentPopup();
                     }
                     ImGui::EndPopup();
@@ -131,6 +152,92 @@ namespace MBIMGUI
         }
 
     private:
+        /**
+         * @brief Display all the logs of the history, only the visible rows being copied
+         *
+         * @param logs Log history
+         */
+        void DisplayRows(const MBISyncCircularBuffer<MBILogger::MBILog> &logs)
+        {
+            const uint64_t pushed = logs.pushed();
+            const size_t count = logs.size();
+            ImGuiListClipper clipper;
+            clipper.Begin((int)count);
+            while (clipper.Step())
+            {
+                const uint64_t start = pushed - count + clipper.DisplayStart;
+                m_rows.clear();
+                /* Rows overwritten since the size was read are left empty */
+                const uint64_t first = logs.copy_range(start, clipper.DisplayEnd - clipper.DisplayStart, m_rows);
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+                {
+                    const uint64_t index = start + (row - clipper.DisplayStart);
+                    ImGui::TableNextRow();
+                    if (index >= first && index - first < m_rows.size())
+                    {
+                        DisplayRow(m_rows[(size_t)(index - first)], row);
+                    }
+                }
+            }
+            clipper.End();
+        }
+
+        /**
+         * @brief Display the level and search filters
+         *
+         * @return true A filter has been modified
+         */
+        bool DisplayFilters()
+        {
+            static constexpr const char *levels[MBILogIndex::LEVEL_COUNT] = {"INFO", "WARNING", "ERROR", "DEBUG"};
+            bool modified = false;
+
+            for (uint32_t level = 0; level < MBILogIndex::LEVEL_COUNT; level++)
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, GetLevelColor((MBILogLevel)level));
+                modified |= ImGui::Checkbox(levels[level], &m_showLevels[level]);
+                ImGui::PopStyleColor();
+                ImGui::SameLine();
+            }
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            modified |= ImGui::InputTextWithHint("##search", ICON_FA_MAGNIFYING_GLASS " Search", m_search, sizeof(m_search));
+            return modified;
+        }
+
+        /**
+         * @brief Display a log in the current row of the table
+         *
+         * @param log Log to display
+         * @param row Index of the row, used as ImGui identifier
+         */
+        void DisplayRow(const MBILogger::MBILog &log, int row)
+        {
+            /* Display log level */
+            ImGui::TableNextColumn();
+            ImGui::TextColored(GetLevelColor(log.GetLevel()), log.GetLevelString());
+            /* Display thread identifier */
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", log.GetThread());
+            /* Display log text */
+            ImGui::TableNextColumn();
+            const std::string &message = log.GetMessageLog(m_message);
+            ImGui::PushID(row);
+            ImGui::Selectable(message.c_str());
+            ImGui::PopID();
+            if (ImGui::IsItemHovered())
+            {
+                // Show tooltip if column is too tight to display full text
+                ImVec2 textSize = ImGui::CalcTextSize(message.c_str());
+                if (ImGui::GetColumnWidth() < textSize.x)
+                {
+                    ImGui::SetTooltip(message.c_str());
+                }
+            }
+            /* Display log date */
+            ImGui::TableNextColumn();
+            ImGui::Text(m_time.Format(log.GetTime(), m_logger.m_precise));
+        }
+
         /**
          * @brief Convert the log level to the appropiate color object to be displayed by ImGui
          *
@@ -154,5 +261,11 @@ namespace MBIMGUI
         }
 
         LOGWINDOW_MODE m_mode; ///< Store the current mode of the window
+        MBILogger::MBILogTime m_time; ///< Formatting cache of the log dates
+        std::string m_message;        ///< Formatting buffer of the log messages
+        std::vector<MBILogger::MBILog> m_rows; ///< Logs of the visible rows, copied from the history
+        MBILogIndex m_index;                   ///< Search index of the history
+        char m_search[128] = "";               ///< Searched text
+        bool m_showLevels[MBILogIndex::LEVEL_COUNT] = {true, true, true, true}; ///< Displayed levels
     };
 }
\ No newline at end of file
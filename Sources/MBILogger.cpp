@@ -1,30 +1,24 @@
+#include <windows.h>
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <cstdarg>
-#include <sstream>
+#include <cstring>
+#include <chrono>
 #include <ctime>
 
 #include "MBILogger.h"
+#include "MBILogReader.h"
 
-MBIMGUI::MBILogger::MBILog::MBILog(MBILogLevel level, std::string_view  msg) : m_level(level), m_message(msg)
-{
-    tm ltm;
-    time_t now = time(0);
-    if (localtime_s(&ltm, &now) == 0)
-    {
-        std::stringstream sstream;
-        sstream << std::setfill('0') << std::setw(2) << ltm.tm_hour
-                << ":" << std::setw(2) << ltm.tm_min
-                << ":" << std::setw(2) << ltm.tm_sec;
-        m_time = sstream.str();
-    }
-};
+MBIMGUI::MBILogger::MBILog::MBILog(MBILogLevel level, std::string_view msg, int64_t time) : m_level(level), m_message(msg), m_time(time){};
 
 MBIMGUI::MBILogLevel MBIMGUI::MBILogger::MBILog::GetLevel() const noexcept
 {
     return m_level;
 }
 
-const std::string MBIMGUI::MBILogger::MBILog::GetLevelString() const noexcept
+const char *MBIMGUI::MBILogger::MBILog::GetLevelString() const noexcept
 {
     switch (m_level)
     {
@@ -40,32 +34,822 @@ const std::string MBIMGUI::MBILogger::MBILog::GetLevelString() const noexcept
     }
 }
 
-const std::string &MBIMGUI::MBILogger::MBILog::GetMessageLog() const noexcept
+const std::string &MBIMGUI::MBILogger::MBILog::GetMessageLog(std::string &buffer) const
 {
-    return m_message;
+    if (m_format == MBILogFormat::PLAIN_FORMAT)
+    {
+        if (m_repeat <= 1)
+        {
+            return m_message;
+        }
+        buffer = m_message;
+    }
+    else
+    {
+        buffer.clear();
+        MBILogFormat::Format(MBILogFormat::Get(m_format), m_args.data(), m_args.size(), buffer);
+    }
+    if (m_repeat > 1)
+    {
+        buffer += " (\xC3\x97";
+        buffer += std::to_string(m_repeat);
+        buffer += ')';
+    }
+    return buffer;
+}
+
+uint32_t MBIMGUI::MBILogger::MBILog::GetFormat() const noexcept
+{
+    return m_format;
 }
-const std::string &MBIMGUI::MBILogger::MBILog::GetTime() const noexcept
+
+const MBIMGUI::MBILogArgs &MBIMGUI::MBILogger::MBILog::GetArgs() const noexcept
+{
+    return m_args;
+}
+int64_t MBIMGUI::MBILogger::MBILog::GetTime() const noexcept
 {
     return m_time;
 }
 
+void MBIMGUI::MBILogger::MBILog::SetTime(int64_t time) noexcept
+{
+    m_time = time;
+}
+
+uint32_t MBIMGUI::MBILogger::MBILog::GetThread() const noexcept
+{
+    return m_thread;
+}
+
+void MBIMGUI::MBILogger::MBILog::SetThread(uint32_t thread) noexcept
+{
+    m_thread = thread;
+}
+
+uint32_t MBIMGUI::MBILogger::MBILog::GetRepeat() const noexcept
+{
+    return m_repeat;
+}
+
+void MBIMGUI::MBILogger::MBILog::SetRepeat(uint32_t repeat) noexcept
+{
+    m_repeat = repeat;
+}
+
+const char *MBIMGUI::MBILogger::MBILogTime::Format(int64_t time, bool precise) noexcept
+{
+    int64_t second = time / 1000000;
+    int64_t micro = time % 1000000;
+    if (micro < 0)
+    {
+        second--;
+        micro += 1000000;
+    }
+
+    /* Local time only computed when the second changes */
+    if (second != m_second)
+    {
+        tm ltm;
+        const time_t now = (time_t)second;
+        if (localtime_s(&ltm, &now) == 0)
+        {
+            snprintf(m_text, sizeof(m_text), "%02d:%02d:%02d", ltm.tm_hour, ltm.tm_min, ltm.tm_sec);
+        }
+        else
+        {
+            m_text[0] = '\0';
+        }
+        m_second = second;
+    }
+
+    if (precise && m_text[0] != '\0')
+    {
+        m_text[8] = '.';
+        for (int i = 14; i > 8; i--)
+        {
+            m_text[i] = (char)('0' + micro % 10);
+            micro /= 10;
+        }
+        m_text[15] = '\0';
+    }
+    else
+    {
+        m_text[8] = '\0';
+    }
+    return m_text;
+}
+
 void MBIMGUI::MBILogger::CloseLogFile()
 {
-    if (m_filestream.is_open())
+    if (m_file != INVALID_HANDLE_VALUE)
     {
-        m_filestream << "*************************** Session End ****************************" << std::endl
-                     << std::endl;
-        m_filestream.close();
+        if (!m_binary)
+        {
+            static constexpr char end[] = "*************************** Session End ****************************\n\n";
+            WriteRaw(end, sizeof(end) - 1);
+        }
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
     }
+    DiscardNextSegment();
 }
 
-MBIMGUI::MBILogger::MBILogger() : m_logs(30), m_logfile(""), m_popupOnError(false), m_displayPopup(false), m_logToFile(false){};
+/**
+ * @brief Check whether a logfile is in binary format
+ *
+ * @param logfile Path of the logfile
+ * @return true The file starts with a binary session header
+ */
+static bool IsBinaryLogfile(std::string_view logfile)
+{
+    char magic[sizeof(MBIMGUI::MBILogReader::MAGIC)] = {0};
+    std::ifstream file(std::filesystem::path(logfile), std::ios::in | std::ios::binary);
+    file.read(magic, sizeof(magic));
+    return file.gcount() == sizeof(magic) && memcmp(magic, MBIMGUI::MBILogReader::MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Reserve the clusters of a whole logfile segment : no fragmentation nor allocation while writing.
+ * Optimization only, the logfile is usable if it fails.
+ *
+ * @param file Handle of the segment
+ * @param size Size of the segment in bytes
+ */
+static void Preallocate(HANDLE file, uint64_t size)
+{
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = (LONGLONG)size;
+    SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+}
+
+bool MBIMGUI::MBILogger::OpenLogFile(bool append)
+{
+    LARGE_INTEGER size = {};
+
+    m_file = CreateFileW(GetSegmentPath(0).c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, append ? OPEN_ALWAYS : CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    SetFilePointerEx(m_file, size, &size, FILE_END);
+    m_fileSize = (uint64_t)size.QuadPart;
+
+    if (m_maxFileSize > m_fileSize)
+    {
+        Preallocate(m_file, m_maxFileSize);
+    }
+    return true;
+}
+
+void MBIMGUI::MBILogger::PrepareNextSegment()
+{
+    if (!m_logToFile || m_maxFileSize == 0 || m_nextFile != INVALID_HANDLE_VALUE || m_fileSize < m_maxFileSize / 2)
+    {
+        return;
+    }
+    /* Shared for deletion, so it can be renamed to the logfile while opened */
+    m_nextFile = CreateFileW(GetNextSegmentPath().c_str(), GENERIC_WRITE | DELETE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_nextFile != INVALID_HANDLE_VALUE)
+    {
+        Preallocate(m_nextFile, m_maxFileSize);
+    }
+}
+
+void MBIMGUI::MBILogger::DiscardNextSegment() noexcept
+{
+    if (m_nextFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_nextFile);
+        m_nextFile = INVALID_HANDLE_VALUE;
+        DeleteFileW(GetNextSegmentPath().c_str());
+    }
+}
+
+void MBIMGUI::MBILogger::WriteHeader()
+{
+    if (m_binary)
+    {
+        const int64_t start = GetTimestamp();
+        WriteRaw(MBILogReader::MAGIC, sizeof(MBILogReader::MAGIC));
+        WriteRaw(&start, sizeof(start));
+        /* Formats are written again in each segment */
+        m_formatsWritten.clear();
+    }
+    else
+    {
+        char header[512];
+        tm ltm;
+        time_t now = time(0);
+        int length = snprintf(header, sizeof(header), "********************************************************************\n"
+                                                      "************************** Session Start ***************************\n");
+        if (localtime_s(&ltm, &now) == 0)
+        {
+            length += snprintf(&header[length], sizeof(header) - length, "**************************   %02d/%02d/%d  ***************************\n"
+                                                                         "********************************************************************\n",
+                               ltm.tm_mday, ltm.tm_mon + 1, ltm.tm_year + 1900);
+        }
+        WriteRaw(header, length);
+    }
+}
+
+bool MBIMGUI::MBILogger::WriteRaw(const void *data, size_t size) noexcept
+{
+    DWORD written = 0;
+    if (m_file == INVALID_HANDLE_VALUE || !WriteFile(m_file, data, (DWORD)size, &written, NULL))
+    {
+        return false;
+    }
+    m_fileSize += written;
+    return written == size;
+}
+
+std::filesystem::path MBIMGUI::MBILogger::GetSegmentPath(uint32_t index) const
+{
+    std::filesystem::path path(m_logfile);
+    if (index > 0)
+    {
+        path.replace_filename(path.stem().string() + "." + std::to_string(index) + path.extension().string());
+    }
+    return path;
+}
+
+std::filesystem::path MBIMGUI::MBILogger::GetNextSegmentPath() const
+{
+    std::filesystem::path path(m_logfile);
+    path.replace_filename(path.stem().string() + ".next" + path.extension().string());
+    return path;
+}
+
+void MBIMGUI::MBILogger::ShiftSegments() noexcept
+{
+    for (uint32_t i = m_maxFiles - 1; i > 0; i--)
+    {
+        /* Atomic rename, replacing the oldest segment. Fails if the segment doesn't exist yet. */
+        MoveFileExW(GetSegmentPath(i - 1).c_str(), GetSegmentPath(i).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    }
+}
+
+void MBIMGUI::MBILogger::Rotate()
+{
+    CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+    ShiftSegments();
+
+    /* Prepared segment : only renamed, it is already opened and preallocated */
+    if (m_nextFile != INVALID_HANDLE_VALUE && MoveFileExW(GetNextSegmentPath().c_str(), GetSegmentPath(0).c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        m_file = m_nextFile;
+        m_nextFile = INVALID_HANDLE_VALUE;
+        m_fileSize = 0;
+        WriteHeader();
+        m_segmentStart = m_fileSize;
+        return;
+    }
+    DiscardNextSegment();
+
+    if (OpenLogFile(false))
+    {
+        WriteHeader();
+        m_segmentStart = m_fileSize;
+    }
+    else
+    {
+        m_logToFile = false;
+    }
+}
+
+void MBIMGUI::MBILogger::AppendLine(const MBILog &log, std::string &line) const
+{
+    /* Date and message formatting caches of each thread writing the logfile */
+    static thread_local MBILogTime fileTime;
+    static thread_local std::string buffer;
+    const char *level = log.GetLevelString();
+    const std::string &msg = log.GetMessageLog(buffer);
+
+    line += level;
+    line += '\t';
+    line += msg;
+    /* Message left aligned on 50 characters */
+    if (msg.size() < 50)
+    {
+        line.append(50 - msg.size(), ' ');
+    }
+    line += '\t';
+    line += fileTime.Format(log.GetTime(), m_precise);
+    line += '\n';
+}
+
+void MBIMGUI::MBILogger::AppendBinary(const MBILog &log, std::string &record)
+{
+    const uint8_t level = (uint8_t)log.GetLevel();
+    const int64_t time = log.GetTime();
+    const uint32_t thread = log.GetThread();
+    const uint32_t id = log.GetFormat();
+
+    /* Collapsed logs are written formatted, the record has no repeat count */
+    if (id == MBILogFormat::PLAIN_FORMAT || log.GetRepeat() > 1)
+    {
+        std::string buffer;
+        const std::string &msg = log.GetMessageLog(buffer);
+        const uint32_t length = (uint32_t)msg.size();
+        record += (char)MBILogReader::RECORD_MESSAGE;
+        record += (char)level;
+        record.append((const char *)&time, sizeof(time));
+        record.append((const char *)&thread, sizeof(thread));
+        record.append((const char *)&length, sizeof(length));
+        record += msg;
+        return;
+    }
+
+    /* Formats are written once per session, before their first log */
+    if (id >= m_formatsWritten.size())
+    {
+        m_formatsWritten.resize(id + 1, false);
+    }
+    if (!m_formatsWritten[id])
+    {
+        const char *format = MBILogFormat::Get(id);
+        const uint16_t length = (uint16_t)std::min<size_t>(strlen(format), UINT16_MAX);
+        record += (char)MBILogReader::RECORD_FORMAT;
+        record.append((const char *)&id, sizeof(id));
+        record.append((const char *)&length, sizeof(length));
+        record.append(format, length);
+        m_formatsWritten[id] = true;
+    }
+
+    const MBILogArgs &args = log.GetArgs();
+    record += (char)MBILogReader::RECORD_LOG;
+    record += (char)level;
+    record.append((const char *)&time, sizeof(time));
+    record.append((const char *)&thread, sizeof(thread));
+    record.append((const char *)&id, sizeof(id));
+    const uint32_t size = (uint32_t)args.size();
+    record.append((const char *)&size, sizeof(size));
+    record.append((const char *)args.data(), size);
+}
+
+void MBIMGUI::MBILogger::AppendRecord(const MBILog &log, std::string &content)
+{
+    const size_t previous = content.size();
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_binary)
+        {
+            AppendBinary(log, content);
+        }
+        else
+        {
+            AppendLine(log, content);
+        }
+
+        /* Rotate before a log overflowing the segment, unless the segment has no log yet. The log is encoded
+        again since a binary record relies on the formats written in its segment. */
+        if (m_maxFileSize == 0 || m_fileSize + content.size() <= m_maxFileSize || (previous == 0 && m_fileSize == m_segmentStart))
+        {
+            break;
+        }
+        content.resize(previous);
+        WriteRaw(content.data(), content.size());
+        content.clear();
+        Rotate();
+        if (!m_logToFile)
+        {
+            break;
+        }
+    }
+}
+
+MBIMGUI::MBILogger::Staging &MBIMGUI::MBILogger::GetStaging()
+{
+    /* Stagings of the calling thread, one per logger. Marked closed when the thread exits. */
+    struct ThreadStagings
+    {
+        std::vector<std::pair<uint64_t, std::shared_ptr<Staging>>> stagings;
+        ~ThreadStagings()
+        {
+            for (const auto &staging : stagings)
+            {
+                staging.second->closed.store(true, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local ThreadStagings threadStagings;
+
+    for (const auto &staging : threadStagings.stagings)
+    {
+        if (staging.first == m_instance)
+        {
+            return *staging.second;
+        }
+    }
+
+    /* First log of the thread */
+    std::shared_ptr<Staging> staging = std::make_shared<Staging>(m_stagingSize.load(std::memory_order_relaxed), (uint32_t)GetCurrentThreadId());
+    /* Owned by the logger, so never registered : the drain flushes it with the staging */
+    staging->site.m_logger = this;
+    {
+        std::lock_guard<std::mutex> lock(m_stagingsMutex);
+        m_stagings.push_back(staging);
+    }
+    threadStagings.stagings.emplace_back(m_instance, staging);
+    return *staging;
+}
+
+void MBIMGUI::MBILogger::Post(MBILog &&log)
+{
+    Staging &staging = GetStaging();
+    const MBILogLevel level = log.GetLevel();
+
+    log.SetThread(staging.thread);
+    while (!staging.queue.push(std::move(log)))
+    {
+        switch (m_overflow.load(std::memory_order_relaxed))
+        {
+        case LOG_OVERFLOW_BLOCK:
+            /* Make room by draining, sleeping on the drain mutex while the writer thread drains */
+            Drain();
+            break;
+        case LOG_OVERFLOW_COUNT:
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        default:
+        case LOG_OVERFLOW_DROP:
+            return;
+        }
+    }
+
+    /* Opt-in : the error is stored and written before returning, so a crash doesn't lose it */
+    if (level == LOG_LEVEL_ERROR && m_flushOnError.load(std::memory_order_relaxed))
+    {
+        Drain();
+    }
+}
+
+bool MBIMGUI::MBILogger::Repeat(MBILogSite &site, MBILogLevel level, uint32_t format, uint64_t hash, const uint8_t *data, size_t size, int64_t time)
+{
+    const uint32_t thread = GetStaging().thread;
+    Repeats repeats;
+    bool taken = false;
+    bool registering = false;
+
+    site.Lock();
+    const bool repeat = site.m_hasLast && site.m_hash == hash && site.m_level == (int32_t)level && site.m_format == format &&
+                        (data == nullptr || (site.m_size == size && memcmp(site.m_args, data, size) == 0));
+    if (repeat)
+    {
+        if (site.m_repeats == 0)
+        {
+            site.m_repeatStart = time;
+        }
+        site.m_repeats++;
+        site.m_repeatEnd = time;
+        if (time - site.m_repeatStart >= REPEAT_PERIOD_US)
+        {
+            taken = TakeRepeats(site, repeats);
+        }
+        else if (site.m_logger != this)
+        {
+            /* Flushed by the drain if the site stays quiet */
+            site.m_logger = this;
+            registering = true;
+        }
+    }
+    else
+    {
+        taken = TakeRepeats(site, repeats);
+        site.m_hash = hash;
+        site.m_level = (int32_t)level;
+        site.m_format = format;
+        site.m_thread = thread;
+        site.m_hasLast = (data != nullptr && size <= MBILogSite::REPEAT_SIZE);
+        if (site.m_hasLast)
+        {
+            memcpy(site.m_args, data, size);
+            site.m_size = (uint32_t)size;
+        }
+    }
+    site.Unlock();
+
+    if (registering)
+    {
+        std::lock_guard<std::mutex> lock(m_repeatSitesMutex);
+        m_repeatSites.push_back(&site);
+    }
+    if (taken)
+    {
+        /* Dated by this call, so the staging of the calling thread remains ordered */
+        MBILog log = RepeatLog(repeats);
+        log.SetTime(time);
+        Post(std::move(log));
+    }
+    return repeat;
+}
+
+void MBIMGUI::MBILogger::SetLastMessage(MBILogSite &site, std::string_view message) noexcept
+{
+    site.Lock();
+    if (message.size() <= MBILogSite::REPEAT_SIZE)
+    {
+        memcpy(site.m_args, message.data(), message.size());
+        site.m_size = (uint32_t)message.size();
+        site.m_hasLast = true;
+    }
+    site.Unlock();
+}
+
+bool MBIMGUI::MBILogger::TakeRepeats(MBILogSite &site, Repeats &repeats) noexcept
+{
+    if (site.m_repeats == 0)
+    {
+        return false;
+    }
+    repeats.level = (MBILogLevel)site.m_level;
+    repeats.format = site.m_format;
+    repeats.thread = site.m_thread;
+    repeats.count = site.m_repeats;
+    repeats.time = site.m_repeatEnd;
+    repeats.size = site.m_size;
+    memcpy(repeats.args, site.m_args, site.m_size);
+    site.m_repeats = 0;
+    return true;
+}
+
+MBIMGUI::MBILogger::MBILog MBIMGUI::MBILogger::RepeatLog(const Repeats &repeats)
+{
+    if (repeats.format == MBILogFormat::PLAIN_FORMAT)
+    {
+        MBILog log(repeats.level, std::string_view((const char *)repeats.args, repeats.size), repeats.time);
+        log.SetThread(repeats.thread);
+        log.SetRepeat(repeats.count);
+        return log;
+    }
+    MBILogArgs args;
+    args.Assign(repeats.args, repeats.size);
+    MBILog log(repeats.level, repeats.format, repeats.time, std::move(args));
+    log.SetThread(repeats.thread);
+    log.SetRepeat(repeats.count);
+    return log;
+}
+
+bool MBIMGUI::MBILogger::FlushSite(MBILogSite &site, int64_t now, bool force, bool registered)
+{
+    Repeats repeats;
+
+    site.Lock();
+    bool kept = (site.m_logger == this);
+    const bool taken = kept && (force || now - site.m_repeatStart >= REPEAT_PERIOD_US) && TakeRepeats(site, repeats);
+    if (kept && registered && site.m_repeats == 0)
+    {
+        /* Registered again by its next repeat */
+        site.m_logger = nullptr;
+        kept = false;
+    }
+    site.Unlock();
+
+    if (taken)
+    {
+        m_repeatLogs.push_back(RepeatLog(repeats));
+    }
+    return kept;
+}
+
+void MBIMGUI::MBILogger::DrainUnlocked(bool flushRepeats)
+{
+    std::string buffer;
+    MBILog drained;
+
+    const auto byDate = [](const MBILog &a, const MBILog &b)
+    { return a.GetTime() < b.GetTime(); };
+
+    /* Each staging is ordered, merge them by date */
+    m_merge.clear();
+    m_repeatLogs.clear();
+    const int64_t now = GetTimestamp();
+    {
+        std::lock_guard<std::mutex> lock(m_stagingsMutex);
+        for (size_t i = 0; i < m_stagings.size();)
+        {
+            Staging &staging = *m_stagings[i];
+            const bool closed = staging.closed.load(std::memory_order_acquire);
+            const size_t first = m_merge.size();
+            while (staging.queue.pop(drained))
+            {
+                m_merge.push_back(std::move(drained));
+            }
+            std::inplace_merge(m_merge.begin(), m_merge.begin() + first, m_merge.end(), byDate);
+
+            /* Repeats of a plain message which stopped being logged, or of an exited thread */
+            FlushSite(staging.site, now, closed || flushRepeats, false);
+
+            /* Exited threads can't push anymore */
+            if (closed)
+            {
+                m_stagings.erase(m_stagings.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    /* Repeats of the call sites which stopped logging. A site without repeats is unregistered. */
+    {
+        std::lock_guard<std::mutex> lock(m_repeatSitesMutex);
+        for (size_t i = 0; i < m_repeatSites.size();)
+        {
+            if (FlushSite(*m_repeatSites[i], now, flushRepeats, true))
+            {
+                i++;
+            }
+            else
+            {
+                m_repeatSites[i] = m_repeatSites.back();
+                m_repeatSites.pop_back();
+            }
+        }
+    }
+    if (!m_repeatLogs.empty())
+    {
+        const size_t first = m_merge.size();
+        std::sort(m_repeatLogs.begin(), m_repeatLogs.end(), byDate);
+        m_merge.insert(m_merge.end(), std::make_move_iterator(m_repeatLogs.begin()), std::make_move_iterator(m_repeatLogs.end()));
+        std::inplace_merge(m_merge.begin(), m_merge.begin() + first, m_merge.end(), byDate);
+    }
+
+    if (m_overflow.load(std::memory_order_relaxed) == LOG_OVERFLOW_COUNT)
+    {
+        const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_droppedReported)
+        {
+            m_merge.emplace_back(LOG_LEVEL_WARNING, std::to_string(dropped - m_droppedReported) + " logs dropped, log queue full", GetTimestamp());
+            m_droppedReported = dropped;
+        }
+    }
+
+    m_batch.clear();
+    for (const MBILog &log : m_merge)
+    {
+        if (log.GetLevel() == LOG_LEVEL_ERROR && m_popupOnError == true)
+        {
+            // Store last error to avoid race condition in case of multiple logs in the same frame
+            std::lock_guard<std::mutex> lock(m_popupMutex);
+            m_errToPopup = log.GetMessageLog(buffer);
+            m_displayPopup = true;
+        }
+        m_logs->push(log);
+        if (m_logToFile)
+        {
+            AppendRecord(log, m_batch);
+        }
+    }
+
+    /* One write for all the logs of the batch */
+    if (!m_batch.empty())
+    {
+        WriteRaw(m_batch.data(), m_batch.size());
+    }
+}
+
+void MBIMGUI::MBILogger::Drain(bool periodic)
+{
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    DrainUnlocked();
+    if (periodic)
+    {
+        PrepareNextSegment();
+    }
+}
+
+void MBIMGUI::MBILogger::Update()
+{
+    if (!m_async)
+    {
+        Drain(true);
+    }
+}
+
+std::string MBIMGUI::MBILogger::GetErrorToPopup() const
+{
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    return m_errToPopup;
+}
+
+void MBIMGUI::MBILogger::ClearErrorToPopup()
+{
+    std::lock_guard<std::mutex> lock(m_popupMutex);
+    m_errToPopup.clear();
+}
+
+void MBIMGUI::MBILogger::WriterThread()
+{
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    while (!m_stopWriter)
+    {
+        lock.unlock();
+        Drain(true);
+        lock.lock();
+        m_writerCv.wait_for(lock, std::chrono::milliseconds(WRITER_PERIOD_MS));
+    }
+    lock.unlock();
+    /* Logs pushed before the stop request */
+    Drain();
+}
+
+void MBIMGUI::MBILogger::StopWriter()
+{
+    if (m_writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_writerMutex);
+            m_stopWriter = true;
+        }
+        m_writerCv.notify_one();
+        m_writer.join();
+    }
+}
+
+/* Loggers created, gives the unique identifier of each logger */
+static std::atomic<uint64_t> s_loggerCount(0);
+
+MBIMGUI::MBILogger::MBILogger() : m_logs(std::make_unique<MBISyncCircularBuffer<MBILog>>(DEFAULT_HISTORY_SIZE)), m_logfile(""), m_file(INVALID_HANDLE_VALUE), m_nextFile(INVALID_HANDLE_VALUE), m_fileSize(0), m_segmentStart(0), m_maxFileSize(0), m_maxFiles(5),
+                                  m_popupOnError(false), m_displayPopup(false), m_logToFile(false), m_precise(false), m_binary(false),
+                                  m_startTime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+                                  m_startClock(std::chrono::steady_clock::now()), m_instance(s_loggerCount++), m_stagingSize(DEFAULT_STAGING_SIZE), m_async(false), m_overflow(LOG_OVERFLOW_BLOCK), m_flushOnError(false), m_dropped(0), m_droppedReported(0), m_stopWriter(false){};
 
 MBIMGUI::MBILogger::~MBILogger()
 {
+    m_async = false;
+    StopWriter();
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    DrainUnlocked(true);
     CloseLogFile();
 };
 
+void MBIMGUI::MBILogger::SetAsync(bool async, size_t queueSize, MBILogOverflow overflow)
+{
+    /* Write the pending logs before changing the mode */
+    m_async = false;
+    StopWriter();
+    Drain();
+
+    /* Only applies to the threads which didn't log yet */
+    m_stagingSize = queueSize;
+    m_overflow = overflow;
+    if (async)
+    {
+        m_stopWriter = false;
+        m_writer = std::thread(&MBILogger::WriterThread, this);
+        m_async = true;
+    }
+}
+
+void MBIMGUI::MBILogger::SetRotation(uint64_t maxFileSize, uint32_t maxFiles)
+{
+    /* Read by the drains to rotate */
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    m_maxFileSize = maxFileSize;
+    m_maxFiles = std::max(maxFiles, 1u);
+}
+
+void MBIMGUI::MBILogger::SetFlushOnError(bool flush) noexcept
+{
+    m_flushOnError = flush;
+}
+
+uint64_t MBIMGUI::MBILogger::GetDroppedCount() const noexcept
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void MBIMGUI::MBILogger::SetPreciseTime(bool precise) noexcept
+{
+    m_precise = precise;
+}
+
+void MBIMGUI::MBILogger::SetHistorySize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    m_logs = std::make_unique<MBISyncCircularBuffer<MBILog>>(std::clamp<size_t>(size, 1, MAX_HISTORY_SIZE));
+}
+
+int64_t MBIMGUI::MBILogger::GetTimestamp() const noexcept
+{
+    using namespace std::chrono;
+    if (m_precise)
+    {
+        /* Monotonic clock anchored on the wall clock date of the logger creation */
+        return m_startTime + duration_cast<microseconds>(steady_clock::now() - m_startClock).count();
+    }
+    else
+    {
+        return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    }
+}
+
 std::string MBIMGUI::MBILogger::GetLogFullFileName() const
 {
     if (m_logfile.empty())
@@ -78,58 +862,63 @@ std::string MBIMGUI::MBILogger::GetLogFullFileName() const
     }
 }
 
-void MBIMGUI::MBILogger::Configure(bool popupOnError, std::string_view logfile)
+void MBIMGUI::MBILogger::Configure(bool popupOnError, std::string_view logfile, bool binary)
 {
+    // The writer thread must not use the file while it is changed
+    const bool async = m_async;
+    m_async = false;
+    StopWriter();
+
+    std::unique_lock<std::mutex> lock(m_drainMutex);
+    bool openError = false;
+
+    // Pending logs are written to the previous file
+    DrainUnlocked();
+
     // Close previous openned file
     CloseLogFile();
+    m_binary = binary;
+    m_formatsWritten.clear();
 
     if (logfile != "")
     {
-        std::ios_base::openmode mode = std::fstream::out;
+        bool append = true;
+        m_logfile = logfile;
 
         if (std::filesystem::exists(logfile))
         {
-            // If file is large, truncate it
-            if (std::filesystem::file_size(logfile) > 4096)
+            // A file of the other format can't be appended to, it would be unreadable
+            const bool sameFormat = std::filesystem::file_size(logfile) == 0 || IsBinaryLogfile(logfile) == binary;
+            if (m_maxFileSize > 0)
             {
-                mode |= std::fstream::trunc;
+                // Start a new segment if the file is full or of the other format
+                if (!sameFormat || std::filesystem::file_size(logfile) >= m_maxFileSize)
+                {
+                    ShiftSegments();
+                    append = false;
+                }
             }
-            else
+            // If file is large or of the other format, truncate it
+            else if (!sameFormat || std::filesystem::file_size(logfile) > 4096)
             {
-                mode |= std::fstream::app;
+                append = false;
             }
         }
         else
         {
             std::filesystem::create_directories(std::filesystem::path(logfile).parent_path());
-            mode |= std::fstream::app;
         }
-        m_filestream.open(logfile, mode);
-        if (m_filestream.fail())
+        if (!OpenLogFile(append))
         {
             m_logToFile = false;
             m_logfile = "";
-            LogError(std::string("Can't open logfile ") + logfile.data());
+            openError = true;
         }
         else
         {
-            tm ltm;
-            time_t now = time(0);
-
-            m_filestream << "********************************************************************" << std::endl;
-            m_filestream << "************************** Session Start ***************************" << std::endl;
-
-            if (localtime_s(&ltm, &now) == 0)
-            {
-                m_filestream << std::right << std::setfill('0');
-                m_filestream << "**************************   " << std::setw(2) << ltm.tm_mday
-                             << "/" << std::setw(2) << (ltm.tm_mon + 1)
-                             << "/" << (ltm.tm_year + 1900)
-                             << "  ***************************" << std::endl;
-                m_filestream << "********************************************************************" << std::endl;
-            }
+            WriteHeader();
+            m_segmentStart = m_fileSize;
             m_logToFile = true;
-            m_logfile = logfile;
         }
     }
     else
@@ -138,34 +927,69 @@ void MBIMGUI::MBILogger::Configure(bool popupOnError, std::string_view logfile)
     }
 
     m_popupOnError = popupOnError;
+    lock.unlock();
+
+    if (openError)
+    {
+        LogError(std::string("Can't open logfile ") + logfile.data());
+    }
+
+    if (async)
+    {
+        m_stopWriter = false;
+        m_writer = std::thread(&MBILogger::WriterThread, this);
+        m_async = true;
+    }
 }
 
 void MBIMGUI::MBILogger::Log(MBILogLevel level, std::string_view msg)
 {
-    MBILog log = MBILog(level, msg);
-    m_logs.push(log);
-    if (level == LOG_LEVEL_ERROR && m_popupOnError == true)
-    {
-        m_displayPopup = true;
-        // Store last error to avoid race condition in case of multiple logs in the same frame
-        m_errToPopup = msg;
-    }
-    if (m_logToFile)
+    const int64_t time = GetTimestamp();
+    if (!Repeat(GetStaging().site, level, MBILogFormat::PLAIN_FORMAT, MBILogFormat::Hash(msg.data(), msg.size()), (const uint8_t *)msg.data(), msg.size(), time))
     {
-        m_filestream << log.GetLevelString() << "\t" << std::setfill(' ') << std::left << std::setw(50) << log.GetMessageLog() << "\t" << log.GetTime() << std::endl;
+        Post(MBILog(level, msg, time));
     }
 }
 
 void MBIMGUI::MBILogger::Log(MBILogLevel level, const char *msg, ...)
 {
     va_list args;
+    va_list argsCopy;
+    va_list argsHash;
     char str[256];
+    Staging &staging = GetStaging();
+    const int64_t time = GetTimestamp();
 
     va_start(args, msg);
-    vsnprintf(str, 256, msg, args);
-    va_end(args);
+    va_copy(argsCopy, args);
+    va_copy(argsHash, args);
 
-    Log(level, std::string(str));
+    /* Repeats detected from the format and the raw arguments, before formatting */
+    if (!Repeat(staging.site, level, MBILogFormat::PLAIN_FORMAT, MBILogFormat::Hash(msg, argsHash), nullptr, 0, time))
+    {
+        std::string longStr;
+        std::string_view message;
+        const int length = vsnprintf(str, sizeof(str), msg, args);
+        if (length >= (int)sizeof(str))
+        {
+            /* Message too long for the stack buffer */
+            longStr.resize(length);
+            vsnprintf(longStr.data(), length + 1, msg, argsCopy);
+            message = longStr;
+        }
+        else if (length >= 0)
+        {
+            message = std::string_view(str, length);
+        }
+        if (length >= 0)
+        {
+            SetLastMessage(staging.site, message);
+            Post(MBILog(level, message, time));
+        }
+    }
+    va_end(argsHash);
+    va_end(argsCopy);
+    va_end(args);
 }
 
 void MBIMGUI::MBILogger::LogError(std::string_view  msg) { Log(LOG_LEVEL_ERROR, msg); }
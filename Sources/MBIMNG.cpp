@@ -94,6 +94,9 @@ MBIMGUI::MBIMNG::MBIMNG(std::string_view name, int width, int height, MBIConfigF
                                                                                               m_openFileDialog(),
                                                                                               m_openFileHandler(nullptr),
                                                                                               m_dndActiv(false),
+                                                                                              m_wakeEvent(NULL),
+                                                                                              m_maxFps(60.0f),
+                                                                                              m_minFps(1.0f),
                                                                                               m_aboutWindow(nullptr),
                                                                                               m_logger(MBIMGUI::GetLogger())
 {
@@ -122,6 +125,9 @@ MBIMGUI::MBIMNG::MBIMNG(std::string_view name, int width, int height, MBIConfigF
 
     m_openFileDialog.SetTitle("Open file");
 
+    /* Auto reset event, set by RequestFrame */
+    m_wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+
     /* Option management : retreive all stored options */
     MBIMGUI::ReadAllOptions();
 }
@@ -132,6 +138,10 @@ MBIMGUI::MBIMNG::~MBIMNG()
     MBIMGUI::WriteAllOptions();
 
     delete m_pRenderer;
+    if (m_wakeEvent != NULL)
+    {
+        CloseHandle(m_wakeEvent);
+    }
     if (m_confFlags & MBIConfig_displayLogWindow)
     {
         /* Delete log window if exists */
@@ -322,6 +332,63 @@ inline void MBIMGUI::MBIMNG::ShowOptionWindow(bool &openWindow)
         openWindow = false;
 }
 
+void MBIMGUI::MBIMNG::WaitNextFrame()
+{
+    const FrameClock::duration framePeriod = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(1.0 / m_maxFps));
+    const FrameClock::duration idlePeriod = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(1.0 / m_minFps));
+
+    while (true)
+    {
+        const FrameClock::time_point now = FrameClock::now();
+        const FrameClock::time_point nextFrame = m_lastFrame + framePeriod;
+        const FrameClock::time_point idleFrame = m_lastFrame + idlePeriod;
+
+        /* Never exceed the max FPS. Inputs received meanwhile are processed by the next frame. */
+        if (now < nextFrame)
+        {
+            /* The wake event is auto-reset : a frame request consumed here must still be honored */
+            if (MsgWaitForMultipleObjectsEx(1, (HANDLE *)&m_wakeEvent, (DWORD)std::chrono::ceil<std::chrono::milliseconds>(nextFrame - now).count(), 0, 0) == WAIT_OBJECT_0)
+            {
+                m_animationEnd = FrameClock::now() + std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(ANIMATION_DURATION_S));
+            }
+            continue;
+        }
+        if (now < m_animationEnd || now >= idleFrame || DataChanged())
+        {
+            break;
+        }
+
+        /* Nothing to display : sleep until an input, a frame request, the idle deadline or the next data poll */
+        const FrameClock::duration timeout = (idleFrame - now < framePeriod) ? (idleFrame - now) : framePeriod;
+        const DWORD result = MsgWaitForMultipleObjectsEx(1, (HANDLE *)&m_wakeEvent, (DWORD)std::chrono::ceil<std::chrono::milliseconds>(timeout).count(), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        if (result == WAIT_OBJECT_0 || result == WAIT_OBJECT_0 + 1)
+        {
+            m_animationEnd = FrameClock::now() + std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(ANIMATION_DURATION_S));
+        }
+    }
+    m_lastFrame = FrameClock::now();
+}
+
+bool MBIMGUI::MBIMNG::DataChanged()
+{
+    bool changed = false;
+    for (DataSource &source : m_dataSources)
+    {
+        const uint64_t generation = source.getGeneration(source.source);
+        if (generation != source.generation)
+        {
+            source.generation = generation;
+            changed = true;
+        }
+    }
+    /* Running loaders append data and animate their spinner */
+    for (const MBIFileLoader *loader : m_fileLoaders)
+    {
+        changed = changed || (loader->GetState() == LOADER_RUNNING);
+    }
+    return changed;
+}
+
 /***
  *
  * PUBLIC Functions
@@ -404,6 +471,34 @@ void MBIMGUI::MBIMNG::EnableOpenMenu(const std::vector<std::string> &filters,
     }
 }
 
+void MBIMGUI::MBIMNG::AddFileLoader(MBIFileLoader *loader)
+{
+    m_fileLoaders.push_back(loader);
+}
+
+void MBIMGUI::MBIMNG::SetFramePacing(float maxFps, float minFps)
+{
+    m_maxFps = (maxFps > 1.0f) ? maxFps : 1.0f;
+    m_minFps = (minFps > 0.01f) ? minFps : 0.01f;
+    if (m_minFps > m_maxFps)
+    {
+        m_minFps = m_maxFps;
+    }
+}
+
+void MBIMGUI::MBIMNG::AddDataSource(MBIDataGenerationCb getGeneration, const void *source)
+{
+    m_dataSources.push_back({getGeneration, source, getGeneration(source)});
+}
+
+void MBIMGUI::MBIMNG::RequestFrame() noexcept
+{
+    if (m_wakeEvent != NULL)
+    {
+        SetEvent(m_wakeEvent);
+    }
+}
+
 void MBIMGUI::MBIMNG::SetAppIcon(int iconId)
 {
     // Specific for now
@@ -418,6 +513,12 @@ void MBIMGUI::MBIMNG::Show()
 
     while (!bQuit)
     {
+        /* Frame pacing : sleep while there is nothing new to display */
+        if (m_confFlags & MBIConfig_framePacing)
+        {
+            WaitNextFrame();
+        }
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
@@ -547,6 +648,13 @@ void MBIMGUI::MBIMNG::Show()
                     ImGui::MenuItem(ICON_FA_CHART_LINE " Graph user guide", NULL, &bShowGraphHelp);
                     ImGui::EndMenu();
                 }
+                /* Loading progress of the background file loaders */
+                for (size_t i = 0; i < m_fileLoaders.size(); i++)
+                {
+                    ImGui::PushID((int)i);
+                    m_fileLoaders[i]->DisplayProgress("##fileLoader");
+                    ImGui::PopID();
+                }
                 ImGui::EndMainMenuBar();
             }
             if (bShowAbout)
@@ -608,6 +716,15 @@ void MBIMGUI::MBIMNG::Show()
             m_openFileHandler(filename);
         }
 
+        /* Store the logs raised since last frame before the log window is displayed */
+        m_logger.Update();
+
+        /* Append data loaded in background before graphs are displayed */
+        for (MBIFileLoader *loader : m_fileLoaders)
+        {
+            loader->Update();
+        }
+
         /* Call windows */
         for (const auto &member : m_windows)
         {
@@ -634,6 +751,12 @@ void MBIMGUI::MBIMNG::Show()
         if (m_confFlags & MBIConfig_displayImPlotDemo)
             ImPlot::ShowDemoWindow();
 
+        /* Keep rendering while the user interacts with a widget (drag, text cursor blinking...) */
+        if (ImGui::IsAnyItemActive() || io.WantTextInput)
+        {
+            m_animationEnd = FrameClock::now() + std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(ANIMATION_DURATION_S));
+        }
+
         /* Rendering */
         ImGui::Render();
         m_pRenderer->Render();
@@ -5,6 +5,8 @@
 #include "implot.h"
 #include "MBIMGUI.h"
 #include "MBIPlotChart.h"
+#include "MBIDataRenderInfos.h"
+#include "MBICaptureFile.h"
 
 /**
  * @brief Display optimization : compute display data area size.
@@ -25,6 +27,13 @@ void MBIPlotChart::ComputeDataWindow(DataRender &dataRenderInfos, size_t &dataSi
 {
     if (dataRenderInfos.descriptor.bHidden == false)
     {
+        /* Non periodic data or missing samples : offsets can't be computed from the data period */
+        if (dataRenderInfos.dataPeriodMs == 0 || dataRenderInfos.channel->GetGaps(dataRenderInfos.dataPeriodMs, m_gapThreshold).HasTimeGaps())
+        {
+            dataRenderInfos.ComputeWindowByTime(m_xAxisRange, dataSize, dataOffset);
+            return;
+        }
+
         /* Get data range available */
         const double dataBegin = dataRenderInfos.data->front().m_time;
         const double dataEnd = dataRenderInfos.data->back().m_time;
@@ -113,17 +122,46 @@ void MBIPlotChart::ComputeDataWindow(DataRender &dataRenderInfos, size_t &dataSi
     }
 }
 
+void MBIPlotChart::SetupCurvesAxis(ImPlotRange &range, bool forced)
+{
+    /* ImPlot fits each axis to its own items : after a fit, only the curves axis moved and the x-axis follows it */
+    const bool curvesMoved = (m_xCurvesRange.Min != m_xCurvesStart.Min) || (m_xCurvesRange.Max != m_xCurvesStart.Max);
+    if (!forced && curvesMoved && range.Min == m_xStart.Min && range.Max == m_xStart.Max)
+    {
+        range = ImPlotRange(m_xCurvesRange.Min + m_xOrigin, m_xCurvesRange.Max + m_xOrigin);
+    }
+
+    /* Only a linear axis can be shifted, the curves axis of other scales is the x-axis itself */
+    const bool linear = (m_xAxisScale == ImPlotScale_Linear) || (m_xAxisScale == ImPlotScale_Time);
+    m_xOrigin = linear ? range.Min : 0.0;
+    m_xStart = range;
+    m_xCurvesRange = ImPlotRange(range.Min - m_xOrigin, range.Max - m_xOrigin);
+    m_xCurvesStart = m_xCurvesRange;
+
+    ImPlot::SetupAxis(ImAxis_X2, nullptr, ImPlotAxisFlags_NoDecorations | ImPlotAxisFlags_NoMenus);
+    if (!linear)
+    {
+        ImPlot::SetupAxisScale(ImAxis_X2, m_xAxisScale);
+    }
+    if (forced)
+    {
+        ImPlot::SetupAxisLimits(ImAxis_X2, m_xCurvesRange.Min, m_xCurvesRange.Max, ImGuiCond_Always);
+    }
+    else
+    {
+        ImPlot::SetupAxisLinks(ImAxis_X2, &m_xCurvesRange.Min, &m_xCurvesRange.Max);
+    }
+}
+
 void MBIPlotChart::Display(std::string_view label, ImVec2 size)
 {
     static bool nodata = true;
-    static bool logwarning = true;
 
-    UnitId unitList[3] = {DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT};
-    int unitCounter = 0;
-    bool bNewUnit = true;
     bool bAxesMoved = false;
     bool bDownSampled = false;
-    ImAxis axis = ImAxis_COUNT;
+
+    /* Apply the variables and markers changes posted by other threads */
+    ProcessCommands();
 
     /* Draw curves */
     if (ImPlot::BeginPlot(label.data(), size))
@@ -131,62 +169,31 @@ void MBIPlotChart::Display(std::string_view label, ImVec2 size)
         /* Set legend outside the graph, at the top */
         ImPlot::SetupLegend(ImPlotLocation_North, ImPlotLegendFlags_Outside);
 
-        /* Set x-axis */
+        /* Set x-axis, its range shared with the linked charts */
+        ImPlotRange &xRange = (m_linkGroup != nullptr) ? m_linkGroup->GetRange() : m_xAxisRange;
+        SetupCurvesAxis(xRange, false);
         ImPlot::SetupAxis(ImAxis_X1, "Time");
         ImPlot::SetupAxisScale(ImAxis_X1, m_xAxisScale);
+        ImPlot::SetupAxisLinks(ImAxis_X1, &xRange.Min, &xRange.Max);
 
-        /* If data available */
-        /* Setup axes */
-        for (auto it = m_vargaph.begin(); it != m_vargaph.end(); it++)
-        {
-            const DataDescriptor &dataDescriptor = GetDataDescriptor(*it);
-
-            bNewUnit = true;
-            /* Look for an existing variable with the same unit */
-            for (int i = 0; i < unitCounter; i++)
-            {
-                if (dataDescriptor.unit.first == unitList[i])
-                {
-                    axis = ImAxis_Y1 + i;
-                    bNewUnit = false;
-                    break;
-                }
-            }
-            /* If new Unit added, setup a new axe */
-            if (bNewUnit)
-            {
-                /* ImPlot can't manage more than 3 y-axes */
-                if (unitCounter < 3)
-                {
-                    axis = ImAxis_Y1 + unitCounter;
-                    unitList[unitCounter++] = dataDescriptor.unit.first;
-                    ImPlot::SetupAxis(axis, dataDescriptor.unit.second.c_str());
-                }
-                else
-                {
-                    axis = ImAxis_Y1;
-                    if (logwarning)
-                    {
-                        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_WARNING, "Maximum three different axes on the same graph supported");
-                        logwarning = false;
-                    }
-                }
-            }
-            /* Set y-axis for data */
-            GetDataRenderInfos(*it).descriptor.axis = axis;
-        }
+        /* Setup y-axes, units assignment is only rebuilt when variables or units changed */
+        SetupYAxes(m_varData);
 
         /* Set x-axis */
         DisplayMarkers(UNIT_TIME_X_AXIS);
 
         /* Draw all variables */
-        for (auto it = m_vargaph.begin(); it != m_vargaph.end(); it++)
+        for (size_t slot = 0; slot < m_varData.size(); slot++)
         {
             size_t dataSize = 0;
             int32_t dataOffset = 0;
-            const VarId varId = *it;
             /* Get data descriptor */
-            DataRender &dataRenderInfos = GetDataRenderInfos(varId);
+            DataRender &dataRenderInfos = m_varData.at(slot);
+            if (dataRenderInfos.descriptor.bOnGraph == false)
+            {
+                continue;
+            }
+            const VarId varId = m_varData.handle(slot);
             if (dataRenderInfos.data->empty() == false)
             {
                 /* If data has just been moved, force visibility */
@@ -195,51 +202,81 @@ void MBIPlotChart::Display(std::string_view label, ImVec2 size)
                     ImPlot::HideNextItem(false, ImPlotCond_Always);
                     dataRenderInfos.descriptor.bMoved = false;
                 }
-                /* Set y-axis and plot line color */
-                ImPlot::SetAxis(dataRenderInfos.descriptor.axis);
-                ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                /* Set y-axis, curves are plotted on the curves axis */
+                ImPlot::SetAxes(ImAxis_X2, dataRenderInfos.descriptor.axis);
 
-                /* With periodic data, we can try window optimisation */
-                if (dataRenderInfos.dataPeriodMs != 0)
+                /* Index gaps of the data (NaN, missing samples) */
+                DataGapIndex &gaps = dataRenderInfos.channel->GetGaps(dataRenderInfos.dataPeriodMs, m_gapThreshold);
+                gaps.Update(*dataRenderInfos.data, dataRenderInfos.dataPeriodMs, m_gapThreshold);
+
+                /* Window already computed this frame by a linked chart displaying the same data */
+                if (dataRenderInfos.descriptor.bHidden || dataRenderInfos.FindSharedWindow(m_xAxisRange, m_gapThreshold, dataSize, dataOffset) == false)
                 {
-                    /* Try to optimize large amount of data */
+                    /* Try to optimize large amount of data : only the displayed window is accessed */
                     ComputeDataWindow(dataRenderInfos, dataSize, dataOffset);
+                    /* Get gap free parts of the window, each one is drawn as a separated line */
+                    gaps.GetSegments(*dataRenderInfos.data, dataOffset, (int)dataSize, dataRenderInfos.visibleSegments);
+                    if (dataRenderInfos.descriptor.bHidden == false)
+                    {
+                        dataRenderInfos.ShareWindow(m_xAxisRange, m_gapThreshold, dataSize, dataOffset);
+                    }
                 }
-                else
-                {
-                    /* Draw full data range */
-                    dataSize = dataRenderInfos.data->size();
-                    dataOffset = 0;
-                }
+                dataRenderInfos.SetWindow(dataOffset, dataSize);
+
+                /* Lines submitted, at least one is needed for the legend */
+                int linesDrawn = 0;
+
                 /* Draw line even if data are hidden because PlotLine draws legend */
                 if (dataSize > m_downSamplingSize && m_activDownSampling == true)
                 {
                     /* Down sample data only if needed (avoid parsing whole data set each frame) */
                     if (m_dsUpdate == true)
                     {
-                        dataRenderInfos.DownSampleLTTB(dataOffset, (int)dataSize, (int)m_downSamplingSize);
+                        dataRenderInfos.DownSample(dataOffset, (int)dataSize, (int)m_downSamplingSize, m_gapThreshold);
+                    }
+                    dataRenderInfos.ToRelativeDownSampled(m_xOrigin);
+                    int segmentStart = 0;
+                    for (const int segmentSize : dataRenderInfos.dsSegments)
+                    {
+                        ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                        ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &dataRenderInfos.relData[segmentStart].x, &dataRenderInfos.relData[segmentStart].y, segmentSize, ImPlotLineFlags_None, 0, sizeof(ImVec2));
+                        segmentStart += segmentSize;
+                        linesDrawn++;
                     }
-                    ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &dataRenderInfos.dsData[0].m_time, dataRenderInfos.dsData[0].m_data, dataRenderInfos.dsData.Size, ImPlotLineFlags_None, 0, 2 * sizeof(double));
                     bDownSampled = true;
                 }
                 else
                 {
-                    /* No downsampling, simply window optimisation  */
-                    const DataContainer &datapoints = (*dataRenderInfos.data);
-                    ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &datapoints[dataOffset].m_time, &datapoints[dataOffset].m_data, dataSize, ImPlotLineFlags_None, 0, 2 * sizeof(double));
+                    /* No downsampling, simply window optimisation : the window is converted once to float32 points */
+                    dataRenderInfos.ToRelativeWindow(m_xOrigin);
+                    const int windowFirst = dataRenderInfos.visibleSegments.empty() ? 0 : dataRenderInfos.visibleSegments.front().offset;
+                    for (const DataSegment &segment : dataRenderInfos.visibleSegments)
+                    {
+                        const ImVec2 &point = dataRenderInfos.relData[segment.offset - windowFirst];
+                        ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                        ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &point.x, &point.y, segment.size, ImPlotLineFlags_None, 0, sizeof(ImVec2));
+                        linesDrawn++;
+                    }
+                }
+                /* Nothing drawn, still submit the item for the legend */
+                if (linesDrawn == 0)
+                {
+                    ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                    ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), (const float *)nullptr, (const float *)nullptr, 0);
                 }
+                /* Annotations, markers and limits are on the x-axis */
+                ImPlot::SetAxes(ImAxis_X1, dataRenderInfos.descriptor.axis);
 
                 /* Draw Annotation */
-                if (dataRenderInfos.descriptor.bShowAnnotations && dataRenderInfos.annotation != nullptr)
+                if (dataRenderInfos.descriptor.bShowAnnotations)
                 {
-                    auto it = dataRenderInfos.annotation->begin();
-                    while (it != dataRenderInfos.annotation->end() && it->m_x < m_xAxisRange.Max)
+                    if (dataRenderInfos.annotation != nullptr)
                     {
-                        if (it->m_x >= m_xAxisRange.Min)
-                        {
-                            ImPlot::Annotation(it->m_x, it->m_y, it->GetColor(), ImVec2(5, -5), false, it->GetLabel());
-                        }
-                        it++;
+                        DisplayAnnotations(dataRenderInfos, *dataRenderInfos.annotation);
+                    }
+                    else if (dataRenderInfos.compactAnnotation != nullptr)
+                    {
+                        DisplayAnnotations(dataRenderInfos, *dataRenderInfos.compactAnnotation);
                     }
                 }
             }
@@ -259,7 +296,7 @@ void MBIPlotChart::Display(std::string_view label, ImVec2 size)
             }
 
             /* Update y-axis range for next frame */
-            const ImAxis axisOffset = GetYAxisOffset(dataRenderInfos.descriptor.unit.first);
+            const ImAxis axisOffset = dataRenderInfos.descriptor.axis - ImAxis_Y1;
             const ImPlotRect plotLimits = ImPlot::GetPlotLimits(IMPLOT_AUTO, dataRenderInfos.descriptor.axis);
 
             /* If down sampling is active */
@@ -287,7 +324,7 @@ void MBIPlotChart::Display(std::string_view label, ImVec2 size)
         m_downSampled = bDownSampled;
 
         /* If no var, still display markers for no unit */
-        if (m_vargaph.empty())
+        if (m_varOnGraph == 0)
         {
             DisplayMarkers(UNIT_NONE);
         }
@@ -329,7 +366,15 @@ void MBIPlotChart::Display(std::string_view label, ImVec2 size)
 
 bool MBIPlotChart::RemoveVariable(const VarId &dataId)
 {
-    return (m_vargaph.erase(dataId) == 1);
+    DataDescriptor *const desc = const_cast<DataDescriptor *>(FindDataDescriptor(dataId));
+    if (desc == nullptr || desc->bOnGraph == false)
+    {
+        return false;
+    }
+    desc->bOnGraph = false;
+    m_varOnGraph--;
+    m_axesDirty = true;
+    return true;
 }
 
 void MBIPlotChart::SetVarName(const VarId &dataId, const std::string_view name)
@@ -357,6 +402,7 @@ void MBIPlotChart::SetVarUnit(const VarId &dataId, const DataUnit &unit)
     if (IsVariableOnGraph(dataId))
     {
         GetDataDescriptor(dataId).unit = unit;
+        m_axesDirty = true;
     }
 }
 
@@ -370,16 +416,41 @@ void MBIPlotChart::ToggleVarAnnotation(const VarId &dataId, bool activ)
 
 ImAxis MBIPlotChart::GetYAxisOffset(const UnitId &eUnit) const
 {
-    for (const VarId &data : m_vargaph)
+    for (int i = 0; i < m_axesCount; i++)
     {
-        if (GetDataDescriptor(data).unit.first == eUnit)
+        if (m_axesUnit[i] == eUnit)
         {
-            return GetDataDescriptor(data).axis - ImAxis_Y1;
+            return i;
         }
     }
     return ImAxis_COUNT;
 }
 
+ImAxis MBIPlotChart::AssignYAxis(const DataUnit &unit)
+{
+    static bool logwarning = true;
+
+    /* Look for an axis with the same unit */
+    const ImAxis axisOffset = GetYAxisOffset(unit.first);
+    if (axisOffset != ImAxis_COUNT)
+    {
+        return ImAxis_Y1 + axisOffset;
+    }
+    /* ImPlot can't manage more than 3 y-axes */
+    if (m_axesCount < 3)
+    {
+        m_axesUnit[m_axesCount] = unit.first;
+        m_axesLabel[m_axesCount] = unit.second;
+        return ImAxis_Y1 + m_axesCount++;
+    }
+    if (logwarning)
+    {
+        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_WARNING, "Maximum three different axes on the same graph supported");
+        logwarning = false;
+    }
+    return ImAxis_Y1;
+}
+
 const ImPlotRange &MBIPlotChart::GetYAxisRange(const UnitId &eUnit) const
 {
     ImAxis axisOffset = GetYAxisOffset(eUnit);
@@ -415,6 +486,16 @@ void MBIPlotChart::AddMarker(const Marker &marker)
     m_markers.push_back(marker);
 }
 
+void MBIPlotChart::SetAnnotationSpacing(float pixels) noexcept
+{
+    m_annotSpacing = pixels;
+}
+
+void MBIPlotChart::SetGapDetection(float periods) noexcept
+{
+    m_gapThreshold = periods;
+}
+
 void MBIPlotChart::SetDownSampling(bool bActiv, size_t size) noexcept
 {
     m_activDownSampling = bActiv;
@@ -424,42 +505,170 @@ void MBIPlotChart::SetDownSampling(bool bActiv, size_t size) noexcept
 
 void MBIPlotChart::AddDataAnnotations(const VarId &dataId, const AnnotContainer *const dataAnnotationPtr)
 {
-    GetDataRenderInfos(dataId).annotation = dataAnnotationPtr;
+    DataRender &dataRender = GetDataRenderInfos(dataId);
+    dataRender.annotation = dataAnnotationPtr;
+    dataRender.compactAnnotation = nullptr;
+    dataRender.annotIndex.Clear();
+}
+
+void MBIPlotChart::AddDataAnnotations(const VarId &dataId, const CompactAnnotContainer *const dataAnnotationPtr)
+{
+    DataRender &dataRender = GetDataRenderInfos(dataId);
+    dataRender.annotation = nullptr;
+    dataRender.compactAnnotation = dataAnnotationPtr;
+    dataRender.annotIndex.Clear();
 }
 
 void MBIPlotChart::AddVariable(const VarId &dataId)
 {
     if (dataId != 0)
     {
-        m_vargaph.insert(dataId);
+        DataDescriptor &desc = GetDataDescriptor(dataId);
+        if (desc.bOnGraph == false)
+        {
+            desc.bOnGraph = true;
+            m_varOnGraph++;
+            m_axesDirty = true;
+        }
 
         /* Force visibility */
-        GetDataDescriptor(dataId).bHidden = false;
-        GetDataDescriptor(dataId).bMoved = true;
+        desc.bHidden = false;
+        desc.bMoved = true;
     }
 }
 
 MBIPlotChart::VarId MBIPlotChart::CreateVariable(const DataContainer *const dataPtr, uint32_t period)
 {
-    DataRender *dataRender = nullptr;
-    const VarId id = MakeUUID();
+    return InsertVariable(MakeUUID(), dataPtr, period);
+}
+
+MBIPlotChart::VarId MBIPlotChart::InsertVariable(VarId id, const DataContainer *const dataPtr, uint32_t period)
+{
+    DataRender &dataRender = m_varData.insert(id, DataRender(dataPtr));
+    dataRender.dataPeriodMs = period;
+
+    AddVariable(id);
+
+    return id;
+}
+
+MBIPlotChart::VarId MBIPlotChart::PostCreateVariable(const DataContainer *const dataPtr, uint32_t period, std::string_view name)
+{
+    ChartCommand command;
+    command.type = ChartCommand::CMD_CREATE_VARIABLE;
+    command.id = MakeUUID();
+    command.data = dataPtr;
+    command.dataType = &typeid(DataContainer);
+    command.period = period;
+    command.name = name;
+    const VarId id = command.id;
+    m_commands.push(std::move(command));
+    return id;
+}
+
+void MBIPlotChart::PostAddVariable(const VarId &dataId)
+{
+    ChartCommand command;
+    command.type = ChartCommand::CMD_ADD_VARIABLE;
+    command.id = dataId;
+    m_commands.push(std::move(command));
+}
+
+void MBIPlotChart::PostRemoveVariable(const VarId &dataId)
+{
+    ChartCommand command;
+    command.type = ChartCommand::CMD_REMOVE_VARIABLE;
+    command.id = dataId;
+    m_commands.push(std::move(command));
+}
+
+void MBIPlotChart::PostVarName(const VarId &dataId, std::string_view name)
+{
+    ChartCommand command;
+    command.type = ChartCommand::CMD_VAR_NAME;
+    command.id = dataId;
+    command.name = name;
+    m_commands.push(std::move(command));
+}
 
-    /* Must alocate a new data renderer infos ? */
-    if (m_varData.find(id) == m_varData.end())
+void MBIPlotChart::PostAddMarker(const Marker &marker)
+{
+    ChartCommand command;
+    command.type = ChartCommand::CMD_ADD_MARKER;
+    command.marker = marker;
+    m_commands.push(std::move(command));
+}
+
+void MBIPlotChart::ProcessCommands()
+{
+    ChartCommand command;
+    while (m_commands.pop(command))
     {
-        dataRender = new DataRender(dataPtr);
-        dataRender->dataPeriodMs = period;
-        m_varData[id] = dataRender;
+        ApplyCommand(command);
     }
+}
 
-    AddVariable(id);
+void MBIPlotChart::ApplyCommand(ChartCommand &command)
+{
+    if (command.type == ChartCommand::CMD_CREATE_VARIABLE)
+    {
+        /* Posted through the interface of another chart type, e.g. from a base class pointer */
+        const DataContainer *const data = command.GetData<DataContainer>();
+        if (data == nullptr)
+        {
+            MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Variable %u ignored : data container not supported by the graph", command.id);
+            return;
+        }
+        InsertVariable(command.id, data, command.period);
+        if (command.name.empty() == false)
+        {
+            SetVarName(command.id, command.name);
+        }
+        return;
+    }
+    if (command.type == ChartCommand::CMD_ADD_MARKER)
+    {
+        AddMarker(command.marker);
+        return;
+    }
+    /* Variable removed or not created yet : ignore the command */
+    if (FindDataDescriptor(command.id) == nullptr)
+    {
+        return;
+    }
+    switch (command.type)
+    {
+    case ChartCommand::CMD_ADD_VARIABLE:
+        AddVariable(command.id);
+        break;
+    case ChartCommand::CMD_REMOVE_VARIABLE:
+        RemoveVariable(command.id);
+        break;
+    case ChartCommand::CMD_VAR_NAME:
+        SetVarName(command.id, command.name);
+        break;
+    default:
+        break;
+    }
+}
+
+MBIPlotChart::VarId MBIPlotChart::CreateVariable(const MBICaptureFile &file, size_t channel)
+{
+    const VarId id = CreateVariable(file.GetChannel(channel), file.GetChannelPeriod(channel));
+
+    /* Gap free channels are never read to be indexed, the other ones only on the displayed windows */
+    const bool continuous = file.IsChannelContinuous(channel);
+    GetDataRenderInfos(id).channel->SetContinuous(continuous);
+    GetDataRenderInfos(id).channel->SetLazyGaps(!continuous);
+    SetVarName(id, file.GetChannelName(channel));
 
     return id;
 }
 
 bool MBIPlotChart::IsVariableOnGraph(const VarId &dataId) const
 {
-    return (m_vargaph.find(dataId) != m_vargaph.end());
+    const DataDescriptor *const desc = FindDataDescriptor(dataId);
+    return (desc != nullptr) && desc->bOnGraph;
 }
 
 bool MBIPlotChart::IsVariableVisible(const VarId &dataId) const
@@ -474,43 +683,32 @@ bool MBIPlotChart::IsVariableValid(const VarId &dataId) const noexcept
 
 void MBIPlotChart::SetDataDescriptorHandle(const VarId &dataId, DataDescriptorHandle dataRender)
 {
-    if (m_varData.find(dataId) != m_varData.end())
-    {
-        delete m_varData.find(dataId)->second;
-    }
-    m_varData[dataId] = new DataRender((const DataRender *const)dataRender);
+    /* Keep the display state of a variable already known by this graph */
+    const bool onGraph = IsVariableOnGraph(dataId);
+    DataRender &render = m_varData.insert(dataId, DataRender((const DataRender *const)dataRender));
+    render.descriptor.bOnGraph = onGraph;
+    m_axesDirty = true;
 }
 
 MBIPlotChart::DataDescriptorHandle MBIPlotChart::GetDataDescriptorHandle(const VarId &dataId) const
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
-    {
-        return (it->second);
-    }
-    else
-    {
-        /* Return invalid data */
-        // return (m_varData.find(0xFFFFFFFF)->second);
-        throw std::out_of_range("Invalid VarId");
-    }
+    return &GetDataRenderInfos(dataId);
+}
+
+const DataDescriptor *MBIPlotChart::FindDataDescriptor(const VarId &dataId) const noexcept
+{
+    const DataRender *const render = m_varData.find(dataId);
+    return (render != nullptr) ? &render->descriptor : nullptr;
 }
 
 const DataDescriptor &MBIPlotChart::GetDataDescriptor(const VarId &dataId) const
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
+    const DataDescriptor *const desc = FindDataDescriptor(dataId);
+    if (desc == nullptr)
     {
-        return it->second->descriptor;
-    }
-    else
-    {
-        /* Return invalid data */
-        // return m_varData.find(0xFFFFFFFF)->second->descriptor;
         throw std::out_of_range("Invalid VarId");
     }
+    return *desc;
 }
 
 DataDescriptor &MBIPlotChart::GetDataDescriptor(const VarId &dataId)
@@ -521,18 +719,12 @@ DataDescriptor &MBIPlotChart::GetDataDescriptor(const VarId &dataId)
 
 const MBIPlotChart::DataRender &MBIPlotChart::GetDataRenderInfos(const VarId &dataId) const
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
+    const DataRender *const render = m_varData.find(dataId);
+    if (render == nullptr)
     {
-        return *(it->second);
-    }
-    else
-    {
-        /* Return invalid data */
-        // return *(m_varData.find(0xFFFFFFFF)->second);
         throw std::out_of_range("Invalid VarId");
     }
+    return *render;
 }
 
 MBIPlotChart::DataRender &MBIPlotChart::GetDataRenderInfos(const VarId &dataId)
@@ -546,6 +738,36 @@ bool MBIPlotChart::DataDownSampled() const noexcept
     return m_downSampled;
 }
 
+DownSampleCacheStats MBIPlotChart::GetDownSamplingCacheStats() const noexcept
+{
+    return SumDownSampleCacheStats(m_varData);
+}
+
+void MBIPlotChart::SetVariableModified(const VarId &dataId)
+{
+    GetDataRenderInfos(dataId).channel->Modified();
+}
+
+DataStats MBIPlotChart::GetVariableStats(const VarId &dataId, bool visibleOnly)
+{
+    return GetDataRenderInfos(dataId).GetStats(visibleOnly);
+}
+
+double MBIPlotChart::GetVariableQuantile(const VarId &dataId, double q, bool visibleOnly)
+{
+    return GetDataRenderInfos(dataId).GetQuantile(q, visibleOnly);
+}
+
+void MBIPlotChart::SetYAxesAutoFit(bool autoFit) noexcept
+{
+    m_yAutoFit = autoFit;
+}
+
+void MBIPlotChart::SetLinkGroup(MBIChartLinkGroup *group) noexcept
+{
+    m_linkGroup = group;
+}
+
 void MBIPlotChart::SetDnDCallback(std::string_view type, MBIPlotChart::MBIDndCb callback, void *arg) noexcept
 {
     m_callback = callback;
@@ -555,17 +777,26 @@ void MBIPlotChart::SetDnDCallback(std::string_view type, MBIPlotChart::MBIDndCb
 
 void MBIPlotChart::Reset() noexcept
 {
-    for (auto it : m_varData)
-        it.second->Clear();
+    for (DataRender &render : m_varData)
+        render.Clear();
     m_markers.clear();
 }
 
 MBIPlotChart::MBIPlotChart(ImPlotScale xAxisScale) : m_downSampled(false),
                                                      m_dsUpdate(true),
                                                      m_activDownSampling(false),
+                                                     m_gapThreshold(3.0f),
+                                                     m_annotSpacing(40.0f),
+                                                     m_yAutoFit(false),
+                                                     m_linkGroup(nullptr),
                                                      m_callback(nullptr),
                                                      m_xAxisRange{-10.0, 10.0},
-                                                     m_xAxisScale(xAxisScale)
+                                                     m_xAxisScale(xAxisScale),
+                                                     m_xOrigin(0.0),
+                                                     m_axesDirty(true),
+                                                     m_axesCount(0),
+                                                     m_axesUnit{DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT},
+                                                     m_varOnGraph(0)
 {
     /* Set default Y axis Range */
     m_yAxesRange[0] = ImPlotRange(0.0, 1.0);
@@ -573,8 +804,6 @@ MBIPlotChart::MBIPlotChart(ImPlotScale xAxisScale) : m_downSampled(false),
 
 MBIPlotChart::~MBIPlotChart()
 {
-    for (auto servData : m_varData)
-        delete servData.second;
 }
 
 inline void MBIPlotChart::DisplayMarkers(UnitId unit)
@@ -5,6 +5,7 @@
 #include "implot.h"
 #include "MBIMGUI.h"
 #include "MBIRealtimePlotChart.h"
+#include "MBIDataRenderInfos.h"
 
 /**
  * @brief Display optimization : compute display data area size.
@@ -25,6 +26,13 @@ inline void MBIRealtimePlotChart::ComputeDataWindow(DataRender &dataRenderInfos,
 {
     if (dataRenderInfos.descriptor.bHidden == false)
     {
+        /* Non periodic data or missing samples : offsets can't be computed from the data period */
+        if (dataRenderInfos.dataPeriodMs == 0 || dataRenderInfos.channel->GetGaps(dataRenderInfos.dataPeriodMs, m_gapThreshold).HasTimeGaps())
+        {
+            dataRenderInfos.ComputeWindowByTime(m_xAxisRange, dataSize, dataOffset);
+            return;
+        }
+
         /* Get data range available */
         const double dataBegin = dataRenderInfos.data->first().m_time;
         const double dataEnd = dataRenderInfos.data->last().m_time;
@@ -117,14 +125,12 @@ inline void MBIRealtimePlotChart::ComputeDataWindow(DataRender &dataRenderInfos,
 void MBIRealtimePlotChart::Display(double currentTimeS)
 {
     static bool nodata = true;
-    static bool logwarning = true;
 
-    UnitId unitList[3] = {DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT, DataDescriptor::INVALID_UNIT};
-    int unitCounter = 0;
-    bool bNewUnit = true;
     bool bAxesMoved = false;
     bool bDownSampled = false;
-    ImAxis axis = ImAxis_COUNT;
+
+    /* Apply the variables and markers changes posted by other threads */
+    ProcessCommands();
 
     /* Set legend outside the graph, at the top */
     ImPlot::SetupLegend(ImPlotLocation_North, ImPlotLegendFlags_Outside);
@@ -133,64 +139,37 @@ void MBIRealtimePlotChart::Display(double currentTimeS)
     ImPlot::SetupAxis(ImAxis_X1, "Time", ImPlotAxisFlags_NoMenus);
     ImPlot::SetupAxisLimits(ImAxis_X1, (currentTimeS - m_history), currentTimeS, (m_pause) ? ImGuiCond_Once : ImGuiCond_Always);
 
-    /* Link axis if requested */
+    /* Link axis if requested, to the group range if the chart is linked to other charts */
     if (m_pause)
     {
-        ImPlot::SetupAxisLinks(ImAxis_X1, &m_xAxisRange.Min, &m_xAxisRange.Max);
+        ImPlotRange &range = (m_linkGroup != nullptr) ? m_linkGroup->GetRange() : m_xAxisRange;
+        SetupCurvesAxis(range, false);
+        ImPlot::SetupAxisLinks(ImAxis_X1, &range.Min, &range.Max);
     }
-
-    /* If data available */
-    /* Setup axes */
-    for (auto it = m_vargaph.begin(); it != m_vargaph.end(); it++)
+    else
     {
-        const DataDescriptor &dataDescriptor = GetDataDescriptor(*it);
-
-        bNewUnit = true;
-        /* Look for an existing variable with the same unit */
-        for (int i = 0; i < unitCounter; i++)
-        {
-            if (dataDescriptor.unit.first == unitList[i])
-            {
-                axis = ImAxis_Y1 + i;
-                bNewUnit = false;
-                break;
-            }
-        }
-        /* If new Unit added, setup a new axe */
-        if (bNewUnit)
-        {
-            /* ImPlot can't manage more than 3 y-axes */
-            if (unitCounter < 3)
-            {
-                axis = ImAxis_Y1 + unitCounter;
-                unitList[unitCounter++] = dataDescriptor.unit.first;
-                ImPlot::SetupAxis(axis, dataDescriptor.unit.second.c_str());
-            }
-            else
-            {
-                axis = ImAxis_Y1;
-                if (logwarning)
-                {
-                    MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_WARNING, "Maximum three different axes on the same graph supported");
-                    logwarning = false;
-                }
-            }
-        }
-        /* Set y-axis for data */
-        GetDataRenderInfos(*it).descriptor.axis = axis;
+        ImPlotRange range(currentTimeS - m_history, currentTimeS);
+        SetupCurvesAxis(range, true);
     }
 
+    /* Setup y-axes, units assignment is only rebuilt when variables or units changed */
+    SetupYAxes(m_varData);
+
     /* Set x-axis */
     DisplayMarkers(UNIT_TIME_X_AXIS);
 
     /* Draw all variables */
-    for (auto it = m_vargaph.begin(); it != m_vargaph.end(); it++)
+    for (size_t slot = 0; slot < m_varData.size(); slot++)
     {
         size_t dataSize = 0;
         int32_t dataOffset = 0;
-        const VarId varId = *it;
         /* Get data descriptor */
-        DataRender &dataRenderInfos = GetDataRenderInfos(varId);
+        DataRender &dataRenderInfos = m_varData.at(slot);
+        if (dataRenderInfos.descriptor.bOnGraph == false)
+        {
+            continue;
+        }
+        const VarId varId = m_varData.handle(slot);
         if (dataRenderInfos.data->empty() == false)
         {
             /* If data is shown */
@@ -201,49 +180,88 @@ void MBIRealtimePlotChart::Display(double currentTimeS)
                 ImPlot::HideNextItem(false, ImPlotCond_Always);
                 dataRenderInfos.descriptor.bMoved = false;
             }
-            /* Set y-axis and plot line color */
-            ImPlot::SetAxis(dataRenderInfos.descriptor.axis);
-            ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+            /* Set y-axis, curves are plotted on the curves axis */
+            ImPlot::SetAxes(ImAxis_X2, dataRenderInfos.descriptor.axis);
+
+            /* Index gaps of the data (NaN, missing samples) */
+            DataGapIndex &gaps = dataRenderInfos.channel->GetGaps(dataRenderInfos.dataPeriodMs, m_gapThreshold);
+            gaps.Update(*dataRenderInfos.data, dataRenderInfos.dataPeriodMs, m_gapThreshold);
 
+            /* Window already computed this frame by a linked chart displaying the same data */
+            if (dataRenderInfos.descriptor.bHidden || dataRenderInfos.FindSharedWindow(m_xAxisRange, m_gapThreshold, dataSize, dataOffset) == false)
+            {
 #if 1
-            /* Try to optimize large amount of data */
-            ComputeDataWindow(dataRenderInfos, dataSize, dataOffset);
+                /* Try to optimize large amount of data */
+                ComputeDataWindow(dataRenderInfos, dataSize, dataOffset);
 #else
-            /* Draw full data range */
-            dataSize = dataRenderInfos.data->size();
-            dataOffset = 0;
+                /* Draw full data range */
+                dataSize = dataRenderInfos.data->size();
+                dataOffset = 0;
 #endif
+                /* Get gap free parts of the window, each one is drawn as a separated line */
+                gaps.GetSegments(*dataRenderInfos.data, dataOffset, (int)dataSize, dataRenderInfos.visibleSegments);
+                if (dataRenderInfos.descriptor.bHidden == false)
+                {
+                    dataRenderInfos.ShareWindow(m_xAxisRange, m_gapThreshold, dataSize, dataOffset);
+                }
+            }
+            dataRenderInfos.SetWindow(dataOffset, dataSize);
+
+            /* Lines submitted, at least one is needed for the legend */
+            int linesDrawn = 0;
 
-            dataRenderInfos.dataOffset = dataOffset;
             /* Draw line even if data are hidden because PlotLine draws legend */
             if (dataSize > m_downSamplingSize && m_activDownSampling == true && m_pause == false)
             {
                 /* Down sample data only if needed (avoid parsing whole data set each frame) */
                 if (m_dsUpdate == true)
                 {
-                    dataRenderInfos.DownSampleLTTB(dataOffset, (int)dataSize, (int)m_downSamplingSize);
+                    dataRenderInfos.DownSample(dataOffset, (int)dataSize, (int)m_downSamplingSize, m_gapThreshold);
+                }
+                dataRenderInfos.ToRelativeDownSampled(m_xOrigin);
+                int segmentStart = 0;
+                for (const int segmentSize : dataRenderInfos.dsSegments)
+                {
+                    ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                    ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &dataRenderInfos.relData[segmentStart].x, &dataRenderInfos.relData[segmentStart].y, segmentSize, ImPlotLineFlags_None, 0, sizeof(ImVec2));
+                    segmentStart += segmentSize;
+                    linesDrawn++;
                 }
-                ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &dataRenderInfos.dsData[0].m_time, &dataRenderInfos.dsData[0].m_data, dataRenderInfos.dsData.Size, ImPlotLineFlags_None, 0, 2 * sizeof(double));
                 bDownSampled = true;
             }
             else
             {
-                const DataContainer &datapoints = (*dataRenderInfos.data);
-                // WARNING: PlotLine using stride requires contiguous data storage type. This is not the case of the MBICircularBuffer, so we have to use DataGetter
-                ImPlot::PlotLineG(dataRenderInfos.descriptor.name.c_str(), DataGetter, (void *)&dataRenderInfos, (int)dataSize);
+                // WARNING: PlotLine using stride requires contiguous data storage type. This is not the case of the MBICircularBuffer,
+                // so the window is converted once into contiguous float32 points
+                dataRenderInfos.ToRelativeWindow(m_xOrigin);
+                const int windowFirst = dataRenderInfos.visibleSegments.empty() ? 0 : dataRenderInfos.visibleSegments.front().offset;
+                for (const DataSegment &segment : dataRenderInfos.visibleSegments)
+                {
+                    const ImVec2 &point = dataRenderInfos.relData[segment.offset - windowFirst];
+                    ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                    ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), &point.x, &point.y, segment.size, ImPlotLineFlags_None, 0, sizeof(ImVec2));
+                    linesDrawn++;
+                }
+            }
+            /* Nothing drawn, still submit the item for the legend */
+            if (linesDrawn == 0)
+            {
+                ImPlot::SetNextLineStyle(dataRenderInfos.descriptor.color);
+                ImPlot::PlotLine(dataRenderInfos.descriptor.name.c_str(), (const float *)nullptr, (const float *)nullptr, 0);
             }
+            /* Annotations, markers and limits are on the x-axis */
+            ImPlot::SetAxes(ImAxis_X1, dataRenderInfos.descriptor.axis);
 
             /* Draw Annotation */
-            if (dataRenderInfos.descriptor.bShowAnnotations && dataRenderInfos.annotation != nullptr)
+            if (dataRenderInfos.descriptor.bShowAnnotations)
             {
-                auto it = dataRenderInfos.annotation->cbegin();
-                while (it != dataRenderInfos.annotation->cend() && it->m_x < m_xAxisRange.Max)
+                if (dataRenderInfos.annotation != nullptr)
                 {
-                    if (it->m_x >= m_xAxisRange.Min)
-                    {
-                        ImPlot::Annotation(it->m_x, it->m_y, it->GetColor(), ImVec2(5, -5), false, it->GetLabel());
-                    }
-                    it++;
+                    DisplayAnnotations(dataRenderInfos, *dataRenderInfos.annotation);
+                }
+                else if (dataRenderInfos.compactAnnotation != nullptr)
+                {
+                    DisplayAnnotations(dataRenderInfos, *dataRenderInfos.compactAnnotation);
                 }
             }
         }
@@ -263,7 +281,7 @@ void MBIRealtimePlotChart::Display(double currentTimeS)
         }
 
         /* Update y-axis range for next frame */
-        const ImAxis axisOffset = GetYAxisOffset(dataRenderInfos.descriptor.unit.first);
+        const ImAxis axisOffset = dataRenderInfos.descriptor.axis - ImAxis_Y1;
         const ImPlotRect plotLimits = ImPlot::GetPlotLimits(IMPLOT_AUTO, dataRenderInfos.descriptor.axis);
 
         /* If down sampling is active */
@@ -290,7 +308,7 @@ void MBIRealtimePlotChart::Display(double currentTimeS)
     m_downSampled = bDownSampled;
 
     /* If no var, still display markers for no unit */
-    if (m_vargaph.empty())
+    if (m_varOnGraph == 0)
     {
         DisplayMarkers(UNIT_NONE);
     }
@@ -340,85 +358,118 @@ void MBIRealtimePlotChart::SetHistory(float history) noexcept
 
 void MBIRealtimePlotChart::AddDataAnnotations(const VarId &dataId, const MBISyncCircularBuffer<DataAnnotation> *const dataAnnotationPtr)
 {
-    GetDataRenderInfos(dataId).annotation = dataAnnotationPtr;
+    DataRender &dataRender = GetDataRenderInfos(dataId);
+    dataRender.annotation = dataAnnotationPtr;
+    dataRender.compactAnnotation = nullptr;
+    dataRender.annotIndex.Clear();
+}
+
+void MBIRealtimePlotChart::AddDataAnnotations(const VarId &dataId, const MBISyncCircularBuffer<CompactAnnotation> *const dataAnnotationPtr)
+{
+    DataRender &dataRender = GetDataRenderInfos(dataId);
+    dataRender.annotation = nullptr;
+    dataRender.compactAnnotation = dataAnnotationPtr;
+    dataRender.annotIndex.Clear();
+}
+
+DownSampleCacheStats MBIRealtimePlotChart::GetDownSamplingCacheStats() const noexcept
+{
+    return SumDownSampleCacheStats(m_varData);
+}
+
+void MBIRealtimePlotChart::SetVariableModified(const VarId &dataId)
+{
+    GetDataRenderInfos(dataId).channel->Modified();
+}
+
+DataStats MBIRealtimePlotChart::GetVariableStats(const VarId &dataId, bool visibleOnly)
+{
+    return GetDataRenderInfos(dataId).GetStats(visibleOnly);
+}
+
+double MBIRealtimePlotChart::GetVariableQuantile(const VarId &dataId, double q, bool visibleOnly)
+{
+    return GetDataRenderInfos(dataId).GetQuantile(q, visibleOnly);
 }
 
 MBIRealtimePlotChart::VarId MBIRealtimePlotChart::CreateVariable(const DataContainer *const dataPtr, uint32_t period)
 {
-    DataRender *dataRender = nullptr;
-    const VarId id = MakeUUID();
+    return InsertVariable(MakeUUID(), dataPtr, period);
+}
 
-    /* Must alocate a new data renderer infos ? */
-    if (m_varData.find(id) == m_varData.end())
-    {
-        dataRender = new DataRender(dataPtr);
-        dataRender->dataPeriodMs = period;
-        m_varData[id] = dataRender;
-    }
+MBIRealtimePlotChart::VarId MBIRealtimePlotChart::InsertVariable(VarId id, const DataContainer *const dataPtr, uint32_t period)
+{
+    DataRender &dataRender = m_varData.insert(id, DataRender(dataPtr));
+    dataRender.dataPeriodMs = period;
 
     AddVariable(id);
 
     return id;
 }
 
-void MBIRealtimePlotChart::SetDataDescriptorHandle(const VarId &dataId, DataDescriptorHandle dataRender)
+MBIRealtimePlotChart::VarId MBIRealtimePlotChart::PostCreateVariable(const DataContainer *const dataPtr, uint32_t period, std::string_view name)
 {
-    if (m_varData.find(dataId) != m_varData.end())
-    {
-        delete m_varData.find(dataId)->second;
-    }
-    m_varData[dataId] = new DataRender((const DataRender *const)dataRender);
+    ChartCommand command;
+    command.type = ChartCommand::CMD_CREATE_VARIABLE;
+    command.id = MakeUUID();
+    command.data = dataPtr;
+    command.dataType = &typeid(DataContainer);
+    command.period = period;
+    command.name = name;
+    const VarId id = command.id;
+    m_commands.push(std::move(command));
+    return id;
 }
 
-MBIRealtimePlotChart::DataDescriptorHandle MBIRealtimePlotChart::GetDataDescriptorHandle(const VarId &dataId) const
+void MBIRealtimePlotChart::ApplyCommand(ChartCommand &command)
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
+    if (command.type == ChartCommand::CMD_CREATE_VARIABLE)
     {
-        return (it->second);
-    }
-    else
-    {
-        /* Return invalid data */
-        return (m_varData.find(0xFFFFFFFF)->second);
+        /* Posted through the interface of another chart type, e.g. from a base class pointer */
+        const DataContainer *const data = command.GetData<DataContainer>();
+        if (data == nullptr)
+        {
+            MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Variable %u ignored : data container not supported by the graph", command.id);
+            return;
+        }
+        InsertVariable(command.id, data, command.period);
+        if (command.name.empty() == false)
+        {
+            SetVarName(command.id, command.name);
+        }
+        return;
     }
+    MBIPlotChart::ApplyCommand(command);
 }
 
-const DataDescriptor &MBIRealtimePlotChart::GetDataDescriptor(const VarId &dataId) const
+void MBIRealtimePlotChart::SetDataDescriptorHandle(const VarId &dataId, DataDescriptorHandle dataRender)
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
-    {
-        return it->second->descriptor;
-    }
-    else
-    {
-        /* Return invalid data */
-        return m_varData.find(0xFFFFFFFF)->second->descriptor;
-    }
+    /* Keep the display state of a variable already known by this graph */
+    const bool onGraph = IsVariableOnGraph(dataId);
+    DataRender &render = m_varData.insert(dataId, DataRender((const DataRender *const)dataRender));
+    render.descriptor.bOnGraph = onGraph;
+    m_axesDirty = true;
 }
 
-DataDescriptor &MBIRealtimePlotChart::GetDataDescriptor(const VarId &dataId)
+MBIRealtimePlotChart::DataDescriptorHandle MBIRealtimePlotChart::GetDataDescriptorHandle(const VarId &dataId) const
 {
-    /* Force calling const impl by casting this as const */
-    return const_cast<DataDescriptor &>(const_cast<const MBIRealtimePlotChart *>(this)->GetDataDescriptor(dataId));
+    return &GetDataRenderInfos(dataId);
+}
+
+const DataDescriptor *MBIRealtimePlotChart::FindDataDescriptor(const VarId &dataId) const noexcept
+{
+    const DataRender *const render = m_varData.find(dataId);
+    return (render != nullptr) ? &render->descriptor : nullptr;
 }
 
 const MBIRealtimePlotChart::DataRender &MBIRealtimePlotChart::GetDataRenderInfos(const VarId &dataId) const
 {
-    /* Return data */
-    auto it = m_varData.find(dataId);
-    if (it != m_varData.end())
-    {
-        return *(it->second);
-    }
-    else
+    const DataRender *const render = m_varData.find(dataId);
+    if (render == nullptr)
     {
-        /* Return invalid data */
-        return *(m_varData.find(0xFFFFFFFF)->second);
+        throw std::out_of_range("Invalid VarId");
     }
+    return *render;
 }
 
 MBIRealtimePlotChart::DataRender &MBIRealtimePlotChart::GetDataRenderInfos(const VarId &dataId)
@@ -430,14 +481,8 @@ MBIRealtimePlotChart::DataRender &MBIRealtimePlotChart::GetDataRenderInfos(const
 MBIRealtimePlotChart::MBIRealtimePlotChart() : m_pause(true),
                                                m_history(10.0)
 {
-    /* Create default invalid data descriptor */
-    DataRender *dataRender = new DataRender(nullptr, false);
-    dataRender->dataPeriodMs = 0;
-    m_varData[0xFFFFFFFF] = dataRender;
 }
 
 MBIRealtimePlotChart::~MBIRealtimePlotChart()
 {
-    for (auto servData : m_varData)
-        delete servData.second;
 }
@@ -0,0 +1,216 @@
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include "MBIMGUI.h"
+#include "MBIRecorder.h"
+
+MBIRecorder::MBIRecorder() noexcept : m_file(INVALID_HANDLE_VALUE),
+                                      m_drainPeriodMs(100),
+                                      m_syncPeriodMs(2000),
+                                      m_written(0),
+                                      m_recording(false),
+                                      m_stop(false)
+{
+}
+
+MBIRecorder::~MBIRecorder()
+{
+    Stop();
+}
+
+size_t MBIRecorder::AddChannel(const Channel *channel, std::string_view name, uint32_t periodMs)
+{
+    if (m_recording)
+    {
+        return SIZE_MAX;
+    }
+    std::unique_ptr<RecordedChannel> recorded = std::make_unique<RecordedChannel>();
+    recorded->buffer = channel;
+    recorded->name = name;
+    recorded->periodMs = periodMs;
+    recorded->next = 0;
+    recorded->recorded = 0;
+    recorded->dropped = 0;
+    m_channels.push_back(std::move(recorded));
+    return m_channels.size() - 1;
+}
+
+bool MBIRecorder::Start(const std::filesystem::path &path, uint32_t drainPeriodMs, uint32_t syncPeriodMs)
+{
+    Stop();
+
+    m_file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Can't create recording file %s", path.string().c_str());
+        return false;
+    }
+    m_path = path;
+    m_drainPeriodMs = std::max(drainPeriodMs, 1u);
+    m_syncPeriodMs = syncPeriodMs;
+    m_written = 0;
+
+    FileHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.channelCount = (uint32_t)m_channels.size();
+    bool success = Write(&header, sizeof(header));
+    for (const auto &channel : m_channels)
+    {
+        ChannelHeader channelHeader = {};
+        strncpy_s(channelHeader.name, channel->name.c_str(), CHANNEL_NAME_SIZE - 1);
+        channelHeader.periodMs = channel->periodMs;
+        success = success && Write(&channelHeader, sizeof(channelHeader));
+
+        /* Only samples pushed from now are recorded */
+        channel->next = channel->buffer->pushed();
+        channel->recorded = 0;
+        channel->dropped = 0;
+    }
+    if (!success)
+    {
+        MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Can't write recording file %s", path.string().c_str());
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    m_stop = false;
+    m_recording = true;
+    m_thread = std::thread(&MBIRecorder::RecordThread, this);
+    return true;
+}
+
+void MBIRecorder::Stop() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        FlushFileBuffers(m_file);
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+
+        uint64_t dropped = 0;
+        for (const auto &channel : m_channels)
+        {
+            dropped += channel->dropped;
+        }
+        if (dropped > 0)
+        {
+            MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_WARNING, "Recording %s : %llu samples dropped", m_path.string().c_str(), (unsigned long long)dropped);
+        }
+    }
+    m_recording = false;
+}
+
+bool MBIRecorder::IsRecording() const noexcept
+{
+    return m_recording;
+}
+
+size_t MBIRecorder::GetChannelCount() const noexcept
+{
+    return m_channels.size();
+}
+
+uint64_t MBIRecorder::GetRecordedCount(size_t channel) const
+{
+    return m_channels.at(channel)->recorded;
+}
+
+uint64_t MBIRecorder::GetDroppedCount(size_t channel) const
+{
+    return m_channels.at(channel)->dropped;
+}
+
+uint64_t MBIRecorder::GetBytesWritten() const noexcept
+{
+    return m_written;
+}
+
+void MBIRecorder::RecordThread()
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<DataPoint> samples;
+    clock::time_point lastSync = clock::now();
+    bool stop = false;
+
+    while (!stop)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(m_drainPeriodMs), [this]
+                          { return m_stop; });
+            stop = m_stop;
+        }
+        /* Samples pushed just before the stop request are drained too */
+        if (Drain(samples) == false)
+        {
+            m_recording = false;
+            break;
+        }
+
+        /* Batch the flushes to disk, they are far more expensive than the writes */
+        if (clock::now() - lastSync >= std::chrono::milliseconds(m_syncPeriodMs))
+        {
+            FlushFileBuffers(m_file);
+            lastSync = clock::now();
+        }
+    }
+}
+
+bool MBIRecorder::Drain(std::vector<DataPoint> &samples)
+{
+    for (size_t c = 0; c < m_channels.size(); c++)
+    {
+        RecordedChannel &channel = *m_channels[c];
+
+        samples.clear();
+        const uint64_t first = channel.buffer->copy_since(channel.next, samples);
+        uint64_t dropped = first - channel.next;
+        channel.dropped += dropped;
+        channel.next = first + samples.size();
+
+        for (size_t offset = 0; offset < samples.size(); offset += MAX_CHUNK_SAMPLES)
+        {
+            const size_t count = std::min(samples.size() - offset, MAX_CHUNK_SAMPLES);
+            ChunkHeader header;
+            header.magic = CHUNK_MAGIC;
+            header.channel = (uint32_t)c;
+            header.count = (uint32_t)count;
+            header.dropped = (uint32_t)std::min<uint64_t>(dropped, UINT32_MAX);
+            header.tMin = samples[offset].m_time;
+            header.tMax = samples[offset + count - 1].m_time;
+            dropped = 0;
+
+            if (!Write(&header, sizeof(header)) || !Write(&samples[offset], count * sizeof(DataPoint)))
+            {
+                MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Error while writing recording file %s, recording stopped", m_path.string().c_str());
+                return false;
+            }
+            channel.recorded += count;
+        }
+    }
+    return true;
+}
+
+bool MBIRecorder::Write(const void *data, size_t size) noexcept
+{
+    DWORD written = 0;
+    if (WriteFile(m_file, data, (DWORD)size, &written, NULL) == FALSE || written != (DWORD)size)
+    {
+        return false;
+    }
+    m_written += size;
+    return true;
+}
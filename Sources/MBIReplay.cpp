@@ -0,0 +1,369 @@
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "MBIMGUI.h"
+#include "MBIReplay.h"
+
+MBIReplay::MBIReplay() noexcept : m_file(INVALID_HANDLE_VALUE),
+                                  m_mapping(NULL),
+                                  m_view(nullptr),
+                                  m_startTime(0),
+                                  m_endTime(0),
+                                  m_playing(false),
+                                  m_stop(false),
+                                  m_speed(1.0),
+                                  m_baseTime(0),
+                                  m_pushed(0),
+                                  m_throughput(0)
+{
+}
+
+MBIReplay::~MBIReplay()
+{
+    Close();
+}
+
+bool MBIReplay::Open(const std::filesystem::path &path)
+{
+    LARGE_INTEGER fileSize;
+
+    Close();
+
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return Fail(path, "can't open file");
+    }
+    if (GetFileSizeEx(m_file, &fileSize) == FALSE || fileSize.QuadPart < (LONGLONG)sizeof(MBIRecorder::FileHeader))
+    {
+        return Fail(path, "file too small");
+    }
+    const uint64_t size = (uint64_t)fileSize.QuadPart;
+    m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping == NULL)
+    {
+        return Fail(path, "can't map file");
+    }
+    m_view = (const uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_view == nullptr)
+    {
+        return Fail(path, "can't map file");
+    }
+
+    /* Check headers */
+    const MBIRecorder::FileHeader *const header = (const MBIRecorder::FileHeader *)m_view;
+    if (memcmp(header->magic, MBIRecorder::MAGIC, sizeof(MBIRecorder::MAGIC)) != 0)
+    {
+        return Fail(path, "not a recording");
+    }
+    if (header->version != MBIRecorder::FORMAT_VERSION)
+    {
+        return Fail(path, "unsupported format version");
+    }
+    uint64_t offset = sizeof(MBIRecorder::FileHeader);
+    if ((size - offset) / sizeof(MBIRecorder::ChannelHeader) < header->channelCount)
+    {
+        return Fail(path, "truncated channel table");
+    }
+    m_channels.resize(header->channelCount);
+    for (ReplayedChannel &channel : m_channels)
+    {
+        channel.header = (const MBIRecorder::ChannelHeader *)(m_view + offset);
+        channel.buffer = nullptr;
+        channel.chunk = 0;
+        channel.sample = 0;
+        offset += sizeof(MBIRecorder::ChannelHeader);
+    }
+
+    /* Build the time index from the chunk headers, stopping at the first incomplete chunk */
+    m_startTime = std::numeric_limits<double>::max();
+    m_endTime = std::numeric_limits<double>::lowest();
+    while (size - offset >= sizeof(MBIRecorder::ChunkHeader))
+    {
+        const MBIRecorder::ChunkHeader *const chunk = (const MBIRecorder::ChunkHeader *)(m_view + offset);
+        const uint64_t chunkSize = sizeof(MBIRecorder::ChunkHeader) + (uint64_t)chunk->count * sizeof(DataPoint);
+        if (chunk->magic != MBIRecorder::CHUNK_MAGIC || chunk->channel >= m_channels.size() || size - offset < chunkSize)
+        {
+            break;
+        }
+        if (chunk->count > 0)
+        {
+            m_channels[chunk->channel].chunks.push_back({(const DataPoint *)(chunk + 1), chunk->count, chunk->tMax});
+            m_startTime = std::min(m_startTime, chunk->tMin);
+            m_endTime = std::max(m_endTime, chunk->tMax);
+        }
+        offset += chunkSize;
+    }
+    if (m_startTime > m_endTime)
+    {
+        m_startTime = 0;
+        m_endTime = 0;
+    }
+
+    m_playing = false;
+    m_stop = false;
+    m_speed = 1.0;
+    m_baseTime = m_startTime;
+    m_baseWall = clock::now();
+    m_pushed = 0;
+    m_throughput = 0;
+    m_thread = std::thread(&MBIReplay::ReplayThread, this);
+    return true;
+}
+
+void MBIReplay::Close() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    m_channels.clear();
+    if (m_view != nullptr)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping != NULL)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_playing = false;
+}
+
+size_t MBIReplay::GetChannelCount() const noexcept
+{
+    return m_channels.size();
+}
+
+std::string_view MBIReplay::GetChannelName(size_t channel) const
+{
+    const MBIRecorder::ChannelHeader &header = *m_channels.at(channel).header;
+    return std::string_view(header.name, strnlen(header.name, MBIRecorder::CHANNEL_NAME_SIZE));
+}
+
+uint32_t MBIReplay::GetChannelPeriod(size_t channel) const
+{
+    return m_channels.at(channel).header->periodMs;
+}
+
+void MBIReplay::SetChannel(size_t channel, Channel *buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_channels.at(channel).buffer = buffer;
+}
+
+double MBIReplay::GetStartTime() const noexcept
+{
+    return m_startTime;
+}
+
+double MBIReplay::GetEndTime() const noexcept
+{
+    return m_endTime;
+}
+
+void MBIReplay::Play()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_playing || m_view == nullptr)
+        {
+            return;
+        }
+        m_baseWall = clock::now();
+        m_playing = true;
+    }
+    m_cv.notify_all();
+}
+
+void MBIReplay::Pause()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_playing)
+    {
+        const clock::time_point now = clock::now();
+        m_baseTime = GetTimeUnlocked(now);
+        m_baseWall = now;
+        m_playing = false;
+    }
+}
+
+bool MBIReplay::IsPlaying() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_playing;
+}
+
+void MBIReplay::Seek(double timeS, bool resetChannels)
+{
+    std::lock_guard<std::mutex> pushLock(m_pushMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    timeS = std::clamp(timeS, m_startTime, m_endTime);
+    for (ReplayedChannel &channel : m_channels)
+    {
+        /* First chunk ending at or after the time, then first sample at or after the time in this chunk */
+        const auto chunk = std::lower_bound(channel.chunks.begin(), channel.chunks.end(), timeS, [](const Chunk &c, double t)
+                                            { return c.tMax < t; });
+        channel.chunk = (size_t)(chunk - channel.chunks.begin());
+        channel.sample = 0;
+        if (chunk != channel.chunks.end())
+        {
+            const DataPoint *const sample = std::lower_bound(chunk->samples, chunk->samples + chunk->count, timeS, [](const DataPoint &p, double t)
+                                                             { return p.m_time < t; });
+            channel.sample = (uint32_t)(sample - chunk->samples);
+        }
+        if (resetChannels && channel.buffer != nullptr)
+        {
+            channel.buffer->reset();
+        }
+    }
+    m_baseTime = timeS;
+    m_baseWall = clock::now();
+}
+
+void MBIReplay::SetSpeed(double speed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    /* Rebase the clock so the simulated time stays continuous */
+    const clock::time_point now = clock::now();
+    m_baseTime = GetTimeUnlocked(now);
+    m_baseWall = now;
+    m_speed = std::clamp(speed, MIN_SPEED, MAX_SPEED);
+}
+
+double MBIReplay::GetSpeed() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_speed;
+}
+
+double MBIReplay::GetTime() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetTimeUnlocked(clock::now());
+}
+
+uint64_t MBIReplay::GetPushedCount() const noexcept
+{
+    return m_pushed;
+}
+
+double MBIReplay::GetThroughput() const noexcept
+{
+    return m_throughput;
+}
+
+double MBIReplay::GetTimeUnlocked(clock::time_point now) const noexcept
+{
+    if (!m_playing)
+    {
+        return m_baseTime;
+    }
+    const double elapsed = std::chrono::duration<double>(now - m_baseWall).count();
+    return std::min(m_baseTime + elapsed * m_speed, m_endTime);
+}
+
+void MBIReplay::ReplayThread()
+{
+    clock::time_point windowStart = clock::now();
+    uint64_t windowPushed = 0;
+    bool stop = false;
+
+    while (!stop)
+    {
+        /* Held while pushing so a Seek can't reset the channels between the cursors update and the pushes */
+        std::lock_guard<std::mutex> pushLock(m_pushMutex);
+        uint64_t pushed = 0;
+        m_spans.clear();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(TICK_MS), [this]
+                          { return m_stop; });
+            stop = m_stop;
+            const clock::time_point now = clock::now();
+
+            if (m_playing && !stop)
+            {
+                const double timeS = GetTimeUnlocked(now);
+                for (ReplayedChannel &channel : m_channels)
+                {
+                    pushed += CollectUntil(channel, timeS);
+                }
+
+                /* End of the recording : freeze the clock on the last sample */
+                if (timeS >= m_endTime)
+                {
+                    m_baseTime = m_endTime;
+                    m_baseWall = now;
+                    m_playing = false;
+                }
+            }
+        }
+
+        /* Samples pushed without m_mutex, one batch per chunk */
+        for (const Span &span : m_spans)
+        {
+            span.buffer->push(span.samples, span.count);
+        }
+        m_pushed += pushed;
+        windowPushed += pushed;
+
+        const clock::time_point now = clock::now();
+        const double window = std::chrono::duration<double>(now - windowStart).count();
+        if (window >= 1.0)
+        {
+            m_throughput = (double)windowPushed / window;
+            windowPushed = 0;
+            windowStart = now;
+        }
+    }
+}
+
+uint64_t MBIReplay::CollectUntil(ReplayedChannel &channel, double timeS)
+{
+    uint64_t pushed = 0;
+    if (channel.buffer == nullptr)
+    {
+        return 0;
+    }
+    while (channel.chunk < channel.chunks.size())
+    {
+        const Chunk &chunk = channel.chunks[channel.chunk];
+        /* Samples of the chunk up to the time, they are sorted */
+        const DataPoint *const end = std::upper_bound(chunk.samples + channel.sample, chunk.samples + chunk.count, timeS, [](double t, const DataPoint &p)
+                                                      { return t < p.m_time; });
+        const uint32_t count = (uint32_t)(end - (chunk.samples + channel.sample));
+        if (count > 0)
+        {
+            m_spans.push_back({channel.buffer, chunk.samples + channel.sample, count});
+            channel.sample += count;
+            pushed += count;
+        }
+        if (channel.sample < chunk.count)
+        {
+            break;
+        }
+        channel.chunk++;
+        channel.sample = 0;
+    }
+    return pushed;
+}
+
+bool MBIReplay::Fail(const std::filesystem::path &path, std::string_view reason)
+{
+    MBIMGUI::GetLogger().Log(MBIMGUI::LOG_LEVEL_ERROR, "Recording %s : %s", path.string().c_str(), reason.data());
+    Close();
+    return false;
+}
@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "MBISpectrogramChart.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define MBI_FFT_SSE 1
+#endif
+
+/**
+ * @brief Radix-2 complex FFT on split real and imaginary arrays.
+ *
+ * Twiddles are stored per stage, contiguously (stage of half size h uses entries [h;2h[), so the butterflies of a
+ * stage read them with plain vector loads : 4 butterflies are computed at once with SSE when h >= 4.
+ *
+ */
+class MBIFft
+{
+public:
+    /**
+     * @brief Construct a new MBIFft object
+     *
+     * @param size Number of points, power of 2
+     */
+    explicit MBIFft(uint32_t size) : m_size(size), m_twRe(size), m_twIm(size), m_reverse(size)
+    {
+        static constexpr double PI = 3.14159265358979323846;
+        for (uint32_t h = 1; h < size; h <<= 1)
+        {
+            for (uint32_t k = 0; k < h; k++)
+            {
+                const double angle = -PI * (double)k / (double)h;
+                m_twRe[h + k] = (float)std::cos(angle);
+                m_twIm[h + k] = (float)std::sin(angle);
+            }
+        }
+        uint32_t bits = 0;
+        while ((1u << bits) < size)
+            bits++;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            uint32_t r = 0;
+            for (uint32_t b = 0; b < bits; b++)
+            {
+                r |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+            m_reverse[i] = r;
+        }
+    }
+
+    /**
+     * @brief In place forward transform
+     *
+     * @param re Real parts, size points
+     * @param im Imaginary parts, size points
+     */
+    void Forward(float *re, float *im) const
+    {
+        for (uint32_t i = 0; i < m_size; i++)
+        {
+            const uint32_t r = m_reverse[i];
+            if (r > i)
+            {
+                std::swap(re[i], re[r]);
+                std::swap(im[i], im[r]);
+            }
+        }
+        for (uint32_t h = 1; h < m_size; h <<= 1)
+        {
+            const float *const wRe = &m_twRe[h];
+            const float *const wIm = &m_twIm[h];
+            for (uint32_t g = 0; g < m_size; g += 2 * h)
+            {
+                float *const aRe = re + g;
+                float *const aIm = im + g;
+                float *const bRe = re + g + h;
+                float *const bIm = im + g + h;
+                uint32_t k = 0;
+#ifdef MBI_FFT_SSE
+                for (; k + 4 <= h; k += 4)
+                {
+                    const __m128 xr = _mm_loadu_ps(bRe + k);
+                    const __m128 xi = _mm_loadu_ps(bIm + k);
+                    const __m128 wr = _mm_loadu_ps(wRe + k);
+                    const __m128 wi = _mm_loadu_ps(wIm + k);
+                    const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                    const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                    const __m128 ar = _mm_loadu_ps(aRe + k);
+                    const __m128 ai = _mm_loadu_ps(aIm + k);
+                    _mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+                    _mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+                    _mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+                    _mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+                }
+#endif
+                for (; k < h; k++)
+                {
+                    const float tr = bRe[k] * wRe[k] - bIm[k] * wIm[k];
+                    const float ti = bRe[k] * wIm[k] + bIm[k] * wRe[k];
+                    bRe[k] = aRe[k] - tr;
+                    bIm[k] = aIm[k] - ti;
+                    aRe[k] += tr;
+                    aIm[k] += ti;
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t m_size;                 ///< Number of points
+    std::vector<float> m_twRe;       ///< Real parts of the twiddles, per stage
+    std::vector<float> m_twIm;       ///< Imaginary parts of the twiddles, per stage
+    std::vector<uint32_t> m_reverse; ///< Bit reversed index of each point
+};
+
+/**
+ * @brief Round down to a power of 2 in [MIN_FFT_SIZE;MAX_FFT_SIZE]
+ *
+ */
+static uint32_t FftSize(uint32_t size)
+{
+    size = std::clamp(size, MBISpectrogramChart::MIN_FFT_SIZE, MBISpectrogramChart::MAX_FFT_SIZE);
+    uint32_t pow2 = MBISpectrogramChart::MIN_FFT_SIZE;
+    while (pow2 * 2 <= size)
+        pow2 *= 2;
+    return pow2;
+}
+
+MBISpectrogramChart::MBISpectrogramChart(const DataContainer *channel, uint32_t fftSize, uint32_t hopSize, uint32_t historyRows) : m_channel(channel),
+                                                                                                                                  m_fftSize(FftSize(fftSize)),
+                                                                                                                                  m_hopSize((hopSize == 0) ? (FftSize(fftSize) / 2) : hopSize),
+                                                                                                                                  m_binCount(FftSize(fftSize) / 2 + 1),
+                                                                                                                                  m_historyRows(std::max(historyRows, 1u)),
+                                                                                                                                  m_minDb(-100.0f),
+                                                                                                                                  m_maxDb(0.0f),
+                                                                                                                                  m_colormap(ImPlotColormap_Viridis),
+                                                                                                                                  m_head(0),
+                                                                                                                                  m_rowCount(0),
+                                                                                                                                  m_sampleRate(0.0),
+                                                                                                                                  m_rowsGeneration(0),
+                                                                                                                                  m_resetRequest(false),
+                                                                                                                                  m_stop(false),
+                                                                                                                                  m_spectra(0),
+                                                                                                                                  m_dropped(0),
+                                                                                                                                  m_displayRows(0),
+                                                                                                                                  m_displayFirst(0.0),
+                                                                                                                                  m_displayLast(0.0),
+                                                                                                                                  m_displayRate(0.0),
+                                                                                                                                  m_displayGeneration(0)
+{
+    m_rows.resize((size_t)m_historyRows * m_binCount);
+    m_times.resize(m_historyRows);
+    m_thread = std::thread(&MBISpectrogramChart::WorkerThread, this);
+}
+
+MBISpectrogramChart::~MBISpectrogramChart()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void MBISpectrogramChart::SetScale(float minDb, float maxDb) noexcept
+{
+    m_minDb = minDb;
+    m_maxDb = maxDb;
+}
+
+void MBISpectrogramChart::SetColormap(ImPlotColormap colormap) noexcept
+{
+    m_colormap = colormap;
+}
+
+void MBISpectrogramChart::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_resetRequest = true;
+    m_head = 0;
+    m_rowCount = 0;
+    m_rowsGeneration++;
+}
+
+uint32_t MBISpectrogramChart::GetFftSize() const noexcept
+{
+    return m_fftSize;
+}
+
+uint32_t MBISpectrogramChart::GetBinCount() const noexcept
+{
+    return m_binCount;
+}
+
+double MBISpectrogramChart::GetSampleRate() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sampleRate;
+}
+
+uint64_t MBISpectrogramChart::GetSpectrumCount() const noexcept
+{
+    return m_spectra;
+}
+
+uint64_t MBISpectrogramChart::GetDroppedCount() const noexcept
+{
+    return m_dropped;
+}
+
+void MBISpectrogramChart::WorkerThread()
+{
+    const MBIFft fft(m_fftSize);
+    std::vector<float> window(m_fftSize);
+    std::vector<float> re(m_fftSize);
+    std::vector<float> im(m_fftSize);
+    std::vector<float> magnitudes(m_binCount);
+    std::vector<DataPoint> samples;
+    std::vector<DataPoint> pending;
+    size_t skip = 0; /* Samples still to skip when the hop is larger than the FFT */
+    uint64_t next = 0;
+
+    /* Hann window, magnitudes are normalized by its sum so a full scale sine reads 0 dB */
+    double windowSum = 0.0;
+    for (uint32_t i = 0; i < m_fftSize; i++)
+    {
+        window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * 3.14159265358979323846 * (double)i / (double)(m_fftSize - 1)));
+        windowSum += window[i];
+    }
+    const float scale = (float)(2.0 / windowSum);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop)
+    {
+        m_cv.wait_for(lock, std::chrono::milliseconds(WORKER_PERIOD_MS), [this]
+                      { return m_stop; });
+        if (m_resetRequest)
+        {
+            pending.clear();
+            skip = 0;
+            next = m_channel->pushed();
+            m_resetRequest = false;
+        }
+        lock.unlock();
+
+        /* Copy the new samples, a hole in the stream restarts the FFT window */
+        samples.clear();
+        const uint64_t first = m_channel->copy_since(next, samples);
+        if (first > next)
+        {
+            if (next > 0)
+            {
+                m_dropped += first - next;
+            }
+            pending.clear();
+            skip = 0;
+        }
+        next = first + samples.size();
+        for (const DataPoint &sample : samples)
+        {
+            /* Time going backwards : channel reset or replay seek */
+            if (!pending.empty() && sample.m_time < pending.back().m_time)
+            {
+                pending.clear();
+                skip = 0;
+            }
+            if (skip > 0)
+            {
+                skip--;
+                continue;
+            }
+            pending.push_back(sample);
+        }
+
+        /* Compute a spectrum every hop samples */
+        size_t start = 0;
+        while (start + m_fftSize <= pending.size())
+        {
+            const DataPoint *const points = &pending[start];
+            for (uint32_t i = 0; i < m_fftSize; i++)
+            {
+                re[i] = std::isnan(points[i].m_data) ? 0.0f : (float)points[i].m_data * window[i];
+                im[i] = 0.0f;
+            }
+            fft.Forward(re.data(), im.data());
+            for (uint32_t i = 0; i < m_binCount; i++)
+            {
+                const float magnitude = std::sqrt(re[i] * re[i] + im[i] * im[i]) * scale;
+                magnitudes[i] = 20.0f * std::log10(magnitude + 1e-12f);
+            }
+            const double duration = points[m_fftSize - 1].m_time - points[0].m_time;
+            const double sampleRate = (duration > 0.0) ? ((double)(m_fftSize - 1) / duration) : 0.0;
+            PushRow(magnitudes.data(), points[m_fftSize - 1].m_time, sampleRate);
+            start += m_hopSize;
+        }
+        /* A hop larger than the FFT skips samples not received yet */
+        if (start > pending.size())
+        {
+            skip = start - pending.size();
+        }
+        pending.erase(pending.begin(), pending.begin() + (ptrdiff_t)std::min(start, pending.size()));
+
+        lock.lock();
+    }
+}
+
+void MBISpectrogramChart::PushRow(const float *magnitudes, double time, double sampleRate)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    /* History restarted by a time going backwards */
+    if (m_rowCount > 0 && time < m_times[(m_head + m_historyRows - 1) % m_historyRows])
+    {
+        m_head = 0;
+        m_rowCount = 0;
+    }
+    memcpy(&m_rows[(size_t)m_head * m_binCount], magnitudes, m_binCount * sizeof(float));
+    m_times[m_head] = time;
+    m_head = (m_head + 1) % m_historyRows;
+    m_rowCount = std::min(m_rowCount + 1, m_historyRows);
+    m_sampleRate = sampleRate;
+    m_rowsGeneration++;
+    m_spectra++;
+}
+
+void MBISpectrogramChart::UpdateDisplay()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_rowsGeneration == m_displayGeneration)
+    {
+        return;
+    }
+    /* Newest spectrum first : the heatmap draws its first row at the top */
+    m_display.resize((size_t)m_rowCount * m_binCount);
+    for (uint32_t row = 0; row < m_rowCount; row++)
+    {
+        const uint32_t src = (m_head + m_historyRows - 1 - row) % m_historyRows;
+        memcpy(&m_display[(size_t)row * m_binCount], &m_rows[(size_t)src * m_binCount], m_binCount * sizeof(float));
+    }
+    m_displayRows = m_rowCount;
+    if (m_rowCount > 0)
+    {
+        m_displayLast = m_times[(m_head + m_historyRows - 1) % m_historyRows];
+        m_displayFirst = m_times[(m_head + m_historyRows - m_rowCount) % m_historyRows];
+    }
+    m_displayRate = m_sampleRate;
+    m_displayGeneration = m_rowsGeneration;
+}
+
+void MBISpectrogramChart::Display(std::string_view label, ImVec2 size)
+{
+    static constexpr float SCALE_WIDTH = 80.0f;
+
+    UpdateDisplay();
+
+    const ImVec2 plotSize((size.x > SCALE_WIDTH) ? (size.x - SCALE_WIDTH) : size.x, size.y);
+    if (ImPlot::BeginPlot(label.data(), plotSize))
+    {
+        ImPlot::SetupAxis(ImAxis_X1, "Frequency (Hz)");
+        ImPlot::SetupAxis(ImAxis_Y1, "Time");
+        if (m_displayRows > 0 && m_displayRate > 0.0)
+        {
+            /* Each row covers the hop preceding its time, so the oldest row starts one hop before its time */
+            const double hop = (double)m_hopSize / m_displayRate;
+            const double nyquist = m_displayRate / 2.0;
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, nyquist, ImGuiCond_Once);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, m_displayFirst - hop, m_displayLast, ImGuiCond_Always);
+
+            ImPlot::PushColormap(m_colormap);
+            ImPlot::PlotHeatmap(label.data(), m_display.data(), (int)m_displayRows, (int)m_binCount, m_minDb, m_maxDb, nullptr,
+                                ImPlotPoint(0.0, m_displayFirst - hop), ImPlotPoint(nyquist, m_displayLast));
+            ImPlot::PopColormap();
+        }
+        ImPlot::EndPlot();
+    }
+    ImGui::SameLine();
+    ImGui::PushID(label.data());
+    ImPlot::ColormapScale("##Scale", m_minDb, m_maxDb, ImVec2(SCALE_WIDTH - ImGui::GetStyle().ItemSpacing.x, size.y), "%g dB", 0, m_colormap);
+    ImGui::PopID();
+}
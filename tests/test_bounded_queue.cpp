@@ -0,0 +1,107 @@
+/* Unit tests of MBIBoundedQueue : capacity, full queue and concurrent producers and consumers */
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "MBIBoundedQueue.h"
+
+/**
+ * @brief Capacity is rounded up to a power of 2, a push to a full queue fails and leaves the object untouched
+ *
+ */
+static void TestCapacity()
+{
+    MBIBoundedQueue<int> queue(5);
+    assert(queue.capacity() == 8);
+    assert(MBIBoundedQueue<int>(1).capacity() == 2);
+
+    int value = -1;
+    assert(queue.pop(value) == false);
+    for (int round = 0; round < 3; round++)
+    {
+        /* Several rounds : positions wrap around the ring */
+        for (int i = 0; i < 8; i++)
+        {
+            assert(queue.push(int(i)));
+        }
+        int extra = 42;
+        assert(queue.push(std::move(extra)) == false);
+        assert(extra == 42);
+        for (int i = 0; i < 8; i++)
+        {
+            assert(queue.pop(value));
+            assert(value == i);
+        }
+        assert(queue.pop(value) == false);
+    }
+}
+
+/**
+ * @brief Objects of concurrent producers are all popped once by concurrent consumers, retrying when full
+ *
+ */
+static void TestProducersConsumers()
+{
+    static constexpr int PRODUCERS = 4;
+    static constexpr int CONSUMERS = 2;
+    static constexpr uint32_t COUNT = 100000;
+    MBIBoundedQueue<uint64_t> queue(64);
+    std::vector<std::atomic<uint32_t>> received(PRODUCERS);
+    std::atomic<uint64_t> popped(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        threads.emplace_back([&queue, p]()
+                             {
+                                 for (uint32_t i = 0; i < COUNT; i++)
+                                 {
+                                     while (queue.push(((uint64_t)p << 32) | i) == false)
+                                     {
+                                         std::this_thread::yield();
+                                     }
+                                 } });
+    }
+    for (int c = 0; c < CONSUMERS; c++)
+    {
+        threads.emplace_back([&]()
+                             {
+                                 /* Each consumer sees the objects of a producer in push order */
+                                 std::vector<int64_t> last(PRODUCERS, -1);
+                                 while (popped.load() < (uint64_t)PRODUCERS * COUNT)
+                                 {
+                                     uint64_t value;
+                                     if (queue.pop(value))
+                                     {
+                                         const int p = (int)(value >> 32);
+                                         assert(p < PRODUCERS);
+                                         assert((int64_t)(uint32_t)value > last[p]);
+                                         last[p] = (uint32_t)value;
+                                         received[p]++;
+                                         popped++;
+                                     }
+                                 } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        assert(received[p] == COUNT);
+    }
+    uint64_t value;
+    assert(queue.pop(value) == false);
+}
+
+int main()
+{
+    TestCapacity();
+    TestProducersConsumers();
+    printf("test_bounded_queue OK\n");
+    return 0;
+}
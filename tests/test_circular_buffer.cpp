@@ -0,0 +1,127 @@
+/* Unit tests of the stable indexes of MBICircularBuffer and MBISyncCircularBuffer */
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "MBICircularBuffer.h"
+#include "MBISyncCircularBuffer.h"
+
+/**
+ * @brief Check the stable index accessors of a buffer of capacity 10 holding the values 0 to 24
+ *
+ * @param buffer Buffer to check, through the base class so the overrides of the synchronized buffer are used
+ */
+static void CheckIndexes(const MBICircularBuffer<int> &buffer)
+{
+    assert(buffer.size() == 10);
+    assert(buffer.pushed() == 25);
+
+    uint64_t oldest = 0;
+    uint64_t end = 0;
+    buffer.bounds(oldest, end);
+    assert(oldest == 15 && end == 25);
+
+    /* Object i holds the value i */
+    std::vector<int> out;
+    assert(buffer.copy_since(20, out) == 20);
+    assert(out.size() == 5 && out.front() == 20 && out.back() == 24);
+
+    /* Overwritten objects are skipped */
+    out.clear();
+    assert(buffer.copy_since(3, out) == 15);
+    assert(out.size() == 10 && out.front() == 15);
+
+    out.clear();
+    assert(buffer.copy_range(17, 4, out) == 17);
+    assert(out.size() == 4 && out.front() == 17 && out.back() == 20);
+
+    out.clear();
+    assert(buffer.copy_range(12, 5, out) == 15);
+    assert(out.size() == 2 && out.front() == 15 && out.back() == 16);
+
+    out.clear();
+    assert(buffer.copy_range(23, 10, out) == 23);
+    assert(out.size() == 2 && out.back() == 24);
+
+    /* Range entirely overwritten or not pushed yet */
+    out.clear();
+    buffer.copy_range(0, 5, out);
+    assert(out.empty());
+    buffer.copy_range(25, 5, out);
+    assert(out.empty());
+
+    int array[10] = {0};
+    uint64_t first = 0;
+    assert(buffer.copy_range(13, 4, array, first) == 2);
+    assert(first == 15 && array[0] == 15 && array[1] == 16);
+    assert(buffer.copy_range(18, 3, array, first) == 3);
+    assert(first == 18 && array[2] == 20);
+
+    /* Offsets relative to the oldest object */
+    buffer.copy(2, 3, array);
+    assert(array[0] == 17 && array[2] == 19);
+    assert(buffer[0] == 15 && buffer[9] == 24);
+}
+
+/**
+ * @brief Stable indexes of a buffer filled one object at a time and by arrays
+ *
+ */
+static void TestIndexes()
+{
+    MBICircularBuffer<int> buffer(10);
+    uint64_t oldest = 1;
+    uint64_t end = 1;
+    buffer.bounds(oldest, end);
+    assert(oldest == 0 && end == 0);
+
+    for (int i = 0; i < 25; i++)
+    {
+        buffer.push(i);
+    }
+    CheckIndexes(buffer);
+
+    MBISyncCircularBuffer<int> sync(10);
+    int values[25];
+    for (int i = 0; i < 25; i++)
+    {
+        values[i] = i;
+    }
+    sync.push(values, 5);
+    sync.push(&values[5], 20);
+    CheckIndexes(sync);
+}
+
+/**
+ * @brief Pops keep the indexes of the remaining objects, the generation changes on each modification
+ *
+ */
+static void TestPopAndGeneration()
+{
+    MBICircularBuffer<int> buffer(10);
+    for (int i = 0; i < 5; i++)
+    {
+        buffer.push(i);
+    }
+    const uint64_t generation = buffer.generation();
+    assert(buffer.pop() == 0);
+    assert(buffer.generation() != generation);
+
+    uint64_t oldest = 0;
+    uint64_t end = 0;
+    buffer.bounds(oldest, end);
+    assert(oldest == 1 && end == 5);
+    std::vector<int> out;
+    assert(buffer.copy_since(0, out) == 1);
+    assert(out.size() == 4 && out.front() == 1);
+}
+
+int main()
+{
+    TestIndexes();
+    TestPopAndGeneration();
+    printf("test_circular_buffer OK\n");
+    return 0;
+}
@@ -0,0 +1,156 @@
+/* Unit tests of DataGapIndex : gap free segments around NaN samples and time holes */
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "MBIDataGapIndex.h"
+
+/**
+ * @brief Check the segments of a window
+ *
+ * @param segments Segments computed
+ * @param expected Expected {offset, size} pairs
+ * @param count Number of expected segments
+ */
+static void CheckSegments(const ImVector<DataSegment> &segments, const DataSegment *expected, int count)
+{
+    assert(segments.Size == count);
+    for (int i = 0; i < count; i++)
+    {
+        assert(segments[i].offset == expected[i].offset);
+        assert(segments[i].size == expected[i].size);
+    }
+}
+
+/**
+ * @brief NaN samples split the curve, with or without a data period
+ *
+ */
+static void TestNaN()
+{
+    ImVector<DataPoint> data;
+    for (int i = 0; i < 100; i++)
+    {
+        data.push_back(DataPoint(i * 0.01, (i == 10 || (i >= 50 && i <= 52)) ? NAN : (double)i));
+    }
+    DataGapIndex index;
+    ImVector<DataSegment> segments;
+    index.Update(data, 0, 0.0f);
+    index.GetSegments(data, 0, 100, segments);
+    const DataSegment expected[] = {{0, 10}, {11, 39}, {53, 47}};
+    CheckSegments(segments, expected, 3);
+    assert(index.HasTimeGaps() == false);
+
+    /* Window inside a segment and window starting on a NaN */
+    index.GetSegments(data, 20, 10, segments);
+    const DataSegment inside[] = {{20, 10}};
+    CheckSegments(segments, inside, 1);
+    index.GetSegments(data, 50, 10, segments);
+    const DataSegment after[] = {{53, 7}};
+    CheckSegments(segments, after, 1);
+}
+
+/**
+ * @brief Time holes larger than the threshold split the curve, samples appended later are indexed incrementally
+ *
+ */
+static void TestTimeHoles()
+{
+    ImVector<DataPoint> data;
+    for (int i = 0; i < 30; i++)
+    {
+        data.push_back(DataPoint(i * 0.01, 1.0));
+    }
+    DataGapIndex index;
+    ImVector<DataSegment> segments;
+    index.Update(data, 10, 3.0f);
+    assert(index.HasTimeGaps() == false);
+
+    /* 1 s hole, then a hole below the threshold */
+    for (int i = 30; i < 60; i++)
+    {
+        data.push_back(DataPoint(1.0 + i * 0.01 + ((i >= 45) ? 0.01 : 0.0), 1.0));
+    }
+    index.Update(data, 10, 3.0f);
+    index.GetSegments(data, 0, 60, segments);
+    const DataSegment expected[] = {{0, 30}, {30, 30}};
+    CheckSegments(segments, expected, 2);
+    assert(index.HasTimeGaps());
+
+    /* Another threshold restarts the indexing : the 1 s hole is now below it */
+    index.Update(data, 10, 200.0f);
+    index.GetSegments(data, 0, 60, segments);
+    const DataSegment merged[] = {{0, 60}};
+    CheckSegments(segments, merged, 1);
+}
+
+/**
+ * @brief Segments of a circular buffer overwritten while it is indexed remain relative to its oldest sample
+ *
+ */
+static void TestCircularBuffer()
+{
+    MBICircularBuffer<DataPoint> data(1000);
+    DataGapIndex index;
+    for (int i = 0; i < 5000; i++)
+    {
+        data.push(DataPoint(i * 0.001 + ((i >= 4500) ? 1.0 : 0.0), 1.0));
+        if (i % 333 == 0)
+        {
+            index.Update(data, 1, 3.0f);
+        }
+    }
+    index.Update(data, 1, 3.0f);
+    ImVector<DataSegment> segments;
+    index.GetSegments(data, 0, 1000, segments);
+    const DataSegment expected[] = {{0, 500}, {500, 500}};
+    CheckSegments(segments, expected, 2);
+}
+
+/**
+ * @brief Continuous data are a single segment without reading the samples, lazy indexing matches the full one
+ *
+ */
+static void TestContinuousAndLazy()
+{
+    ImVector<DataPoint> data;
+    for (int i = 0; i < 1000; i++)
+    {
+        data.push_back(DataPoint(i * 0.01 + ((i >= 700) ? 5.0 : 0.0), (i % 97 == 3) ? NAN : 1.0));
+    }
+    ImVector<DataSegment> segments;
+
+    DataGapIndex continuous;
+    continuous.SetContinuous(true);
+    continuous.Update(data, 10, 3.0f);
+    continuous.GetSegments(data, 100, 500, segments);
+    const DataSegment single[] = {{100, 500}};
+    CheckSegments(segments, single, 1);
+    assert(continuous.HasTimeGaps() == false);
+
+    DataGapIndex full;
+    DataGapIndex lazy;
+    lazy.SetLazy(true);
+    full.Update(data, 10, 3.0f);
+    lazy.Update(data, 10, 3.0f);
+    assert(lazy.HasTimeGaps());
+    ImVector<DataSegment> lazySegments;
+    const int windows[][2] = {{0, 1000}, {650, 100}, {99, 1}, {350, 300}};
+    for (const auto &window : windows)
+    {
+        full.GetSegments(data, window[0], window[1], segments);
+        lazy.GetSegments(data, window[0], window[1], lazySegments);
+        CheckSegments(lazySegments, segments.Data, segments.Size);
+    }
+}
+
+int main()
+{
+    TestNaN();
+    TestTimeHoles();
+    TestCircularBuffer();
+    TestContinuousAndLazy();
+    printf("test_gap_index OK\n");
+    return 0;
+}
@@ -0,0 +1,177 @@
+/* Unit tests of the collapse of the repeated logs of a call site or of a thread into a single log */
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MBILogger.h"
+
+using namespace MBIMGUI;
+
+/**
+ * @brief Log file of a test, removed beforehand
+ *
+ */
+static std::string GetLogfile(const char *name)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+/**
+ * @brief Read the messages of a text log file, without their level, padding and date
+ *
+ */
+static std::vector<std::string> ReadMessages(const std::string &logfile)
+{
+    std::vector<std::string> messages;
+    std::ifstream file(logfile);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        /* Session header lines have no tab */
+        const size_t start = line.find('\t');
+        if (start == std::string::npos)
+        {
+            continue;
+        }
+        const size_t end = line.find('\t', start + 1);
+        std::string message = line.substr(start + 1, end - start - 1);
+        message.erase(message.find_last_not_of(' ') + 1);
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+/**
+ * @brief Message of a log stored with its repeat count
+ *
+ */
+static std::string Repeated(const char *message, int repeats)
+{
+    return std::string(message) + " (\xC3\x97" + std::to_string(repeats) + ")";
+}
+
+/**
+ * @brief Identical logs following each other are stored once, then once with their repeat count
+ *
+ */
+static void TestRepeats()
+{
+    const std::string logfile = GetLogfile("test_log_collapse_repeats.log");
+    {
+        MBILogger logger;
+        logger.Configure(false, logfile, false);
+        for (int i = 0; i < 10; i++)
+        {
+            logger.Log(LOG_LEVEL_WARNING, "sensor disconnected");
+        }
+        /* Same message with another level, formatted logs with the same then other arguments */
+        logger.Log(LOG_LEVEL_ERROR, "sensor disconnected");
+        for (int i = 0; i < 7; i++)
+        {
+            MBI_LOG(logger, LOG_LEVEL_INFO, "value %d out of range", i / 3);
+        }
+        /* Printf-like logs are compared before formatting */
+        for (int i = 0; i < 5; i++)
+        {
+            logger.Log(LOG_LEVEL_INFO, "retry %d on %s", i / 2, "COM3");
+        }
+        /* Repeats pending when the logger is destroyed are stored */
+        for (int i = 0; i < 4; i++)
+        {
+            logger.Log(LOG_LEVEL_INFO, "done");
+        }
+    }
+
+    const std::vector<std::string> expected = {"sensor disconnected", Repeated("sensor disconnected", 9), "sensor disconnected",
+                                               "value 0 out of range", Repeated("value 0 out of range", 2),
+                                               "value 1 out of range", Repeated("value 1 out of range", 2), "value 2 out of range",
+                                               "retry 0 on COM3", "retry 0 on COM3", "retry 1 on COM3", "retry 1 on COM3", "retry 2 on COM3",
+                                               "done", Repeated("done", 3)};
+    assert(ReadMessages(logfile) == expected);
+    std::filesystem::remove(logfile);
+}
+
+/**
+ * @brief Logs are collapsed per thread, the repeats of a thread are stored once it exited
+ *
+ */
+static void TestThreads()
+{
+    const std::string logfile = GetLogfile("test_log_collapse_threads.log");
+    {
+        MBILogger logger;
+        logger.Configure(false, logfile, false);
+        logger.Log(LOG_LEVEL_INFO, "polling");
+        std::thread worker([&logger]()
+                           {
+                               for (int i = 0; i < 100; i++)
+                               {
+                                   logger.Log(LOG_LEVEL_INFO, "polling");
+                               } });
+        worker.join();
+        logger.Update();
+
+        /* The same message logged by the main thread is not collapsed with the ones of the worker */
+        const std::vector<std::string> expected = {"polling", "polling", Repeated("polling", 99)};
+        assert(ReadMessages(logfile) == expected);
+        logger.Log(LOG_LEVEL_INFO, "polling");
+        logger.Log(LOG_LEVEL_INFO, "polling");
+        assert(ReadMessages(logfile) == expected);
+    }
+    assert(ReadMessages(logfile).back() == Repeated("polling", 2));
+    std::filesystem::remove(logfile);
+}
+
+/**
+ * @brief Logs of a call site are collapsed whatever the thread, the repeats of a quiet site are stored by the drain
+ *
+ */
+static void TestSites()
+{
+    const std::string logfile = GetLogfile("test_log_collapse_sites.log");
+    {
+        MBILogger logger;
+        logger.Configure(false, logfile, false);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++)
+        {
+            workers.emplace_back([&logger]()
+                                 {
+                                     for (int i = 0; i < 50; i++)
+                                     {
+                                         MBI_LOG(logger, LOG_LEVEL_WARNING, "link %s down", "eth0");
+                                     } });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        logger.Update();
+        const std::vector<std::string> first = {"link eth0 down"};
+        assert(ReadMessages(logfile) == first);
+
+        /* Stored once the repeat period elapsed, without another log of the site */
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        logger.Update();
+        const std::vector<std::string> expected = {"link eth0 down", Repeated("link eth0 down", 199)};
+        assert(ReadMessages(logfile) == expected);
+    }
+    std::filesystem::remove(logfile);
+}
+
+int main()
+{
+    TestRepeats();
+    TestThreads();
+    TestSites();
+    printf("test_log_collapse OK\n");
+    return 0;
+}
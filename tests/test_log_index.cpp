@@ -0,0 +1,153 @@
+/* Unit tests of MBILogIndex : incremental n-gram search of the log history */
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MBILogIndex.h"
+
+using namespace MBIMGUI;
+
+/* Log type of the history, the log class being private to the logger */
+using Log = std::decay_t<decltype(std::declval<const MBILogIndex::History &>().last())>;
+
+/**
+ * @brief Push logs with messages made of words of a small vocabulary, mixed case, and levels in turn
+ *
+ * @param history Log history
+ * @param from Number of the first log
+ * @param count Number of logs to push
+ */
+static void PushLogs(MBILogIndex::History &history, int from, int count)
+{
+    static const char *words[] = {"Connection", "lost", "RETRY", "timeout", "sensor", "value", "out", "of", "range", "ok"};
+    for (int i = from; i < from + count; i++)
+    {
+        std::string message = words[i % 10];
+        message += ' ';
+        message += words[(i * 7 + 3) % 10];
+        message += ' ';
+        message += std::to_string(i % 1000);
+        history.push(Log((MBILogLevel)(i % MBILogIndex::LEVEL_COUNT), message, i));
+    }
+}
+
+/**
+ * @brief Index all the logs pushed, an Update being bounded to MAX_UPDATE_LOGS
+ *
+ */
+static void UpdateAll(MBILogIndex &index, const MBILogIndex::History &history)
+{
+    for (uint64_t i = 0; i <= history.pushed() / MBILogIndex::MAX_UPDATE_LOGS; i++)
+    {
+        index.Update(history);
+    }
+}
+
+/**
+ * @brief Stable indexes of the logs of the history matching a filter, by reading all the messages
+ *
+ */
+static std::deque<uint64_t> BruteForce(const MBILogIndex::History &history, std::string search, uint32_t levelMask)
+{
+    std::transform(search.begin(), search.end(), search.begin(), [](char c)
+                   { return (char)tolower((unsigned char)c); });
+    std::vector<Log> logs;
+    uint64_t index = history.copy_since(0, logs);
+    std::deque<uint64_t> matches;
+    std::string buffer;
+    for (const Log &log : logs)
+    {
+        std::string lower = log.GetMessageLog(buffer);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](char c)
+                       { return (char)tolower((unsigned char)c); });
+        if ((levelMask & (1u << log.GetLevel())) && lower.find(search) != std::string::npos)
+        {
+            matches.push_back(index);
+        }
+        index++;
+    }
+    return matches;
+}
+
+/**
+ * @brief Check the matches of filters against a brute force search
+ *
+ */
+static void CheckFilters(MBILogIndex &index, const MBILogIndex::History &history)
+{
+    const char *searches[] = {"", "o", "ry", "RETRY", "lost ok", "e 12", "sensor value", "nothing", "zz"};
+    const uint32_t masks[] = {MBILogIndex::ALL_LEVELS, 0x1, 0x6, 0x0};
+    for (const char *search : searches)
+    {
+        for (const uint32_t mask : masks)
+        {
+            index.SetFilter(history, search, mask);
+            assert(index.IsFiltering() == (search[0] != '\0' || mask != MBILogIndex::ALL_LEVELS));
+            if (index.IsFiltering())
+            {
+                assert(index.GetMatches() == BruteForce(history, search, mask));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Searches shorter and longer than the n-grams and level filters match a brute force search
+ *
+ */
+static void TestSearch()
+{
+    MBILogIndex::History history(20000);
+    PushLogs(history, 0, 10000);
+    MBILogIndex index;
+    UpdateAll(index, history);
+    CheckFilters(index, history);
+}
+
+/**
+ * @brief Matches of the current filter are updated as logs arrive, evicted logs are forgotten
+ *
+ */
+static void TestIncremental()
+{
+    MBILogIndex::History history(3000);
+    MBILogIndex index;
+    PushLogs(history, 0, 1000);
+    UpdateAll(index, history);
+    index.SetFilter(history, "Timeout", MBILogIndex::ALL_LEVELS);
+    assert(index.GetMatches() == BruteForce(history, "timeout", MBILogIndex::ALL_LEVELS));
+
+    /* Logs appended then evicted : the history wraps several times, postings are compacted */
+    for (int i = 1000; i < 50000; i += 700)
+    {
+        PushLogs(history, i, 700);
+        UpdateAll(index, history);
+        assert(index.GetMatches() == BruteForce(history, "timeout", MBILogIndex::ALL_LEVELS));
+    }
+    uint64_t oldest = 0;
+    uint64_t end = 0;
+    history.bounds(oldest, end);
+    assert(index.GetMatches().front() >= oldest);
+    CheckFilters(index, history);
+
+    /* History replaced : the index restarts */
+    MBILogIndex::History replaced(100);
+    PushLogs(replaced, 0, 50);
+    UpdateAll(index, replaced);
+    index.SetFilter(replaced, "lost", MBILogIndex::ALL_LEVELS);
+    assert(index.GetMatches() == BruteForce(replaced, "lost", MBILogIndex::ALL_LEVELS));
+}
+
+int main()
+{
+    TestSearch();
+    TestIncremental();
+    printf("test_log_index OK\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+/* Unit tests of MBIMpscQueue : order and completeness with concurrent producers */
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MBIMpscQueue.h"
+
+/**
+ * @brief Objects are popped in push order, move only objects included
+ *
+ */
+static void TestSingleThread()
+{
+    MBIMpscQueue<int> queue;
+    int value = -1;
+    assert(queue.pop(value) == false);
+    for (int i = 0; i < 100; i++)
+    {
+        queue.push(int(i));
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        assert(queue.pop(value));
+        assert(value == i);
+    }
+    assert(queue.pop(value) == false);
+
+    /* Objects still queued are destroyed with the queue */
+    MBIMpscQueue<std::unique_ptr<int>> owners;
+    owners.push(std::make_unique<int>(1));
+    owners.push(std::make_unique<int>(2));
+    std::unique_ptr<int> owner;
+    assert(owners.pop(owner) && *owner == 1);
+}
+
+/**
+ * @brief All the objects of concurrent producers are popped once, in push order for each producer
+ *
+ */
+static void TestProducers()
+{
+    static constexpr int PRODUCERS = 4;
+    static constexpr uint32_t COUNT = 100000;
+    MBIMpscQueue<uint64_t> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&queue, p]()
+                               {
+                                   for (uint32_t i = 0; i < COUNT; i++)
+                                   {
+                                       queue.push(((uint64_t)p << 32) | i);
+                                   } });
+    }
+
+    /* Consumer running while the producers push */
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint64_t popped = 0;
+    while (popped < (uint64_t)PRODUCERS * COUNT)
+    {
+        uint64_t value;
+        if (queue.pop(value))
+        {
+            const int p = (int)(value >> 32);
+            assert(p < PRODUCERS);
+            assert((uint32_t)value == next[p]);
+            next[p]++;
+            popped++;
+        }
+    }
+    for (std::thread &producer : producers)
+    {
+        producer.join();
+    }
+    uint64_t value;
+    assert(queue.pop(value) == false);
+}
+
+int main()
+{
+    TestSingleThread();
+    TestProducers();
+    printf("test_mpsc_queue OK\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* Unit tests of DataStatsIndex : range statistics and approximate quantiles */
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "MBIDataStatsIndex.h"
+
+/**
+ * @brief Check that two values are equal up to a relative tolerance
+ *
+ */
+static bool Near(double a, double b, double tolerance = 1e-9)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+}
+
+/**
+ * @brief Range statistics, across partial and complete blocks, match a direct computation
+ *
+ */
+static void TestRangeStats()
+{
+    ImVector<DataPoint> data;
+    for (int i = 0; i < 3000; i++)
+    {
+        data.push_back(DataPoint(i * 0.01, (i % 100 == 7) ? NAN : std::sin(i * 0.1) * 10.0 + i * 0.01));
+    }
+    DataStatsIndex index;
+    index.Update(data);
+    assert(index.GetIndexed() == 3000);
+
+    const uint64_t ranges[][2] = {{0, 3000}, {0, 1}, {10, 20}, {100, 1500}, {255, 257}, {1000, 1000}, {2999, 3000}};
+    for (const auto &range : ranges)
+    {
+        DataStats expected;
+        for (uint64_t i = range[0]; i < range[1]; i++)
+        {
+            expected.Add(data[(int)i].m_data);
+        }
+        const DataStats stats = index.GetStats(data, range[0], range[1]);
+        assert(stats.count == expected.count);
+        if (expected.count > 0)
+        {
+            assert(stats.min == expected.min);
+            assert(stats.max == expected.max);
+            assert(Near(stats.mean, expected.mean));
+            assert(Near(stats.GetVariance(), expected.GetVariance(), 1e-6));
+        }
+    }
+}
+
+/**
+ * @brief Quantiles are within one sketch step of the exact ones, NaN values and NaN blocks are ignored
+ *
+ */
+static void TestQuantiles()
+{
+    static constexpr int SIZE = 100000;
+    ImVector<DataPoint> data;
+    for (int i = 0; i < SIZE; i++)
+    {
+        /* A whole block of NaN in the middle */
+        const bool nanBlock = (i >= 512 && i < 768);
+        data.push_back(DataPoint(i * 0.01, nanBlock ? NAN : (double)((i * 7919) % SIZE)));
+    }
+    DataStatsIndex index;
+    index.Update(data);
+
+    std::vector<double> sorted;
+    for (int i = 0; i < SIZE; i++)
+    {
+        if (!std::isnan(data[i].m_data))
+        {
+            sorted.push_back(data[i].m_data);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    const double step = (double)SIZE / DataStatsIndex::SKETCH_SIZE;
+    for (const double q : {0.0, 0.1, 0.5, 0.9, 1.0})
+    {
+        const double expected = sorted[(size_t)(q * (sorted.size() - 1))];
+        const double quantile = index.GetQuantile(data, q, 0, SIZE);
+        assert(!std::isnan(quantile));
+        assert(std::abs(quantile - expected) <= step);
+    }
+
+    /* Range of NaN only */
+    assert(std::isnan(index.GetQuantile(data, 0.5, 512, 768)));
+    assert(index.GetStats(data, 512, 768).count == 0);
+
+    /* Small range, read directly : exact median */
+    assert(index.GetQuantile(data, 0.5, 1, 4) == std::max(std::min(data[1].m_data, data[2].m_data), std::min(std::max(data[1].m_data, data[2].m_data), data[3].m_data)));
+}
+
+/**
+ * @brief Evicted samples of a circular buffer are forgotten, samples appended are indexed incrementally
+ *
+ */
+static void TestCircularBuffer()
+{
+    MBICircularBuffer<DataPoint> data(1000);
+    DataStatsIndex index;
+    for (int i = 0; i < 10000; i++)
+    {
+        data.push(DataPoint(i * 0.01, (double)i));
+        if (i % 700 == 0)
+        {
+            index.Update(data);
+        }
+    }
+    index.Update(data);
+    assert(index.GetStart() == 9000);
+    assert(index.GetIndexed() == 10000);
+
+    const DataStats stats = index.GetStats(data, index.GetStart(), index.GetIndexed());
+    assert(stats.count == 1000);
+    assert(stats.min == 9000.0);
+    assert(stats.max == 9999.0);
+    assert(Near(stats.mean, 9499.5));
+
+    /* Reset of the container : the index restarts */
+    data.reset();
+    index.Update(data);
+    assert(index.GetStats(data, index.GetStart(), index.GetIndexed()).count == 0);
+}
+
+int main()
+{
+    TestRangeStats();
+    TestQuantiles();
+    TestCircularBuffer();
+    printf("test_stats_index OK\n");
+    return 0;
+}